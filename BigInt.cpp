@@ -0,0 +1,436 @@
+/**
+ * \file BigInt.cpp
+ *
+ * Implementation of the BigInt.hpp interface
+ */
+
+#include "BigInt.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <iomanip>
+#include <sstream>
+
+typedef BigInt::limb        limb;
+typedef BigInt::double_limb double_limb;
+typedef vector<limb>        Limbs;
+
+static const int         LIMB_BITS = 32;
+static const double_limb LIMB_BASE = (double_limb) 1 << LIMB_BITS;
+
+const size_t BigInt::KARATSUBA_THRESHOLD;
+
+//////////////////////////////////////////
+// Magnitudes
+
+/**
+ * \brief Removes leading zero limbs
+ */
+static void trim(Limbs& a) {
+  while (!a.empty() && a.back() == 0) {
+    a.pop_back();
+  }
+}
+
+static int compare_magnitude(const Limbs& a, const Limbs& b) {
+  if (a.size() != b.size()) {
+    return a.size() < b.size() ? -1 : 1;
+  }
+  for (size_t i = a.size(); i-- > 0; ) {
+    if (a[i] != b[i]) {
+      return a[i] < b[i] ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+static Limbs add_magnitude(const Limbs& a, const Limbs& b) {
+  const Limbs& longer  = a.size() >= b.size() ? a : b;
+  const Limbs& shorter = a.size() >= b.size() ? b : a;
+
+  Limbs r(longer.size() + 1);
+  double_limb carry = 0;
+  for (size_t i = 0; i < longer.size(); ++i) {
+    carry += longer[i];
+    if (i < shorter.size()) {
+      carry += shorter[i];
+    }
+    r[i] = (limb) carry;
+    carry >>= LIMB_BITS;
+  }
+  r[longer.size()] = (limb) carry;
+
+  trim(r);
+  return r;
+}
+
+/**
+ * \brief a - b, requires a >= b
+ */
+static Limbs subtract_magnitude(const Limbs& a, const Limbs& b) {
+  Limbs r(a.size());
+  double_limb borrow = 0;
+  for (size_t i = 0; i < a.size(); ++i) {
+    double_limb sub = borrow + (i < b.size() ? b[i] : 0);
+    r[i] = (limb) (a[i] - sub);
+    borrow = a[i] < sub ? 1 : 0;
+  }
+
+  trim(r);
+  return r;
+}
+
+/**
+ * \brief a = a * m + add
+ */
+static void multiply_add_small(Limbs& a, limb m, limb add) {
+  double_limb carry = add;
+  for (size_t i = 0; i < a.size(); ++i) {
+    carry += (double_limb) a[i] * m;
+    a[i] = (limb) carry;
+    carry >>= LIMB_BITS;
+  }
+  if (carry != 0) {
+    a.push_back((limb) carry);
+  }
+}
+
+/**
+ * \brief q = a / d
+ * \return the remainder
+ */
+static limb divide_small(const Limbs& a, limb d, Limbs& q) {
+  q.resize(a.size());
+  double_limb rem = 0;
+  for (size_t i = a.size(); i-- > 0; ) {
+    double_limb cur = (rem << LIMB_BITS) | a[i];
+    q[i] = (limb) (cur / d);
+    rem  = cur % d;
+  }
+
+  trim(q);
+  return (limb) rem;
+}
+
+/**
+ * \brief r[0, na + nb) += a * b
+ */
+static void multiply_schoolbook(const limb* a, size_t na, const limb* b, size_t nb, limb* r) {
+  for (size_t i = 0; i < na; ++i) {
+    double_limb ai = a[i];
+    double_limb carry = 0;
+    /// (2^32 - 1)^2 + 2 * (2^32 - 1) still fits into a double_limb
+    for (size_t j = 0; j < nb; ++j) {
+      carry += ai * b[j] + r[i + j];
+      r[i + j] = (limb) carry;
+      carry >>= LIMB_BITS;
+    }
+    r[i + nb] = (limb) carry;
+  }
+}
+
+/**
+ * \brief r = r + a * B^shift. Remarks: r has to be big enough for the
+ *        result, the carry is not checked
+ */
+static void add_shifted(Limbs& r, const Limbs& a, size_t shift) {
+  double_limb carry = 0;
+  size_t i = 0;
+  for (; i < a.size(); ++i) {
+    carry += (double_limb) r[i + shift] + a[i];
+    r[i + shift] = (limb) carry;
+    carry >>= LIMB_BITS;
+  }
+  for (size_t k = i + shift; carry != 0; ++k) {
+    carry += r[k];
+    r[k] = (limb) carry;
+    carry >>= LIMB_BITS;
+  }
+}
+
+static Limbs multiply_magnitude(const Limbs& a, const Limbs& b) {
+  if (a.empty() || b.empty()) {
+    return Limbs();
+  }
+
+  Limbs r(a.size() + b.size());
+  if (min(a.size(), b.size()) < BigInt::KARATSUBA_THRESHOLD) {
+    multiply_schoolbook(&a[0], a.size(), &b[0], b.size(), &r[0]);
+    trim(r);
+    return r;
+  }
+
+  const Limbs& longer  = a.size() >= b.size() ? a : b;
+  const Limbs& shorter = a.size() >= b.size() ? b : a;
+  size_t half = longer.size() / 2;
+
+  Limbs x0(longer.begin(), longer.begin() + half);
+  Limbs x1(longer.begin() + half, longer.end());
+  trim(x0);
+
+  if (shorter.size() <= half) {
+    /// unbalanced: only the longer operand is split
+    add_shifted(r, multiply_magnitude(x0, shorter), 0);
+    add_shifted(r, multiply_magnitude(x1, shorter), half);
+    trim(r);
+    return r;
+  }
+
+  /// x = x1 * B^half + x0, y = y1 * B^half + y0 and
+  /// x * y = z2 * B^(2 half) + z1 * B^half + z0 with three multiplications
+  Limbs y0(shorter.begin(), shorter.begin() + half);
+  Limbs y1(shorter.begin() + half, shorter.end());
+  trim(y0);
+
+  Limbs z0 = multiply_magnitude(x0, y0);
+  Limbs z2 = multiply_magnitude(x1, y1);
+  Limbs z1 = multiply_magnitude(add_magnitude(x0, x1), add_magnitude(y0, y1));
+  z1 = subtract_magnitude(subtract_magnitude(z1, z0), z2);
+
+  add_shifted(r, z0, 0);
+  add_shifted(r, z1, half);
+  add_shifted(r, z2, 2 * half);
+  trim(r);
+  return r;
+}
+
+/**
+ * \brief u / v by Knuth's algorithm D (TAOCP Vol. 2, 4.3.1). Requires
+ *        u >= v and at least two limbs in v
+ */
+static Limbs divide_magnitude(const Limbs& u, const Limbs& v) {
+  size_t n = v.size();
+  size_t m = u.size() - n;
+
+  /// normalize, so that the top limb of the divisor has its high bit set
+  int s = 0;
+  for (limb top = v[n - 1]; (top & 0x80000000u) == 0; top <<= 1) {
+    ++s;
+  }
+
+  Limbs vn(n);
+  for (size_t i = n - 1; i > 0; --i) {
+    vn[i] = (limb) ((((double_limb) v[i] << LIMB_BITS) | v[i - 1]) >> (LIMB_BITS - s));
+  }
+  vn[0] = v[0] << s;
+
+  Limbs un(u.size() + 1);
+  un[u.size()] = (limb) ((double_limb) u.back() >> (LIMB_BITS - s));
+  for (size_t i = u.size() - 1; i > 0; --i) {
+    un[i] = (limb) ((((double_limb) u[i] << LIMB_BITS) | u[i - 1]) >> (LIMB_BITS - s));
+  }
+  un[0] = u[0] << s;
+
+  Limbs q(m + 1);
+  for (size_t j = m + 1; j-- > 0; ) {
+    /// estimate the quotient limb from the top two limbs, it is at most
+    /// two too large after the correction
+    double_limb num  = ((double_limb) un[j + n] << LIMB_BITS) | un[j + n - 1];
+    double_limb qhat = num / vn[n - 1];
+    double_limb rhat = num % vn[n - 1];
+    while (qhat >= LIMB_BASE
+	   || qhat * vn[n - 2] > ((rhat << LIMB_BITS) | un[j + n - 2])) {
+      --qhat;
+      rhat += vn[n - 1];
+      if (rhat >= LIMB_BASE) {
+	break;
+      }
+    }
+
+    /// multiply and subtract
+    long long borrow = 0;
+    long long t;
+    for (size_t i = 0; i < n; ++i) {
+      double_limb p = qhat * vn[i];
+      t = (long long) un[i + j] - borrow - (long long) (p & 0xffffffffu);
+      un[i + j] = (limb) t;
+      borrow = (long long) (p >> LIMB_BITS) - (t >> LIMB_BITS);
+    }
+    t = (long long) un[j + n] - borrow;
+    un[j + n] = (limb) t;
+
+    q[j] = (limb) qhat;
+    if (t < 0) {
+      /// qhat was one too large, add the divisor back
+      --q[j];
+      double_limb carry = 0;
+      for (size_t i = 0; i < n; ++i) {
+	carry += (double_limb) un[i + j] + vn[i];
+	un[i + j] = (limb) carry;
+	carry >>= LIMB_BITS;
+      }
+      un[j + n] += (limb) carry;
+    }
+  }
+
+  trim(q);
+  return q;
+}
+
+
+//////////////////////////////////////////
+// BigInt
+
+BigInt::BigInt() : negative_m(false) {}
+
+BigInt::BigInt(long long value) : negative_m(value < 0) {
+  double_limb magnitude = value < 0 ? 0 - (double_limb) value : (double_limb) value;
+  while (magnitude != 0) {
+    limbs_m.push_back((limb) magnitude);
+    magnitude >>= LIMB_BITS;
+  }
+}
+
+BigInt::BigInt(const string& str) throw (runtime_error) : negative_m(false) {
+  size_t pos = 0;
+  if (!str.empty() && (str[0] == '+' || str[0] == '-')) {
+    negative_m = str[0] == '-';
+    pos = 1;
+  }
+  if (pos == str.size()) {
+    throw runtime_error("Illegal integer literal " + str);
+  }
+
+  /// nine digits at once fit into a limb
+  while (pos < str.size()) {
+    size_t end = min(pos + 9, str.size());
+    limb value = 0;
+    limb scale = 1;
+    for (; pos < end; ++pos) {
+      if (str[pos] < '0' || str[pos] > '9') {
+	throw runtime_error("Illegal integer literal " + str);
+      }
+      value = value * 10 + (str[pos] - '0');
+      scale *= 10;
+    }
+    multiply_add_small(limbs_m, scale, value);
+  }
+
+  trim(limbs_m);
+  if (limbs_m.empty()) {
+    negative_m = false;
+  }
+}
+
+bool BigInt::fits_int() const {
+  if (limbs_m.size() > 1) {
+    return false;
+  }
+  if (limbs_m.empty()) {
+    return true;
+  }
+  return limbs_m[0] <= (negative_m ? (limb) INT_MAX + 1 : (limb) INT_MAX);
+}
+
+int BigInt::to_int() const {
+  if (limbs_m.empty()) {
+    return 0;
+  }
+  return (int) (negative_m ? -(long long) limbs_m[0] : (long long) limbs_m[0]);
+}
+
+double BigInt::to_double() const {
+  double result = 0;
+  for (size_t i = limbs_m.size(); i-- > 0; ) {
+    result = result * (double) LIMB_BASE + limbs_m[i];
+  }
+  return negative_m ? -result : result;
+}
+
+string BigInt::to_string() const {
+  if (is_zero()) {
+    return "0";
+  }
+
+  /// chunks of nine decimal digits, least significant first
+  vector<limb> chunks;
+  Limbs rest = limbs_m;
+  Limbs quotient;
+  while (!rest.empty()) {
+    chunks.push_back(divide_small(rest, 1000000000u, quotient));
+    rest.swap(quotient);
+  }
+
+  ostringstream os;
+  if (negative_m) {
+    os << '-';
+  }
+  os << chunks.back();
+  for (size_t i = chunks.size() - 1; i-- > 0; ) {
+    os << setw(9) << setfill('0') << chunks[i];
+  }
+  return os.str();
+}
+
+int BigInt::compare(const BigInt& other) const {
+  if (negative_m != other.negative_m) {
+    return negative_m ? -1 : 1;
+  }
+  int result = compare_magnitude(limbs_m, other.limbs_m);
+  return negative_m ? -result : result;
+}
+
+BigInt BigInt::operator-() const {
+  BigInt result = *this;
+  if (!result.is_zero()) {
+    result.negative_m = !negative_m;
+  }
+  return result;
+}
+
+BigInt BigInt::add(const BigInt& a, const BigInt& b, bool subtract) {
+  bool b_negative = b.negative_m != subtract;
+
+  BigInt result;
+  if (a.negative_m == b_negative) {
+    result.limbs_m    = add_magnitude(a.limbs_m, b.limbs_m);
+    result.negative_m = a.negative_m;
+    return result;
+  }
+
+  int cmp = compare_magnitude(a.limbs_m, b.limbs_m);
+  if (cmp > 0) {
+    result.limbs_m    = subtract_magnitude(a.limbs_m, b.limbs_m);
+    result.negative_m = a.negative_m;
+  }
+  else if (cmp < 0) {
+    result.limbs_m    = subtract_magnitude(b.limbs_m, a.limbs_m);
+    result.negative_m = b_negative;
+  }
+  return result;
+}
+
+BigInt operator+(const BigInt& a, const BigInt& b) {
+  return BigInt::add(a, b, false);
+}
+
+BigInt operator-(const BigInt& a, const BigInt& b) {
+  return BigInt::add(a, b, true);
+}
+
+BigInt operator*(const BigInt& a, const BigInt& b) {
+  BigInt result;
+  result.limbs_m    = multiply_magnitude(a.limbs_m, b.limbs_m);
+  result.negative_m = !result.limbs_m.empty() && a.negative_m != b.negative_m;
+  return result;
+}
+
+BigInt operator/(const BigInt& a, const BigInt& b) throw (runtime_error) {
+  if (b.is_zero()) {
+    throw runtime_error("Can not devide by zero");
+  }
+
+  BigInt result;
+  if (compare_magnitude(a.limbs_m, b.limbs_m) < 0) {
+    return result;
+  }
+
+  if (b.limbs_m.size() == 1) {
+    divide_small(a.limbs_m, b.limbs_m[0], result.limbs_m);
+  }
+  else {
+    result.limbs_m = divide_magnitude(a.limbs_m, b.limbs_m);
+  }
+  result.negative_m = !result.limbs_m.empty() && a.negative_m != b.negative_m;
+  return result;
+}
@@ -0,0 +1,108 @@
+/**
+ * \file BigInt
+ *
+ * \brief Integers of arbitrary precision
+ */
+
+#ifndef BIGINT_HPP
+#define BIGINT_HPP
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+using namespace std;
+
+/**
+ * \class BigInt
+ *
+ * \brief Value class for integers which do not fit into a fixnum. Used by
+ *        the ArithmeticCells only when a calculation with ints overflows,
+ *        see BigIntCell
+ *
+ * The magnitude is stored as limbs of 32 bits, least significant limb
+ * first and without leading zero limbs (zero has no limbs at all), the
+ * sign separately. Multiplication is done by schoolbook up to
+ * KARATSUBA_THRESHOLD limbs and by Karatsuba above, division by Knuth's
+ * algorithm D.
+ */
+class BigInt {
+public:
+  typedef unsigned int       limb;
+  typedef unsigned long long double_limb;
+
+  /// operands with fewer limbs are multiplied by schoolbook
+  static const size_t KARATSUBA_THRESHOLD = 32;
+
+  /**
+   * \brief Constructor for zero
+   */
+  BigInt();
+
+  /**
+   * \brief Constructor for a value which fits into a long long
+   */
+  BigInt(long long value);
+
+  /**
+   * \brief Constructor for a decimal literal: an optional sign followed
+   *        by digits
+   * \throw runtime_error if str is not such a literal
+   */
+  explicit BigInt(const string& str) throw (runtime_error);
+
+  bool is_zero() const { return limbs_m.empty(); }
+  bool is_negative() const { return negative_m; }
+
+  /**
+   * \brief Checks if the value fits into an int, see to_int()
+   */
+  bool fits_int() const;
+
+  /**
+   * \brief Value as int. Remarks: only meaningful if fits_int()
+   */
+  int to_int() const;
+
+  /**
+   * \brief Value as double, the nearest double or infinity
+   */
+  double to_double() const;
+
+  /**
+   * \brief Value in decimal notation
+   */
+  string to_string() const;
+
+  /**
+   * \return <0, 0 or >0 if this is less than, equal to or greater than
+   *         other
+   */
+  int compare(const BigInt& other) const;
+
+  BigInt operator-() const;
+
+  friend BigInt operator+(const BigInt& a, const BigInt& b);
+  friend BigInt operator-(const BigInt& a, const BigInt& b);
+  friend BigInt operator*(const BigInt& a, const BigInt& b);
+
+  /**
+   * \brief Quotient rounded towards zero, like the division of ints
+   * \throw runtime_error if b is zero
+   */
+  friend BigInt operator/(const BigInt& a, const BigInt& b) throw (runtime_error);
+
+private:
+  typedef vector<limb> Limbs;
+
+  bool  negative_m;
+  Limbs limbs_m;
+
+  /**
+   * \brief Sum (subtract false) or difference of a and b, the sign of b
+   *        is negated for differences
+   */
+  static BigInt add(const BigInt& a, const BigInt& b, bool subtract);
+};
+
+#endif
@@ -1,507 +1,1136 @@
-/**
- * \file Cell.cpp
- *
- * Implementation of the Cell.hpp interface
- */
-
-#include "Cell.hpp"
-#include "eval.hpp"
-#include "FunctionManager.hpp"
-#include "DefinitionManager.hpp"
-
-#include <cstring>
-#include <sstream>
-#include <iostream>
-#include <iomanip>
-
-Cell* const nil = new SentinelCell();
-
-using namespace std;
-
-
-//////////////////////////////////////////
-// CellABC
-
-CellABC::~CellABC() {}
-
-bool CellABC::is_int() const { 
-  return 0;
-}
-
-bool CellABC::is_double() const {
-  return 0;
-}
-
-bool CellABC::is_symbol() const {
-  return 0;
-}
-
-bool CellABC::is_cons() const {
-  return 0;
-}
-
-bool CellABC::is_lambda() const {
-  return 0;
-}
-
-int CellABC::get_int() const throw (runtime_error) {
-  throw runtime_error("Cell does not contain an integer");
-}
-
-double CellABC::get_double() const throw (runtime_error) {
-  throw runtime_error("Cell does not contain a double");
-}
-
-double CellABC::get_numeral() const throw (runtime_error) {
-  throw runtime_error("Cell does neither contain an integer nor a double");
-}
-
-string CellABC::get_symbol() const throw (runtime_error) {
-  throw runtime_error("Cell does not contain an symbol");
-}
-
-CellABC* CellABC::get_car() const throw (runtime_error) {
-  throw runtime_error("Cell is not a ConsPair");
-}
-
-CellABC* CellABC::get_cdr() const throw (runtime_error) {
-  throw runtime_error("Cell is not a ConsPair");
-}
-
-CellABC* CellABC::get_formals() const throw (runtime_error) {
-  throw runtime_error("Cell is not a ProcedurePair");
-}
-
-CellABC* CellABC::get_body() const throw (runtime_error) {
-  throw runtime_error("Cell is not a ProcedurePair");
-}
-
-CellABC* CellABC::get_definition() const throw (runtime_error) {
-  throw runtime_error("Cell is not a defined SymbolCell");
-}
-
-CellABC* CellABC::apply(CellABC* const args) const throw (runtime_error) {  
-  throw runtime_error("Cell is not a FunctionCell");
-}
-
-void SentinelCell::print(std::ostream& os) const {
-   os << "()";
-}
-
-//////////////////////////////////////////
-// IntCell
-
-IntCell::IntCell(int const i) : content_m(i) {}
-
-bool IntCell::is_int() const {
-  return 1;
-}
-  
-int IntCell::get_int() const throw (runtime_error) {
-  return content_m;
-}
-
-double IntCell::get_numeral() const throw (runtime_error) {
-  return get_int();
-}
-
-void IntCell::print(std::ostream& os) const {
-  os << content_m;
-}
-
-//////////////////////////////////////////
-// DoubleCell
-
-DoubleCell::DoubleCell(double const d) : content_m(d) {}
-
-
-bool DoubleCell::is_double() const {
-  return 1;
-}
-  
-double DoubleCell::get_double() const throw (runtime_error) {
-  return content_m;
-}
-
-double DoubleCell::get_numeral() const throw (runtime_error) {
-  return get_double();
-}
-
-void DoubleCell::print(std::ostream& os) const {
-  os << std::setprecision(6) << std::fixed;
-  os << content_m;
-}
-
-//////////////////////////////////////////
-// SynmbolCell
-
-SymbolCell::SymbolCell(const char* const s) {
-  //Make a deepcopy of the parameter value to ensure that the user's variable
-  //will be untouched
-  content_m = new char[strlen(s)+1];
-  strcpy(content_m, s);
-}
-
-SymbolCell::~SymbolCell() {
-  if(content_m != NULL) {
-    delete content_m;
-    content_m = NULL;
-  }
-}
-
-bool SymbolCell::is_int() const {
-  return get_definition()->is_int();
-}
-
-bool SymbolCell::is_double() const {
-  return get_definition()->is_double();
-}
-
-bool SymbolCell::is_symbol() const {
-  return 1;
-}
-
-Cell* SymbolCell::get_definition() const throw (runtime_error) {
-  return DefinitionManager::Instance()->get_definition(content_m);
-}
-
-int SymbolCell::get_int() const throw (runtime_error) {
-  return get_definition()->get_int();
-}
-
-double SymbolCell::get_double() const throw (runtime_error) {
-  return get_definition()->get_double();
-}
-
-double SymbolCell::get_numeral() const throw (runtime_error) {
-  return get_definition()->get_numeral();
-}
-
-std::string SymbolCell::get_symbol() const throw (runtime_error) {
-  return content_m;
-}
-  
-void SymbolCell::print(std::ostream& os) const {
-  os << content_m;
-}
-
-bool SymbolCell::is_defined(string key) {
-  return DefinitionManager::Instance()->is_definition(key);
-}
-
-void SymbolCell::add_definition(string key, Cell* val) throw (runtime_error) {
-  DefinitionManager::Instance()->add_definition(key, val);
-}
-
-//////////////////////////////////////////
-// ConsCell
-
-ConsCell::ConsCell(Cell* const my_car, Cell* const my_cdr) : car(my_car), cdr(my_cdr) {}
-
-ConsCell::~ConsCell() {
-  if(car != nil) {
-    delete car;
-    car = NULL;
-  }
-  if(cdr != nil) {
-    delete cdr;
-    cdr = NULL;
-  }
-}
-
-int ConsCell::get_list_size(Cell* head) {
-  if (head == nil) {
-    return 0;
-  }
-
-  int counter = 0;
-
-  while(head != nil) {
-    head = head->get_cdr();
-    ++counter;  
-  }
-
-  return counter;
-}
-
-bool ConsCell::is_cons() const {
-  return 1;
-}
-  
-Cell* ConsCell::get_car() const throw (runtime_error) {
-  return car;
-}
-
-Cell* ConsCell::get_cdr() const throw (runtime_error) {
-  return cdr;
-}
-
-void ConsCell::print(ostream& os) const {
-  string cdr_sexpr = get_sexpr(get_cdr());
-  string car_sexpr = get_sexpr(get_car());
-  
-  /// In short it makes sure that not every bracket of cons will be shown
-  /// (2 (3 (4 ()))) ==> (2 3 4) 
-  if (cdr_sexpr == "()") { 
-    os << "(" + car_sexpr + ")"; 
-    return;
-  } else if (cdr_sexpr[0] == '(') {
-    os << "(" + car_sexpr
-      + " "
-      + cdr_sexpr.substr(1, cdr_sexpr.length() - 1);
-    return;
-  } else {
-    throw runtime_error("Error: List is not correct");
-  }
-}
-
-string ConsCell::get_sexpr(Cell* c) {
-  ostringstream outs;
-
-  /// recursive approach to print out ConsPair Lists
-  c->print(outs);
-
-  return outs.str();
-}
-
-
-
-//////////////////////////////////////////
-// ArithmeticCell
-
-ArithmeticCell::ArithmeticCell(const char* const s) : SymbolCell(s) {};
-
-bool ArithmeticCell::is_arithmetic(string s) {
-  if (s == "+" || s == "-" || s == "/" || s == "*") {
-    return 1;
-  }
-  return 0;
-}
-
-Cell* ArithmeticCell::get_identity() const throw (runtime_error) {
-  string op = get_symbol();
-    
-  if (op == "+") {
-    return (Cell*) new IntCell(0);
-  }
-  else if (op == "*") {
-    return (Cell*) new IntCell(1);
-  }
-  else {
-    throw runtime_error("- and / cannot have zero arguments!");
-  }
-}
-
-Cell* ArithmeticCell::apply(Cell* const args) const throw (runtime_error) {
-  if (nullp(args)) {                        /// no arguments
-    return get_identity();
-  } 
-  else if (nullp(cdr(args))) {              /// only one argument
-    Cell* argument = eval(car(args));
-    return calculate(argument);
-  }
-  else {
-    Cell* pos = args;
-    Cell* result = eval(car(pos));
-    pos = cdr(pos);
-
-    while (!nullp(pos)) {
-      Cell* c1 = eval(car(pos));
-
-      // Arithmetic Cell itself deals with the calculations
-      result = this->calculate(result, c1);
-
-      pos = cdr(pos);
-    }
-
-    return result;
-  }
-}
-
-Cell* ArithmeticCell::calculate(Cell* c) const {
-  string op = get_symbol();
-    
-  double num = c->get_numeral();
-    
-  if (op == "-") {
-    num = -1*num;
-  } 
-  else if (op == "/") {
-    if (num == 0) {
-      throw runtime_error("Can not devide by zero");
-    }
-    num = 1/num;
-  }
-
-  /// Nothing to do for + and * operation
-  
-  if (c->is_double()) {
-    return (Cell*) new DoubleCell(num);
-  }
-  return (Cell*) new IntCell((int) num);
-    
-}
-
-Cell* ArithmeticCell::calculate(Cell* c1, Cell* c2) const throw (std::runtime_error) {
-  string op = get_symbol();
-  double result = 0;
-
-  double num1 = c1->get_numeral();
-  double num2 = c2->get_numeral();
-
-  if (op == "+") {
-    result = num1 + num2;
-  }
-  else if (op == "-") {
-    result = num1 - num2;
-  }
-  else if (op == "*") {
-    result = num1 * num2;
-  }
-  else if (op == "/") {
-    if (num2 == 0) {
-      throw runtime_error("Can not devide by zero");
-    }
-    result = num1 / num2;
-  }
-  if (c1->is_double() || c2->is_double()) {
-    return (Cell*) new DoubleCell(result);
-  }
-  return (Cell*) new IntCell((int) result);
-
-}
-
-
-//////////////////////////////////////////
-// FunctionCell
-
-FunctionCell::FunctionCell(const char* const s) : SymbolCell(s) {};
-
-bool FunctionCell::is_function(string fname) {
-  return FunctionManager::Instance()->is_function(fname);
-}
-
-Cell* FunctionCell::apply(Cell* const args) const throw (runtime_error) {
-  string fname = get_symbol();                    // just for readability
-
-  if(args == nil && fname != "<") {
-     string msg = fname                           // provides function name
-      + " cannot be called without any argument"; // for 'backtracking' bugs
-    throw runtime_error(msg.c_str());
-  }
-  
-  /// this pointer is given to the program in order to give the
-  /// function more information. E.g. for generalised error_handlers it can
-  /// dump a simple backtrace
-  return FunctionManager::Instance()->call_function(this, args);
-}
-
-
-
-//////////////////////////////////////////
-// ProcedureCell
-
-ProcedureCell::ProcedureCell(Cell* const my_param, Cell* const my_body) : param(my_param), body(my_body) {
-  if (!listp(my_param)) {
-    
-    /// Indicates variable number of arguments
-    num_param = -1;
-  }
-  else {
-    num_param = ConsCell::get_list_size(my_param);
-  }
-}
-
-ProcedureCell::~ProcedureCell() {
-  if(param != nil) {
-    delete param;
-    param = NULL;
-  }
-  if(body != nil) {
-    delete body;
-    body = NULL;
-  }
-}
-
-
-bool ProcedureCell::is_lambda() const {
-  return 1;
-}
-
-Cell* ProcedureCell::get_formals() const throw (runtime_error) {
-  return param;
-}
-
-Cell* ProcedureCell::get_body() const throw (runtime_error) {
-  return body;
-}
-
-Cell* ProcedureCell::apply(Cell* const args) const throw (std::runtime_error) {
-
-  /// In other words: if num_param -1 then there is a variabe number
-  /// of arguments
-  if (num_param != -1 && ConsCell::get_list_size(args) != num_param) {
-    stringstream ss;
-    ss << "Mismatch of number of arguments in:" << endl;
-    ss << "\t" << *this->get_body() << endl;
-
-    throw runtime_error(ss.str());
-  }
-
-  Cell* pos_args  = args;
-  Cell* pos_param = this->get_formals();
-  Cell* pos_body  = this->get_body();
-
-  DefinitionManager::Instance()->add_stackframe();
-
-  try {
-
-    /// define local variables in local stack frame
-    if (num_param == -1) {
-      string key = pos_param->get_symbol();
-      Cell* c = pos_args;
-      DefinitionManager::Instance()->add_definition(key, c);
-    }
-    else {
-      while (!nullp(pos_args)) {
-	string key = (car(pos_param))->get_symbol();
-	Cell* c = eval(car(pos_args));
-	DefinitionManager::Instance()->add_definition(key, c);
-	
-	pos_args  = cdr(pos_args);
-	pos_param = cdr(pos_param);
-      }
-    }
-
-    /// evaluates bodies, remembers last result
-    Cell* res = nil;
-    while (!nullp(pos_body)) {
-      res = eval(car(pos_body));
-      
-      /// in case of variable number of args, eval has to be called,
-      /// since we are forced to skipped the step above in defining the
-      /// variable
-      if (!nullp(res) && num_param == -1) {
-	res = eval(res);
-      }
-      
-      pos_body = cdr(pos_body);
-    }
-    
-    DefinitionManager::Instance()->pop_stackframe();
-    
-    /// Note: only returns last remembered result according to specs
-    return res;
-    
-  }
-  catch (runtime_error) {
-    /// makes sure stackframe gets pop in case of an error
-    DefinitionManager::Instance()->pop_stackframe();
-    
-    throw;
-  }
-}
-
-void ProcedureCell::print(ostream& os) const {
-  os << "#<function>";
-}
+/**
+ * \file Cell.cpp
+ *
+ * Implementation of the Cell.hpp interface
+ */
+
+#include "Cell.hpp"
+#include "eval.hpp"
+#include "FunctionManager.hpp"
+#include "DefinitionManager.hpp"
+#include "GarbageCollector.hpp"
+#include "SymbolManager.hpp"
+#include "Compiler.hpp"
+#include "VirtualMachine.hpp"
+
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <climits>
+#include <cstring>
+
+/// nil is immediate, see Cell.hpp
+Cell* const nil = (Cell*) NIL_BITS;
+SentinelCell sentinel;
+
+using namespace std;
+
+
+//////////////////////////////////////////
+// CellABC
+
+CellABC::~CellABC() {}
+
+void* CellABC::operator new(size_t size) {
+  return GarbageCollector::Instance()->allocate(size);
+}
+
+void CellABC::operator delete(void* p) {
+  GarbageCollector::Instance()->release(p);
+}
+
+void CellABC::trace(vector<CellABC*>& children) const {}
+
+bool CellABC::is_int() const { 
+  return 0;
+}
+
+bool CellABC::is_double() const {
+  return 0;
+}
+
+bool CellABC::is_bigint() const {
+  return 0;
+}
+
+bool CellABC::is_symbol() const {
+  return 0;
+}
+
+bool CellABC::is_cons() const {
+  return 0;
+}
+
+bool CellABC::is_lambda() const {
+  return 0;
+}
+
+bool CellABC::is_vector() const {
+  return 0;
+}
+
+bool CellABC::is_string() const {
+  return 0;
+}
+
+bool CellABC::is_hash_table() const {
+  return 0;
+}
+
+int CellABC::get_int() const throw (runtime_error) {
+  throw runtime_error("Cell does not contain an integer");
+}
+
+double CellABC::get_double() const throw (runtime_error) {
+  throw runtime_error("Cell does not contain a double");
+}
+
+double CellABC::get_numeral() const throw (runtime_error) {
+  throw runtime_error("Cell does neither contain an integer nor a double");
+}
+
+const BigInt& CellABC::get_bigint() const throw (runtime_error) {
+  throw runtime_error("Cell does not contain a bigint");
+}
+
+const string& CellABC::get_symbol() const throw (runtime_error) {
+  throw runtime_error("Cell does not contain an symbol");
+}
+
+const SymbolCell* CellABC::get_interned() const throw (runtime_error) {
+  throw runtime_error("Cell does not contain an symbol");
+}
+
+CellABC* CellABC::get_car() const throw (runtime_error) {
+  throw runtime_error("Cell is not a ConsPair");
+}
+
+CellABC* CellABC::get_cdr() const throw (runtime_error) {
+  throw runtime_error("Cell is not a ConsPair");
+}
+
+CellABC* CellABC::get_formals() const throw (runtime_error) {
+  throw runtime_error("Cell is not a ProcedurePair");
+}
+
+CellABC* CellABC::get_body() const throw (runtime_error) {
+  throw runtime_error("Cell is not a ProcedurePair");
+}
+
+CellABC* CellABC::get_element(int i) const throw (runtime_error) {
+  throw runtime_error("Cell is not a vector");
+}
+
+void CellABC::set_element(int i, CellABC* const c) throw (runtime_error) {
+  throw runtime_error("Cell is not a vector");
+}
+
+int CellABC::get_vector_length() const throw (runtime_error) {
+  throw runtime_error("Cell is not a vector");
+}
+
+StringCell* CellABC::get_string() throw (runtime_error) {
+  throw runtime_error("Cell is not a string");
+}
+
+HashTableCell* CellABC::get_hash_table() throw (runtime_error) {
+  throw runtime_error("Cell is not a hash table");
+}
+
+CellABC* CellABC::get_definition() const throw (runtime_error) {
+  throw runtime_error("Cell is not a defined SymbolCell");
+}
+
+CellABC* CellABC::apply(CellABC* const args) const throw (runtime_error) {  
+  throw runtime_error("Cell is not a FunctionCell");
+}
+
+void SentinelCell::print(std::ostream& os) const {
+   os << "()";
+}
+
+//////////////////////////////////////////
+// DoubleCell
+
+DoubleCell::DoubleCell(double const d) : content_m(d) {}
+
+
+bool DoubleCell::is_double() const {
+  return 1;
+}
+  
+double DoubleCell::get_double() const throw (runtime_error) {
+  return content_m;
+}
+
+double DoubleCell::get_numeral() const throw (runtime_error) {
+  return get_double();
+}
+
+void DoubleCell::print(std::ostream& os) const {
+  os << std::setprecision(6) << std::fixed;
+  os << content_m;
+}
+
+//////////////////////////////////////////
+// BigIntCell
+
+BigIntCell::BigIntCell(const BigInt& i) : content_m(i) {}
+
+bool BigIntCell::is_int() const {
+  return 1;
+}
+
+bool BigIntCell::is_bigint() const {
+  return 1;
+}
+
+int BigIntCell::get_int() const throw (runtime_error) {
+  throw runtime_error("Integer " + content_m.to_string() + " does not fit into an int");
+}
+
+double BigIntCell::get_numeral() const throw (runtime_error) {
+  return content_m.to_double();
+}
+
+const BigInt& BigIntCell::get_bigint() const throw (runtime_error) {
+  return content_m;
+}
+
+void BigIntCell::print(std::ostream& os) const {
+  os << content_m.to_string();
+}
+
+//////////////////////////////////////////
+// SynmbolCell
+
+SymbolCell::SymbolCell(const char* const s, size_t const hash)
+  : content_m(s), hash_m(hash), interned_m(this), value_m(NULL), activation_m(0) {}
+
+SymbolCell::SymbolCell(const SymbolCell* const symbol)
+  : hash_m(symbol->get_hash()), interned_m(symbol), value_m(NULL), activation_m(0) {}
+
+SymbolCell::~SymbolCell() {
+  if (interned_m == this) {
+    SymbolManager::Instance()->remove(this);
+  }
+}
+
+void SymbolCell::trace(vector<Cell*>& children) const {
+  if (interned_m != this) {
+    children.push_back((Cell*) interned_m);
+  }
+  children.push_back(value_m);
+}
+
+bool SymbolCell::is_int() const {
+  return intp(get_definition());
+}
+
+bool SymbolCell::is_double() const {
+  return doublep(get_definition());
+}
+
+bool SymbolCell::is_bigint() const {
+  return bignump(get_definition());
+}
+
+bool SymbolCell::is_symbol() const {
+  return 1;
+}
+
+Cell* SymbolCell::get_definition() const throw (runtime_error) {
+  return DefinitionManager::Instance()->get_definition(interned_m);
+}
+
+int SymbolCell::get_int() const throw (runtime_error) {
+  return ::get_int(get_definition());
+}
+
+double SymbolCell::get_double() const throw (runtime_error) {
+  return ::get_double(get_definition());
+}
+
+double SymbolCell::get_numeral() const throw (runtime_error) {
+  return ::get_numeral(get_definition());
+}
+
+const BigInt& SymbolCell::get_bigint() const throw (runtime_error) {
+  return object_of(get_definition())->get_bigint();
+}
+
+const std::string& SymbolCell::get_symbol() const throw (runtime_error) {
+  return interned_m->content_m;
+}
+
+const SymbolCell* SymbolCell::get_interned() const throw (runtime_error) {
+  return interned_m;
+}
+
+size_t SymbolCell::get_hash() const {
+  return hash_m;
+}
+  
+void SymbolCell::print(std::ostream& os) const {
+  os << get_symbol();
+}
+
+bool SymbolCell::is_defined(const SymbolCell* key) {
+  return DefinitionManager::Instance()->is_definition(key);
+}
+
+void SymbolCell::add_definition(const SymbolCell* key, Cell* val) throw (runtime_error) {
+  DefinitionManager::Instance()->add_definition(key, val);
+}
+
+//////////////////////////////////////////
+// ConsCell
+
+ConsCell::ConsCell(Cell* const my_car, Cell* const my_cdr) : car(my_car), cdr(my_cdr) {}
+
+void ConsCell::trace(vector<Cell*>& children) const {
+  children.push_back(car);
+  children.push_back(cdr);
+}
+
+int ConsCell::get_list_size(Cell* head) {
+  if (head == nil) {
+    return 0;
+  }
+
+  int counter = 0;
+
+  while(head != nil) {
+    head = ::cdr(head);
+    ++counter;  
+  }
+
+  return counter;
+}
+
+bool ConsCell::is_cons() const {
+  return 1;
+}
+  
+Cell* ConsCell::get_car() const throw (runtime_error) {
+  return car;
+}
+
+Cell* ConsCell::get_cdr() const throw (runtime_error) {
+  return cdr;
+}
+
+void ConsCell::print(ostream& os) const {
+  /// the rests of the lists which have been opened but not closed yet,
+  /// so deep nesting does not recurse
+  vector<const Cell*> rests;
+  const ConsCell* list = this;
+  os << '(';
+
+  for (;;) {
+    const Cell* element = list->car;
+    if (!is_immediate(element) && element->is_cons()) {
+      // descend into the element, continue with the rest afterwards
+      os << '(';
+      rests.push_back(list->cdr);
+      list = (const ConsCell*) element;
+      continue;
+    }
+    print_cell(os, element);
+
+    /// close every list which ends here
+    const Cell* rest = list->cdr;
+    for (;;) {
+      if (!is_immediate(rest) && rest->is_cons()) {
+	break;
+      }
+      if (rest != nil) {
+	// improper list (1 2 . 3)
+	os << " . ";
+	print_cell(os, rest);
+      }
+      os << ')';
+      if (rests.empty()) {
+	return;
+      }
+      rest = rests.back();
+      rests.pop_back();
+    }
+    os << ' ';
+    list = (const ConsCell*) rest;
+  }
+}
+
+//////////////////////////////////////////
+// VectorCell
+
+VectorCell::VectorCell(int size, Cell* const fill) : content_m(size, fill) {
+  GarbageCollector::Instance()->note_external(content_m.capacity() * sizeof(Cell*));
+}
+
+VectorCell::VectorCell(Cell* const list) {
+  for (Cell* pos = list; !nullp(pos); pos = ::cdr(pos)) {
+    content_m.push_back(::car(pos));
+  }
+  GarbageCollector::Instance()->note_external(content_m.capacity() * sizeof(Cell*));
+}
+
+VectorCell::~VectorCell() {
+  GarbageCollector::Instance()->note_external(-(long) (content_m.capacity() * sizeof(Cell*)));
+}
+
+void VectorCell::trace(vector<Cell*>& children) const {
+  children.insert(children.end(), content_m.begin(), content_m.end());
+}
+
+bool VectorCell::is_vector() const {
+  return 1;
+}
+
+Cell* VectorCell::get_element(int i) const throw (runtime_error) {
+  check_index(i);
+  return content_m[i];
+}
+
+void VectorCell::set_element(int i, Cell* const c) throw (runtime_error) {
+  check_index(i);
+  content_m[i] = c;
+}
+
+int VectorCell::get_vector_length() const throw (runtime_error) {
+  return (int) content_m.size();
+}
+
+void VectorCell::print(ostream& os) const {
+  os << "#(";
+  for (size_t i = 0; i < content_m.size(); ++i) {
+    if (i > 0) {
+      os << ' ';
+    }
+    print_cell(os, content_m[i]);
+  }
+  os << ')';
+}
+
+void VectorCell::check_index(int i) const throw (runtime_error) {
+  if (i < 0 || (size_t) i >= content_m.size()) {
+    stringstream ss;
+    ss << "Index " << i << " is out of range for a vector of length " << content_m.size();
+    throw runtime_error(ss.str());
+  }
+}
+
+//////////////////////////////////////////
+// StringCell
+
+const size_t StringCell::SMALL;
+const size_t StringCell::CHUNK;
+
+StringCell::StringCell(const char* s, size_t length) : length_m(0), chunks_m(NULL) {
+  append(s, length);
+}
+
+StringCell::StringCell(size_t length, char fill) : length_m(0), chunks_m(NULL) {
+  char block[256];
+  memset(block, fill, sizeof(block));
+
+  while (length_m < length) {
+    append(block, min(sizeof(block), length - length_m));
+  }
+}
+
+StringCell::~StringCell() {
+  if (chunks_m != NULL) {
+    for (size_t i = 0; i < chunks_m->size(); ++i) {
+      delete[] (*chunks_m)[i];
+    }
+    GarbageCollector::Instance()->note_external(-(long) (chunks_m->size() * CHUNK));
+    delete chunks_m;
+  }
+}
+
+bool StringCell::is_string() const {
+  return 1;
+}
+
+StringCell* StringCell::get_string() throw (runtime_error) {
+  return this;
+}
+
+size_t StringCell::get_length() const {
+  return length_m;
+}
+
+char StringCell::get_char(int i) const throw (runtime_error) {
+  check_index(i);
+  if (chunks_m == NULL) {
+    return small_m[i];
+  }
+  return (*chunks_m)[i / CHUNK][i % CHUNK];
+}
+
+void StringCell::set_char(int i, char c) throw (runtime_error) {
+  check_index(i);
+  if (chunks_m == NULL) {
+    small_m[i] = c;
+  } else {
+    (*chunks_m)[i / CHUNK][i % CHUNK] = c;
+  }
+}
+
+void StringCell::append(const char* s, size_t length) {
+  if (chunks_m == NULL) {
+    if (length_m + length <= SMALL) {
+      memmove(small_m + length_m, s, length);
+      length_m += length;
+      return;
+    }
+
+    /// the string becomes long, the short one is the start of the
+    /// first chunk. small_m stays as it is, s may point into it
+    chunks_m = new vector<char*>(1, new char[CHUNK]);
+    GarbageCollector::Instance()->note_external(CHUNK);
+    memcpy((*chunks_m)[0], small_m, length_m);
+  }
+  append_chunked(s, length);
+}
+
+void StringCell::append(const StringCell* other) {
+  if (other == this) {
+    /// the characters would change while they are read
+    string copy = to_string();
+    append(copy.data(), copy.size());
+    return;
+  }
+  if (other->chunks_m == NULL) {
+    append(other->small_m, other->length_m);
+    return;
+  }
+  for (size_t i = 0; i < other->chunks_m->size(); ++i) {
+    size_t start = i * CHUNK;
+    append((*other->chunks_m)[i], min(CHUNK, other->length_m - start));
+  }
+}
+
+void StringCell::append_chunked(const char* s, size_t length) {
+  while (length > 0) {
+    size_t index = length_m / CHUNK;
+    if (index == chunks_m->size()) {
+      chunks_m->push_back(new char[CHUNK]);
+      GarbageCollector::Instance()->note_external(CHUNK);
+    }
+    size_t used = length_m % CHUNK;
+    size_t n = min(length, CHUNK - used);
+
+    memcpy((*chunks_m)[index] + used, s, n);
+    length_m += n;
+    s += n;
+    length -= n;
+  }
+}
+
+string StringCell::substr(int start, int length) const throw (runtime_error) {
+  if (start < 0 || length < 0 || (size_t) start + length > length_m) {
+    stringstream ss;
+    ss << "Substring from " << start << " of length " << length
+       << " is out of range for a string of length " << length_m;
+    throw runtime_error(ss.str());
+  }
+  if (chunks_m == NULL) {
+    return string(small_m + start, length);
+  }
+
+  string result;
+  result.reserve(length);
+  for (size_t i = start, end = start + length; i < end; ) {
+    size_t n = min(end - i, CHUNK - i % CHUNK);
+    result.append((*chunks_m)[i / CHUNK] + i % CHUNK, n);
+    i += n;
+  }
+  return result;
+}
+
+string StringCell::to_string() const {
+  return substr(0, (int) length_m);
+}
+
+void StringCell::print(ostream& os) const {
+  os << '"';
+  if (chunks_m == NULL) {
+    os.write(small_m, length_m);
+  } else {
+    for (size_t i = 0; i < chunks_m->size(); ++i) {
+      os.write((*chunks_m)[i], min(CHUNK, length_m - i * CHUNK));
+    }
+  }
+  os << '"';
+}
+
+void StringCell::check_index(int i) const throw (runtime_error) {
+  if (i < 0 || (size_t) i >= length_m) {
+    stringstream ss;
+    ss << "Index " << i << " is out of range for a string of length " << length_m;
+    throw runtime_error(ss.str());
+  }
+}
+
+
+//////////////////////////////////////////
+// Equality and hashing of cells
+
+/// elements of lists and vectors which are hashed at most
+static const int HASH_LIMIT = 64;
+
+/**
+ * \brief Symbols ask their definition for is_int(), so they are ruled out
+ *        first
+ */
+static bool is_number(Cell* const c) {
+  return is_fixnum(c)
+    || (!is_immediate(c) && !c->is_symbol() && (c->is_int() || c->is_double()));
+}
+
+static bool same_number(Cell* const c1, Cell* const c2) {
+  /// doubles can not represent all bigints, they are compared exactly
+  if ((bignump(c1) && !doublep(c2)) || (bignump(c2) && !doublep(c1))) {
+    return get_bigint(c1).compare(get_bigint(c2)) == 0;
+  }
+  return get_numeral(c1) == get_numeral(c2);
+}
+
+static bool same_characters(StringCell* const s1, StringCell* const s2) {
+  return s1->get_length() == s2->get_length() && s1->to_string() == s2->to_string();
+}
+
+bool cells_eq(Cell* const c1, Cell* const c2) {
+  if (c1 == c2) {
+    return true;
+  }
+  if (is_number(c1)) {
+    return is_number(c2) && same_number(c1, c2);
+  }
+  if (symbolp(c1)) {
+    return symbolp(c2) && get_interned(c1) == get_interned(c2);
+  }
+  return false;
+}
+
+bool cells_equal(Cell* const c1, Cell* const c2) {
+  if (cells_eq(c1, c2)) {
+    return true;
+  }
+  if (is_immediate(c1) || is_immediate(c2)) {
+    return false;
+  }
+  if (c1->is_string()) {
+    return c2->is_string() && same_characters(c1->get_string(), c2->get_string());
+  }
+  if (!(c1->is_cons() && c2->is_cons()) && !(c1->is_vector() && c2->is_vector())) {
+    return false;
+  }
+
+  vector< pair<Cell*, Cell*> > pending(1, make_pair(c1, c2));
+  while (!pending.empty()) {
+    Cell* a = pending.back().first;
+    Cell* b = pending.back().second;
+    pending.pop_back();
+
+    if (cells_eq(a, b)) {
+      continue;
+    }
+    if (is_immediate(a) || is_immediate(b)) {
+      return false;
+    }
+    if (a->is_cons() && b->is_cons()) {
+      pending.push_back(make_pair(::cdr(a), ::cdr(b)));
+      pending.push_back(make_pair(::car(a), ::car(b)));
+    } else if (a->is_vector() && b->is_vector()) {
+      int length = a->get_vector_length();
+      if (b->get_vector_length() != length) {
+	return false;
+      }
+      for (int i = length - 1; i >= 0; --i) {
+	pending.push_back(make_pair(a->get_element(i), b->get_element(i)));
+      }
+    } else if (a->is_string() && b->is_string()) {
+      if (!same_characters(a->get_string(), b->get_string())) {
+	return false;
+      }
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * \brief Numbers which are = hash the same, therefore all of them are
+ *        hashed as double
+ */
+static size_t hash_number(Cell* const c) {
+  double d = get_numeral(c);
+  if (d == 0) {
+    d = 0;   /// -0.0
+  }
+
+  unsigned long long bits;
+  memcpy(&bits, &d, sizeof(bits));
+
+  return hash_key((unsigned long) (bits ^ (bits >> 32)));
+}
+
+size_t hash_cell(Cell* const c, bool structural) {
+  if (is_number(c)) {
+    return hash_number(c);
+  }
+  if (symbolp(c)) {
+    return get_interned(c)->get_hash();
+  }
+  if (!structural || is_immediate(c)) {
+    return hash_key((unsigned long) c);
+  }
+  if (c->is_string()) {
+    return hash_key(c->get_string()->to_string());
+  }
+  if (!c->is_cons() && !c->is_vector()) {
+    return hash_key((unsigned long) c);
+  }
+
+  /// the elements are visited in the order cells_equal() compares them
+  size_t hash = 0;
+  vector<Cell*> pending(1, c);
+  for (int n = 0; n < HASH_LIMIT && !pending.empty(); ++n) {
+    Cell* current = pending.back();
+    pending.pop_back();
+
+    if (!is_immediate(current) && current->is_cons()) {
+      hash = hash * 31 + 1;
+      pending.push_back(::cdr(current));
+      pending.push_back(::car(current));
+    } else if (!is_immediate(current) && current->is_vector()) {
+      int length = current->get_vector_length();
+      hash = hash * 31 + length;
+      for (int i = min(length, HASH_LIMIT) - 1; i >= 0; --i) {
+	pending.push_back(current->get_element(i));
+      }
+    } else {
+      hash = hash * 31 + hash_cell(current, true);
+    }
+  }
+  return hash;
+}
+
+
+//////////////////////////////////////////
+// HashTableCell
+
+/**
+ * \brief Bytes of the slots of table, which are off the heap
+ */
+static long slot_bytes(const HashTableCell::Table& table) {
+  return (long) (table.bucket_count()
+		 * (sizeof(HashTableCell::Table::value_type) + sizeof(size_t)));
+}
+
+HashTableCell::HashTableCell(bool structural)
+  : table_m(CellHash(structural), CellEqual(structural)) {}
+
+HashTableCell::~HashTableCell() {
+  GarbageCollector::Instance()->note_external(-slot_bytes(table_m));
+}
+
+void HashTableCell::trace(vector<Cell*>& children) const {
+  for (Table::const_iterator i = table_m.begin(); i != table_m.end(); ++i) {
+    children.push_back(i->first);
+    children.push_back(i->second);
+  }
+}
+
+bool HashTableCell::is_hash_table() const {
+  return 1;
+}
+
+HashTableCell* HashTableCell::get_hash_table() throw (runtime_error) {
+  return this;
+}
+
+bool HashTableCell::is_structural() const {
+  return table_m.hash_function().structural_m;
+}
+
+Cell* HashTableCell::get(Cell* const key) const {
+  Table::const_iterator i = table_m.find(key);
+  if (i == table_m.end()) {
+    return NULL;
+  }
+  return i->second;
+}
+
+void HashTableCell::set(Cell* const key, Cell* const value) {
+  /// the slots are only reallocated when the table grows
+  long before = slot_bytes(table_m);
+  table_m[key] = value;
+  GarbageCollector::Instance()->note_external(slot_bytes(table_m) - before);
+}
+
+bool HashTableCell::remove(Cell* const key) {
+  return table_m.erase(key) == 1;
+}
+
+int HashTableCell::get_count() const {
+  return (int) table_m.size();
+}
+
+const HashTableCell::Table& HashTableCell::get_table() const {
+  return table_m;
+}
+
+void HashTableCell::print(ostream& os) const {
+  os << "#<hash-table " << table_m.size() << ">";
+}
+
+
+
+//////////////////////////////////////////
+// ArithmeticCell
+
+/// GCC (since 5) and clang detect the overflow of ints themselves
+#if defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5)
+#define ARITH_BUILTIN_OVERFLOW
+#endif
+
+/**
+ * \brief r = a + b
+ * \return true if the result does not fit into an int
+ */
+static inline bool add_overflows(int a, int b, int& r) {
+#ifdef ARITH_BUILTIN_OVERFLOW
+  return __builtin_add_overflow(a, b, &r);
+#else
+  if ((b > 0 && a > INT_MAX - b) || (b < 0 && a < INT_MIN - b)) {
+    return true;
+  }
+  r = a + b;
+  return false;
+#endif
+}
+
+/**
+ * \brief r = a - b
+ * \return true if the result does not fit into an int
+ */
+static inline bool subtract_overflows(int a, int b, int& r) {
+#ifdef ARITH_BUILTIN_OVERFLOW
+  return __builtin_sub_overflow(a, b, &r);
+#else
+  if ((b < 0 && a > INT_MAX + b) || (b > 0 && a < INT_MIN + b)) {
+    return true;
+  }
+  r = a - b;
+  return false;
+#endif
+}
+
+/**
+ * \brief r = a * b
+ * \return true if the result does not fit into an int
+ */
+static inline bool multiply_overflows(int a, int b, int& r) {
+#ifdef ARITH_BUILTIN_OVERFLOW
+  return __builtin_mul_overflow(a, b, &r);
+#else
+  if (a > 0 ? (b > 0 ? a > INT_MAX / b : b < INT_MIN / a)
+            : (b > 0 ? a < INT_MIN / b : (a != 0 && b < INT_MAX / a))) {
+    return true;
+  }
+  r = a * b;
+  return false;
+#endif
+}
+
+/**
+ * \brief Result of a calculation done with doubles: a double if one of
+ *        the operands is one, an int otherwise (if it fits)
+ */
+static Cell* numeral_result(bool is_double, double result) {
+  if (is_double || result < INT_MIN || result > INT_MAX) {
+    return make_double(result);
+  }
+  return make_int((int) result);
+}
+
+/**
+ * \brief Checks if c is computed exactly, i.e. an int or a bigint
+ */
+static inline bool is_exact(Cell* c) {
+  return is_fixnum(c) || bignump(c);
+}
+
+static Cell* calculate_add(Cell* c1, Cell* c2) {
+  int result;
+  if (is_fixnum(c1) && is_fixnum(c2)
+      && !add_overflows(decode_fixnum(c1), decode_fixnum(c2), result)) {
+    return make_int(result);
+  }
+
+  if (is_exact(c1) && is_exact(c2)) {
+    return make_integer(get_bigint(c1) + get_bigint(c2));
+  }
+  return numeral_result(doublep(c1) || doublep(c2), get_numeral(c1) + get_numeral(c2));
+}
+
+static Cell* calculate_subtract(Cell* c1, Cell* c2) {
+  int result;
+  if (is_fixnum(c1) && is_fixnum(c2)
+      && !subtract_overflows(decode_fixnum(c1), decode_fixnum(c2), result)) {
+    return make_int(result);
+  }
+
+  if (is_exact(c1) && is_exact(c2)) {
+    return make_integer(get_bigint(c1) - get_bigint(c2));
+  }
+  return numeral_result(doublep(c1) || doublep(c2), get_numeral(c1) - get_numeral(c2));
+}
+
+static Cell* calculate_multiply(Cell* c1, Cell* c2) {
+  int result;
+  if (is_fixnum(c1) && is_fixnum(c2)
+      && !multiply_overflows(decode_fixnum(c1), decode_fixnum(c2), result)) {
+    return make_int(result);
+  }
+
+  if (is_exact(c1) && is_exact(c2)) {
+    return make_integer(get_bigint(c1) * get_bigint(c2));
+  }
+  return numeral_result(doublep(c1) || doublep(c2), get_numeral(c1) * get_numeral(c2));
+}
+
+static Cell* calculate_divide(Cell* c1, Cell* c2) {
+  if (is_fixnum(c1) && is_fixnum(c2)) {
+    int num1 = decode_fixnum(c1);
+    int num2 = decode_fixnum(c2);
+
+    /// INT_MIN / -1 overflows
+    if (num2 != 0 && num2 != -1) {
+      return make_int(num1 / num2);
+    }
+  }
+
+  double num2 = get_numeral(c2);
+  if (num2 == 0) {
+    throw runtime_error("Can not devide by zero");
+  }
+
+  if (is_exact(c1) && is_exact(c2)) {
+    return make_integer(get_bigint(c1) / get_bigint(c2));
+  }
+  return numeral_result(doublep(c1) || doublep(c2), get_numeral(c1) / num2);
+}
+
+/// unary + and *
+static Cell* calculate_identity(Cell* c) {
+  if (is_fixnum(c)) {
+    return c;
+  }
+
+  if (is_exact(c)) {
+    return make_integer(get_bigint(c));
+  }
+  return numeral_result(doublep(c), get_numeral(c));
+}
+
+static Cell* calculate_negate(Cell* c) {
+  if (is_fixnum(c) && decode_fixnum(c) != INT_MIN) {
+    return make_int(-decode_fixnum(c));
+  }
+
+  if (is_exact(c)) {
+    return make_integer(-get_bigint(c));
+  }
+  return numeral_result(doublep(c), -get_numeral(c));
+}
+
+static Cell* calculate_reciprocal(Cell* c) {
+  double num = get_numeral(c);
+  if (num == 0) {
+    throw runtime_error("Can not devide by zero");
+  }
+
+  if (is_fixnum(c)) {
+    return make_int(1 / decode_fixnum(c));
+  }
+  if (bignump(c)) {
+    /// the magnitude of a bigint is greater than one
+    return make_int(0);
+  }
+  return numeral_result(doublep(c), 1 / num);
+}
+
+ArithmeticCell::ArithmeticCell(const SymbolCell* const symbol) throw (logic_error)
+  : SymbolCell(symbol), identity_m(NULL), sum_sign_m(0) {
+  const string& op = get_symbol();
+
+  if (op == "+") {
+    binary_m   = &calculate_add;
+    unary_m    = &calculate_identity;
+    identity_m = make_int(0);
+    sum_sign_m = 1;
+  }
+  else if (op == "-") {
+    binary_m   = &calculate_subtract;
+    unary_m    = &calculate_negate;
+    sum_sign_m = -1;
+  }
+  else if (op == "*") {
+    binary_m   = &calculate_multiply;
+    unary_m    = &calculate_identity;
+    identity_m = make_int(1);
+  }
+  else if (op == "/") {
+    binary_m   = &calculate_divide;
+    unary_m    = &calculate_reciprocal;
+  }
+  else {
+    throw logic_error("Unknown arithmetic operator " + op);
+  }
+}
+
+bool ArithmeticCell::is_arithmetic(const SymbolCell* op) {
+  return FunctionManager::Instance()->is_arithmetic(op);
+}
+
+Cell* ArithmeticCell::get_identity() const throw (runtime_error) {
+  if (identity_m == NULL) {
+    throw runtime_error("- and / cannot have zero arguments!");
+  }
+  return identity_m;
+}
+
+Cell* ArithmeticCell::apply(Cell* const args) const throw (runtime_error) {
+  if (nullp(args)) {                        /// no arguments
+    return get_identity();
+  } 
+  else if (nullp(cdr(args))) {              /// only one argument
+    Cell* argument = eval(car(args));
+    return calculate(argument);
+  }
+  else {
+    Cell* pos = args;
+    Cell* result = eval(car(pos));
+    pos = cdr(pos);
+
+    while (!nullp(pos)) {
+      Cell* c1 = eval(car(pos));
+
+      // Arithmetic Cell itself deals with the calculations
+      result = this->calculate(result, c1);
+
+      pos = cdr(pos);
+    }
+
+    return result;
+  }
+}
+
+Cell* ArithmeticCell::calculate(Cell* const* values, size_t n) const throw (runtime_error) {
+  if (sum_sign_m != 0 && is_fixnum(values[0])) {
+    /// no branches in the loop, so it can be vectorized. Overflow is
+    /// impossible as long as there are less than 2^32 operands
+    size_t tags = FIXNUM_TAG;
+    long long sum = 0;
+
+    for (size_t i = 1; i < n; ++i) {
+      tags &= (size_t) values[i];
+      sum += decode_fixnum(values[i]);
+    }
+
+    if (tags != 0) {
+      long long result = decode_fixnum(values[0]) + sum_sign_m * sum;
+
+      if (result >= INT_MIN && result <= INT_MAX) {
+	return make_int((int) result);
+      }
+      return make_integer(BigInt(result));
+    }
+  }
+
+  Cell* result = values[0];
+  for (size_t i = 1; i < n; ++i) {
+    result = binary_m(result, values[i]);
+  }
+  return result;
+}
+
+
+//////////////////////////////////////////
+// FunctionCell
+
+FunctionCell::FunctionCell(const SymbolCell* const symbol, func function, int min_args, int max_args)
+  : SymbolCell(symbol), function_m(function), min_args_m(min_args), max_args_m(max_args) {};
+
+bool FunctionCell::is_function(const SymbolCell* fname) {
+  return FunctionManager::Instance()->is_function(fname);
+}
+
+bool FunctionCell::accepts(int num_args) const {
+  return num_args >= min_args_m && (max_args_m == -1 || num_args <= max_args_m);
+}
+
+void FunctionCell::check_nullary(Cell* const args) const throw (runtime_error) {
+  if(args == nil && min_args_m > 0) {
+     string msg = get_symbol()                    // provides function name
+      + " cannot be called without any argument"; // for 'backtracking' bugs
+    throw runtime_error(msg.c_str());
+  }
+}
+
+Cell* FunctionCell::apply(Cell* const args) const throw (runtime_error) {
+  check_nullary(args);
+  
+  /// this pointer is given to the program in order to give the
+  /// function more information. E.g. for generalised error_handlers it can
+  /// dump a simple backtrace
+  return function_m(this, args);
+}
+
+
+
+//////////////////////////////////////////
+// ProcedureCell
+
+ProcedureCell::ProcedureCell(Cell* const my_param, Cell* const my_body)
+  : code_m(new CodeCell(my_param, my_body)) {}
+
+ProcedureCell::ProcedureCell(CodeCell* const code) : code_m(code) {}
+
+void ProcedureCell::trace(vector<Cell*>& children) const {
+  children.push_back(code_m);
+}
+
+
+bool ProcedureCell::is_lambda() const {
+  return 1;
+}
+
+Cell* ProcedureCell::get_formals() const throw (runtime_error) {
+  return code_m->get_formals();
+}
+
+Cell* ProcedureCell::get_body() const throw (runtime_error) {
+  return code_m->get_body();
+}
+
+CodeCell* ProcedureCell::get_code() const {
+  if (!code_m->is_compiled()) {
+    Compiler::Instance()->compile_procedure(code_m);
+  }
+  return code_m;
+}
+
+Cell* ProcedureCell::apply(Cell* const args) const throw (std::runtime_error) {
+  return VirtualMachine::Instance()->apply(this, args);
+}
+
+void ProcedureCell::print(ostream& os) const {
+  os << "#<function>";
+}
@@ -21,11 +21,15 @@
 #include <stdexcept>
 #include <functional>
 
+#include "BigInt.hpp"
+#include "hashtablemap.hpp"
+
 ////////////////////////////////////////////////////////////////////////////////
 ///
 ///     ##Outline:##
-///     1. The Abstract Base Class: CellABC
-///     2. Cells containing Data: IntCell, DoubleCell, SymbolCell, ConsCell
+///     1. The Abstract Base Class: CellABC, immediate cells (ints and nil)
+///     2. Cells containing Data: DoubleCell, BigIntCell, SymbolCell,
+///        ConsCell, VectorCell, StringCell, HashTableCell
 ///     3. Cells which are able to call functions: FunctionCell, 
 ///        ArithmeticCell 
 ///
@@ -36,6 +40,11 @@
 ///   1. The Abstract Base Class
 ////////////////////////////////////////////////////////////////////////////////
 
+class SymbolCell;
+class StringCell;
+class HashTableCell;
+class CodeCell;
+
 /**
  * \class CellABC
  * \brief Abstract Base Class (ABC) for Cells. Polymorphism is used in this 
@@ -51,10 +60,32 @@ public:
    * \brief Make sure derived classes such as SymbolCell cleans up properly
    */
   virtual ~CellABC();
+
+  /**
+   * \brief All cells are allocated on the garbage collected heap. Never
+   *        delete a cell yourself, the GarbageCollector does it once
+   *        the cell is unreachable.
+   */
+  static void* operator new(std::size_t size);
+
+  /**
+   * \brief Only used by the GarbageCollector (and by the compiler, if
+   *        a constructor throws)
+   */
+  static void operator delete(void* p);
+
+  /**
+   * \brief Used by the GarbageCollector to find the cells referenced
+   *        by this cell. Remarks: does nothing by default, should be
+   *        overritten by cells pointing to other cells
+   * \param children Every referenced cell has to be pushed onto it
+   */
+  virtual void trace(std::vector<CellABC*>& children) const;
   
   /**
-   * \brief Checks if it is an integer. Remarks: returns 0 (false) by default
-   *        should be overritten by IntCell
+   * \brief Checks if it is an integer. Remarks: returns 0 (false) by default.
+   *        Ints are immediate cells, only SymbolCell and BigIntCell
+   *        override this
    */
   virtual bool is_int() const;
 
@@ -64,6 +95,13 @@ public:
    */
   virtual bool is_double() const;
 
+  /**
+   * \brief Checks if it is an integer which does not fit into an int.
+   *        Remarks: returns 0 (false) by default should be overritten by
+   *        BigIntCell
+   */
+  virtual bool is_bigint() const;
+
   /**
    * \brief Checks if it is a Symbol. Remarks: returns 0 (false) by default
    *        should be overritten by SymbolCell
@@ -81,10 +119,28 @@ public:
    *        should be overritten by ProcedureCell.
    */
   virtual bool is_lambda() const;
+
+  /**
+   * \brief Checks if it is a VectorCell. Remarks: returns 0 (false) by default
+   *        should be overritten by VectorCell.
+   */
+  virtual bool is_vector() const;
+
+  /**
+   * \brief Checks if it is a StringCell. Remarks: returns 0 (false) by default
+   *        should be overritten by StringCell.
+   */
+  virtual bool is_string() const;
+
+  /**
+   * \brief Checks if it is a HashTableCell. Remarks: returns 0 (false) by
+   *        default should be overritten by HashTableCell.
+   */
+  virtual bool is_hash_table() const;
    
   /**
-   * \brief Accessor (error if this is not an int cell). Remarks: IntConsCell has
-   *        to override this method
+   * \brief Accessor (error if this is not an int cell). Remarks: ints are
+   *        immediate cells, only SymbolCell overrides this method
    */
   virtual int get_int() const throw (std::runtime_error);
 
@@ -95,16 +151,30 @@ public:
   virtual double get_double() const throw (std::runtime_error);
 
   /**
-   * \brief Accessor (error if this is not an int or double cell). Remarks: IntCell
-   *        and DoubleCell have to override this method
+   * \brief Accessor (error if this is not an int or double cell). Remarks:
+   *        DoubleCell has to override this method
    */
   virtual double get_numeral() const throw (std::runtime_error);
 
+  /**
+   * \brief Accessor (error if this is not a bigint cell). Remarks:
+   *        BigIntCell has to override this method
+   */
+  virtual const BigInt& get_bigint() const throw (std::runtime_error);
+
   /**
    * \brief Accessor (error if this is not a symbol cell). Remarks: SymbolConsCell has
    *        to override this method
    */
-  virtual std::string get_symbol() const throw (std::runtime_error);
+  virtual const std::string& get_symbol() const throw (std::runtime_error);
+
+  /**
+   * \brief Accessor (error if this is not a symbol cell). Remarks: SymbolCell has
+   *        to override this method
+   * \return the interned SymbolCell with the same name. Two symbols have the
+   *         same name iff their interned SymbolCells are the same.
+   */
+  virtual const SymbolCell* get_interned() const throw (std::runtime_error);
   
   /**
    * \brief Accessor (error if this is not a cons cell). Remarks: ConsCell has
@@ -130,6 +200,38 @@ public:
    */
   virtual CellABC* get_body() const throw (std::runtime_error);
 
+  /**
+   * \brief Accessor (error if this is not a vector cell or i is out of
+   *        range). Remarks: VectorCell has to override this method
+   */
+  virtual CellABC* get_element(int i) const throw (std::runtime_error);
+
+  /**
+   * \brief Modifier (error if this is not a vector cell or i is out of
+   *        range). Remarks: VectorCell has to override this method
+   */
+  virtual void set_element(int i, CellABC* const c) throw (std::runtime_error);
+
+  /**
+   * \brief Accessor (error if this is not a vector cell). Remarks:
+   *        VectorCell has to override this method
+   */
+  virtual int get_vector_length() const throw (std::runtime_error);
+
+  /**
+   * \brief Accessor (error if this is not a string cell). Remarks:
+   *        StringCell has to override this method
+   * \return the string cell itself, whose characters can be read and
+   *         changed
+   */
+  virtual StringCell* get_string() throw (std::runtime_error);
+
+  /**
+   * \brief Accessor (error if this is not a hash table cell). Remarks:
+   *        HashTableCell has to override this method
+   */
+  virtual HashTableCell* get_hash_table() throw (std::runtime_error);
+
   /**
    * \brief Accessor (error if this is not a SymbolCell with definition). Remarks: 
    *        SymbolCell has override this method
@@ -155,17 +257,95 @@ typedef CellABC Cell;
 
 /**
  * \class SentinelCell
- * \brief Is used for nil. Prevents SigFaults when accessing memberfunction on 
- *        nil.
+ * \brief Stands in for immediate cells (see below) whenever a member
+ *        function has to be called on them. Prevents SigFaults when
+ *        accessing memberfunctions on nil or on an int.
  */
 class SentinelCell : public Cell {
   virtual void print(std::ostream& os = std::cout) const;
 };
 
+/**
+ * \brief The only instance of SentinelCell. Is not allocated on the
+ *        garbage collected heap.
+ */
+extern SentinelCell sentinel;
+
+
+/**
+ * Immediate cells: ints and nil are not allocated at all, they are
+ * encoded in the Cell pointer itself. Cells on the heap are aligned to
+ * 8 bytes, so the lowest bits of a real pointer are always zero:
+ *
+ *     xxxx...xxx1   int, the value is stored in the upper bits
+ *     0000...0010   nil
+ *     xxxx...x000   pointer to a cell on the heap
+ *
+ * Truth values are the ints 0 and 1, so they are immediate as well.
+ * Immediate cells must never be dereferenced, use the accessors of
+ * cons.hpp (or object_of()) instead.
+ */
+const size_t FIXNUM_TAG     = 1;
+const size_t NIL_BITS       = 2;
+const size_t IMMEDIATE_MASK = 3;
+
+/**
+ * \brief Checks if c is encoded in the pointer (int or nil)
+ */
+inline bool is_immediate(const Cell* const c)
+{
+  return ((size_t) c & IMMEDIATE_MASK) != 0;
+}
+
+/**
+ * \brief Checks if c is an immediate int
+ */
+inline bool is_fixnum(const Cell* const c)
+{
+  return ((size_t) c & FIXNUM_TAG) != 0;
+}
+
+/**
+ * \brief Encodes i as immediate cell. Remarks: assumes that pointers
+ *        have at least one bit more than an int
+ */
+inline Cell* encode_fixnum(const int i)
+{
+  return (Cell*) (((size_t) (ptrdiff_t) i << 1) | FIXNUM_TAG);
+}
+
+/**
+ * \brief Decodes an immediate int (c has to be one)
+ */
+inline int decode_fixnum(const Cell* const c)
+{
+  return (int) ((ptrdiff_t) c >> 1);
+}
+
+/**
+ * \brief Object on which member functions of c can be called. That is
+ *        c itself or the sentinel, if c is immediate. The sentinel
+ *        throws the errors of CellABC for every accessor.
+ */
+inline Cell* object_of(Cell* const c)
+{
+  if (is_immediate(c)) {
+    return &sentinel;
+  }
+  return c;
+}
+
+inline const Cell* object_of(const Cell* const c)
+{
+  if (is_immediate(c)) {
+    return &sentinel;
+  }
+  return c;
+}
 
 // Reminder: cons.hpp expects nil to be defined somewhere (for this
-// implementation, Cell.cpp is the logical place to define it).
-// Here we promise this again, just to be safe.
+// implementation, Cell.cpp is the logical place to define it, it is
+// the immediate NIL_BITS). Here we promise this again, just to be safe.
 extern Cell* const nil;
 
 
@@ -174,26 +354,26 @@ extern Cell* const nil;
 ////////////////////////////////////////////////////////////////////////////////
 
 /**
- * \class IntCell
- * \brief Implements CellABC for Cells containing an integer
+ * \class DoubleCell
+ * \brief Implements CellABC for Cells containing a double
  */
-class IntCell : public Cell {
+class DoubleCell : public Cell {
 public:
   /**
-   * \brief Constructor to make int cell.
+   * \brief Constructor to make double cell.
    */
-  IntCell(int const i);
+  DoubleCell(double const d);
 
   /**
    * \brief Implements type check of the Cell ABC
-   * \return true if Cell is a IntCell
+   * \return true if Cell is a DoubleCell
    */
-  virtual bool is_int() const;
-
+  virtual bool is_double() const;
+  
   /**
    * \brief Implements Accessor of the Cell ABC
    */
-  virtual int get_int() const throw (std::runtime_error);
+  virtual double get_double() const throw (std::runtime_error);
 
   /**
    * \brief Implements Accessor of the Cell ABC
@@ -207,38 +387,53 @@ public:
   virtual void print(std::ostream& os = std::cout) const;
 
 private:
-  int content_m;
+  double content_m;
 
 };
 
 
 /**
- * \class DoubleCell
- * \brief Implements CellABC for Cells containing a double
+ * \class BigIntCell
+ * \brief Implements CellABC for integers which do not fit into an int.
+ *        Created by the ArithmeticCells when a calculation with ints
+ *        overflows, see make_integer(). An integer which fits into an
+ *        int is never a BigIntCell
  */
-class DoubleCell : public Cell {
+class BigIntCell : public Cell {
 public:
   /**
-   * \brief Constructor to make double cell.
+   * \brief Constructor to make bigint cell.
    */
-  DoubleCell(double const d);
+  BigIntCell(const BigInt& i);
 
   /**
    * \brief Implements type check of the Cell ABC
-   * \return true if Cell is a DoubleCell
+   * \return true, a bigint is an integer
    */
-  virtual bool is_double() const;
-  
+  virtual bool is_int() const;
+
+  /**
+   * \brief Implements type check of the Cell ABC
+   * \return true if Cell is a BigIntCell
+   */
+  virtual bool is_bigint() const;
+
   /**
    * \brief Implements Accessor of the Cell ABC
+   * \throw runtime_error always, the value does not fit into an int
    */
-  virtual double get_double() const throw (std::runtime_error);
+  virtual int get_int() const throw (std::runtime_error);
 
   /**
    * \brief Implements Accessor of the Cell ABC
    */
   virtual double get_numeral() const throw (std::runtime_error);
 
+  /**
+   * \brief Implements Accessor of the Cell ABC
+   */
+  virtual const BigInt& get_bigint() const throw (std::runtime_error);
+
   /**
    * \brief Specifies how the content of this type of Cell should be
    *        printed
@@ -246,7 +441,7 @@ public:
   virtual void print(std::ostream& os = std::cout) const;
 
 private:
-  double content_m;
+  BigInt content_m;
 
 };
 
@@ -255,37 +450,59 @@ private:
  * \class SymbolCell
  * \brief Implements CellABC for Cells containing a sybmol. _Note:_ Is also 
  *        BaseClass for FunctionCell and ArithmeticCell 
+ *
+ * Symbols are interned by the SymbolManager: there is only one SymbolCell
+ * per name, so symbols can be compared by pointer. The hash of the name is
+ * computed once while interning. FunctionCell and ArithmeticCell are not
+ * interned themselves, they refer to the interned SymbolCell of their name.
+ * The interned SymbolCell also holds the current definition of the symbol,
+ * which is managed by the DefinitionManager.
  */
 class SymbolCell : public Cell {
+  friend class DefinitionManager;
+
 public:
   /**
-   * \brief Constructor to make symbol cell.
+   * \brief Constructor to make an interned symbol cell. Only used by the
+   *        SymbolManager, use make_symbol() instead.
    */
-  SymbolCell(const char* const s);
+  SymbolCell(const char* const s, size_t const hash);
 
   /**
-   * \brief Makes sure that char* content is freed on destruction (even when 
-   *        Base class is deleted)
+   * \brief Removes the symbol from the SymbolManager, if it is the
+   *        interned one
    */
   virtual ~SymbolCell();
 
+  /**
+   * \brief Keeps the interned SymbolCell and the current definition alive
+   */
+  virtual void trace(std::vector<Cell*>& children) const;
+
   /**
    * \brief Implements type check of the Cell ABC, in this case used for runtime
    *        defined variables (definitions)
-   * \return true if Cell is a SymbolIntCell
+   * \return true if the definition is an int
    */
   virtual bool is_int() const;
 
   /**
    * \brief Implements type check of the Cell ABC, in this case used for runtime
    *        defined variables (definitions)
-   * \return true if Cell is a SymbolIntCell
+   * \return true if the definition is a double
    */
   virtual bool is_double() const;
 
+  /**
+   * \brief Implements type check of the Cell ABC, in this case used for runtime
+   *        defined variables (definitions)
+   * \return true if the definition is a bigint
+   */
+  virtual bool is_bigint() const;
+
   /**
    * \brief Implements type check of the Cell ABC
-   * \return true if Cell is a SymbolIntCell
+   * \return true if Cell is a SymbolCell
    */
   virtual bool is_symbol() const;
 
@@ -307,16 +524,40 @@ public:
    */
   virtual double get_numeral() const throw (std::runtime_error);
 
+  /**
+   * \brief Implements Accessor of the Cell ABC, in this case used for runtime
+   *        defined variables (definitions)
+   */
+  virtual const BigInt& get_bigint() const throw (std::runtime_error);
+
   /**
    * \brief Implements Accessor of the Cell ABC
    */
-  virtual std::string get_symbol() const throw (std::runtime_error);
+  virtual const std::string& get_symbol() const throw (std::runtime_error);
+
+  /**
+   * \brief Implements Accessor of the Cell ABC
+   */
+  virtual const SymbolCell* get_interned() const throw (std::runtime_error);
+
+  /**
+   * \brief Hash of the name, computed once by the SymbolManager
+   */
+  size_t get_hash() const;
 
   /**
    * \brief Implements Accessor of the Cell ABC
    */
   virtual Cell* get_definition() const throw (std::runtime_error);
 
+  /**
+   * \brief Current definition of the interned symbol without any checks,
+   *        used by the VirtualMachine. Remarks: the symbol has to be
+   *        interned
+   * \return NULL if undefined
+   */
+  Cell* get_value() const { return value_m; }
+
   /**
    * \brief Specifies how the content of this type of Cell should be
    *        printed
@@ -328,17 +569,39 @@ public:
    *        to append to static defs_m map. (independent, but shared within the
    *        class
    */
-  static void add_definition(std::string key, Cell* val) throw (std::runtime_error);
+  static void add_definition(const SymbolCell* key, Cell* val) throw (std::runtime_error);
+
+protected:
+  /**
+   * \brief Constructor for cells which refer to an interned symbol
+   *        (FunctionCell and ArithmeticCell)
+   */
+  SymbolCell(const SymbolCell* const symbol);
 
 private:
-  char* content_m;
+  std::string       content_m;   ///< empty if not interned
+  size_t            hash_m;
+  const SymbolCell* interned_m;  ///< this if interned
+
+  /// current definition, NULL if undefined. Is not part of the identity
+  /// of the symbol, therefore mutable
+  mutable Cell*     value_m;
+  mutable size_t    activation_m;  ///< see DefinitionManager
   
   /** 
    * \brief checks internally (private), if symbol is already defined
    */
-  static bool is_defined(std::string key);
+  static bool is_defined(const SymbolCell* key);
 };
 
+/**
+ * \brief Interned symbols know their hash, used by hashtablemap
+ */
+inline size_t hash_key(const SymbolCell* const s)
+{
+  return s->get_hash();
+}
+
 
 /**
  * \class ConsCell
@@ -346,6 +609,8 @@ private:
  *        List approach in order to have a powerful general purpose data type.
  */
 class ConsCell : public Cell {  
+  friend class Reader;          ///< appends while parsing, see parse.cpp
+  friend class FaslReader;      ///< fills preallocated lists, see fasl.cpp
 public:
   /**
    * \brief Constructor to make cons cell.
@@ -353,9 +618,10 @@ public:
   ConsCell(Cell* const my_car, Cell* const my_cdr);
 
   /**
-   * \brief Make sure it cleans up properly
+   * \brief car and cdr can be shared with other lists, therefore they are
+   *        not deleted here but traced for the GarbageCollector
    */
-  virtual ~ConsCell();
+  virtual void trace(std::vector<Cell*>& children) const;
 
   /**
    * \brief Knowing the size can be convenient in many cases. E.g. to 
@@ -382,8 +648,8 @@ public:
   virtual Cell* get_cdr() const throw (std::runtime_error);
 
   /**
-   * \brief Specifies how the content of this type of Cell should be
-   *        printed
+   * \brief Prints the list in s-expression notation, (1 2 . 3) if it is
+   *        improper. Nested lists are printed without recursion.
    */
   virtual void print(std::ostream& os = std::cout) const;
 
@@ -391,12 +657,326 @@ private:
   Cell* car;
   Cell* cdr;
 
+};
+
+
+/**
+ * \class VectorCell
+ * \brief Implements CellABC for Cells containing a vector: a fixed number
+ *        of elements in contiguous memory, which are read and written in
+ *        constant time (as opposed to the elements of a list)
+ */
+class VectorCell : public Cell {
+public:
+  /**
+   * \brief Constructor to make a vector cell of size elements, which are
+   *        all fill
+   */
+  VectorCell(int size, Cell* const fill);
+
   /**
-   * \brief Prints out s-expression, resolves recursively. Is static since no
-   *        instance is needed.
+   * \brief Constructor to make a vector cell with the elements of the
+   *        proper list list. Used for vector literals, see Reader
    */
-  static std::string get_sexpr(Cell* const c);
+  VectorCell(Cell* const list);
 
+  /**
+   * \brief Tells the GarbageCollector that the elements are freed
+   */
+  virtual ~VectorCell();
+
+  /**
+   * \brief The elements can be shared with other cells, therefore they
+   *        are not deleted here but traced for the GarbageCollector
+   */
+  virtual void trace(std::vector<Cell*>& children) const;
+
+  /**
+   * \brief Implements type check of the Cell ABC
+   * \return true if Cell is a VectorCell
+   */
+  virtual bool is_vector() const;
+
+  /**
+   * \brief Implements Accessor of the Cell ABC
+   */
+  virtual Cell* get_element(int i) const throw (std::runtime_error);
+
+  /**
+   * \brief Implements Modifier of the Cell ABC
+   */
+  virtual void set_element(int i, Cell* const c) throw (std::runtime_error);
+
+  /**
+   * \brief Implements Accessor of the Cell ABC
+   */
+  virtual int get_vector_length() const throw (std::runtime_error);
+
+  /**
+   * \brief Prints the vector as #(1 2 3), the syntax of vector literals
+   */
+  virtual void print(std::ostream& os = std::cout) const;
+
+private:
+  std::vector<Cell*> content_m;   ///< off the heap, see note_external()
+
+  /**
+   * \throw runtime_error if i is not an index of an element
+   */
+  void check_index(int i) const throw (std::runtime_error);
+};
+
+
+/**
+ * \class StringCell
+ * \brief Implements CellABC for Cells containing a mutable string.
+ *        Symbols are interned and therefore never change, a string can
+ *        be changed in place and appended to.
+ *
+ * Short strings are stored in the cell itself, nothing else is
+ * allocated. Longer strings are stored in chunks of CHUNK characters.
+ * Every chunk but the last one is full, so the chunk of a character is
+ * found by a division: reading and writing a character takes constant
+ * time. Appending only ever fills the last chunk or adds a new one, no
+ * character is moved again, so building a string by appending takes
+ * linear time.
+ */
+class StringCell : public Cell {
+public:
+  /// characters stored in the cell itself
+  static const size_t SMALL = 24;
+
+  /// characters per chunk of a long string
+  static const size_t CHUNK = 4096;
+
+  /**
+   * \brief Constructor to make a string cell with a copy of the length
+   *        characters at s
+   */
+  StringCell(const char* s, size_t length);
+
+  /**
+   * \brief Constructor to make a string cell of length characters fill
+   */
+  StringCell(size_t length, char fill);
+
+  /**
+   * \brief Frees the chunks
+   */
+  virtual ~StringCell();
+
+  /**
+   * \brief Implements type check of the Cell ABC
+   * \return true if Cell is a StringCell
+   */
+  virtual bool is_string() const;
+
+  /**
+   * \brief Implements Accessor of the Cell ABC
+   */
+  virtual StringCell* get_string() throw (std::runtime_error);
+
+  /**
+   * \return number of characters
+   */
+  size_t get_length() const;
+
+  /**
+   * \brief Accessor (error if i is out of range)
+   */
+  char get_char(int i) const throw (std::runtime_error);
+
+  /**
+   * \brief Modifier (error if i is out of range)
+   */
+  void set_char(int i, char c) throw (std::runtime_error);
+
+  /**
+   * \brief Appends the length characters at s, which may be part of
+   *        this string
+   */
+  void append(const char* s, size_t length);
+
+  /**
+   * \brief Appends the characters of other, which may be this string
+   */
+  void append(const StringCell* other);
+
+  /**
+   * \return the length characters from start on (error if they are
+   *         out of range)
+   */
+  std::string substr(int start, int length) const throw (std::runtime_error);
+
+  /**
+   * \return all characters as one std::string
+   */
+  std::string to_string() const;
+
+  /**
+   * \brief Prints the string as "abc", the syntax of string literals
+   */
+  virtual void print(std::ostream& os = std::cout) const;
+
+private:
+  size_t              length_m;
+  char                small_m[SMALL];  ///< the characters of a short string
+  std::vector<char*>* chunks_m;        ///< NULL while the string is short,
+                                       ///< off the heap, see note_external()
+
+  /**
+   * \brief Appends the characters in pieces which fit into the chunks
+   */
+  void append_chunked(const char* s, size_t length);
+
+  /**
+   * \throw runtime_error if i is not an index of a character
+   */
+  void check_index(int i) const throw (std::runtime_error);
+
+  /**
+   * \brief Makes sure there is no copy constructor
+   */
+  StringCell(StringCell const&);
+
+  /**
+   * \brief Makes sure no assignments are possible
+   */
+  void operator=(StringCell const&);
+};
+
+
+/**
+ * \brief Equality of eq?: numbers are the same if they are = (as for
+ *        assoc in library.scm), symbols if they have the same name, any
+ *        other cells only if they are the same cell
+ */
+bool cells_eq(Cell* const c1, Cell* const c2);
+
+/**
+ * \brief Equality of equal?: as cells_eq(), but lists and vectors with
+ *        equal elements and strings with the same characters are equal.
+ *        Nested lists are compared without recursion
+ */
+bool cells_equal(Cell* const c1, Cell* const c2);
+
+/**
+ * \brief Hash of c, equal for cells which are cells_eq() (structural is
+ *        false) or cells_equal() (structural is true). Lists and vectors
+ *        are hashed by their first elements only
+ */
+size_t hash_cell(Cell* const c, bool structural);
+
+/**
+ * \struct CellHash
+ *
+ * \brief Hash of the keys of a HashTableCell, see hash_cell()
+ */
+struct CellHash {
+  explicit CellHash(bool structural = false) : structural_m(structural) {}
+
+  size_t operator()(Cell* const c) const {
+    return hash_cell(c, structural_m);
+  }
+
+  bool structural_m;
+};
+
+/**
+ * \struct CellEqual
+ *
+ * \brief Equality of the keys of a HashTableCell, cells_eq() or
+ *        cells_equal()
+ */
+struct CellEqual {
+  explicit CellEqual(bool structural = false) : structural_m(structural) {}
+
+  bool operator()(Cell* const c1, Cell* const c2) const {
+    return structural_m ? cells_equal(c1, c2) : cells_eq(c1, c2);
+  }
+
+  bool structural_m;
+};
+
+
+/**
+ * \class HashTableCell
+ * \brief Implements CellABC for Cells containing a hash table, which maps
+ *        keys to values in constant time (as opposed to an association
+ *        list). Keys are compared with eq? or equal?, see cells_eq() and
+ *        cells_equal(). Uses hashtablemap, which grows as it is filled.
+ */
+class HashTableCell : public Cell {
+public:
+  typedef hashtablemap<Cell*, Cell*, CellHash, CellEqual> Table;
+
+  /**
+   * \brief Constructor to make an empty hash table, which compares its
+   *        keys with equal? if structural is true, with eq? otherwise
+   */
+  explicit HashTableCell(bool structural);
+
+  /**
+   * \brief Tells the GarbageCollector that the slots are freed
+   */
+  virtual ~HashTableCell();
+
+  /**
+   * \brief Keys and values can be shared with other cells, therefore
+   *        they are not deleted here but traced for the GarbageCollector
+   */
+  virtual void trace(std::vector<Cell*>& children) const;
+
+  /**
+   * \brief Implements type check of the Cell ABC
+   * \return true if Cell is a HashTableCell
+   */
+  virtual bool is_hash_table() const;
+
+  /**
+   * \brief Implements Accessor of the Cell ABC
+   */
+  virtual HashTableCell* get_hash_table() throw (std::runtime_error);
+
+  /**
+   * \return true if the keys are compared with equal?
+   */
+  bool is_structural() const;
+
+  /**
+   * \return the value of key, NULL if there is none
+   */
+  Cell* get(Cell* const key) const;
+
+  /**
+   * \brief Maps key to value, replaces the value key had before
+   */
+  void set(Cell* const key, Cell* const value);
+
+  /**
+   * \brief Removes key and its value
+   * \return false if there was no such key
+   */
+  bool remove(Cell* const key);
+
+  /**
+   * \return number of keys
+   */
+  int get_count() const;
+
+  /**
+   * \brief All entries, for iteration. Remarks: the iterators are
+   *        invalid as soon as a key is added or removed
+   */
+  const Table& get_table() const;
+
+  /**
+   * \brief Prints #<hash-table n> with the number of keys n
+   */
+  virtual void print(std::ostream& os = std::cout) const;
+
+private:
+  Table table_m;   ///< the slots are off the heap, see note_external()
 };
 
 
@@ -409,28 +989,53 @@ private:
  * \class ArithmeticCell
  * \brief Derived from SymbolCell. Is used for functions which are chainable
  *        or in other words, do not have fixed number of arguments.
+ *
+ * The implementation of the operator is selected once, when the shared
+ * ArithmeticCell is created. Ints are computed as ints: only if the
+ * result does not fit into an int, it is computed exactly as BigInt
+ * instead of overflowing. As soon as a double is involved the calculation
+ * is done with doubles.
  */
 class ArithmeticCell : public SymbolCell {
 public:
 
   /**
    * \brief Constructor for an ArithmeticCell, which is capable to compute
-   *        simple calculation. _Note:_ You can check available operation
-   *        with ArithmeticCell::is_arithmetic()
+   *        simple calculation. There is one shared ArithmeticCell per
+   *        operator, created by the FunctionManager. _Note:_ You can check
+   *        available operation with ArithmeticCell::is_arithmetic()
+   * \param symbol interned symbol of the operator
+   * \throw logic_error if symbol is not an arithmetic operator
    */
-  ArithmeticCell(const char* const s);
+  ArithmeticCell(const SymbolCell* const symbol) throw (std::logic_error);
 
 
   /**
    * \brief Checks if operator is currently available. Static since no instance
    *        is required.
    */
-  static bool is_arithmetic(std::string s);
+  static bool is_arithmetic(const SymbolCell* op);
 
   /**
    * \brief Method to execution a single calculation
    */
-  Cell* calculate(Cell* c1, Cell* c2) const throw (std::runtime_error);
+  Cell* calculate(Cell* c1, Cell* c2) const throw (std::runtime_error) {
+    return binary_m(c1, c2);
+  }
+
+  /**
+   * \brief Used for single argument calls. 
+   */
+  Cell* calculate(Cell* c) const throw (std::runtime_error) {
+    return unary_m(c);
+  }
+
+  /**
+   * \brief Calculates from left to right over n >= 2 evaluated
+   *        arguments. Sums and differences of ints are computed in a
+   *        single (vectorizable) loop
+   */
+  Cell* calculate(Cell* const* values, size_t n) const throw (std::runtime_error);
   
   /**
    * \brief Used for generalization, and getting rid of various if-else
@@ -438,18 +1043,22 @@ public:
    */
   virtual Cell* apply(Cell* const args) const throw (std::runtime_error);
 
-private:  
+private:
+  typedef Cell* (*binary_op)(Cell*, Cell*);
+  typedef Cell* (*unary_op)(Cell*);
+
+  binary_op binary_m;
+  unary_op  unary_m;
+  Cell*     identity_m;     ///< NULL if there is none (- and /)
+  int       sum_sign_m;     ///< sign of further operands of + (1) and - (-1),
+                            ///< 0 for the other operators
+
   /**
    * \brief Used e.g. for zero argument calls. Most likely, can be useful
    *        for other tasks
    * \throw runtime_error when called by - or / operator
    */
   Cell* get_identity() const throw (std::runtime_error);
-
-  /**
-   * \brief Used for single argument calls. 
-   */
-  Cell* calculate(Cell* c) const;
 };
 
 
@@ -461,47 +1070,82 @@ private:
 class FunctionCell : public SymbolCell {
 public:
 
+  /**
+   * \typedef func typedef for the function pointers of the builtins
+   */
+  typedef Cell*(*func)(const FunctionCell*, Cell*);
+
   /**
    * \brief Constructor for an FunctionCell, which is capable to handle 
    *        functions with fixed paramterss (as opposed to the
-   *        ArithmeticCell). _Note:_ You can check available operation
-   *        with FunctionCell::is_arithmetic()
+   *        ArithmeticCell). There is one shared FunctionCell per function,
+   *        created by the FunctionManager. _Note:_ You can check available
+   *        operation with FunctionCell::is_function()
+   * \param symbol interned symbol of the function name
+   * \param function called with the unevaluated arguments
+   * \param min_args least number of arguments
+   * \param max_args greatest number of arguments, -1 if unlimited
    */
-  FunctionCell(const char* const s);
+  FunctionCell(const SymbolCell* const symbol, func function, int min_args, int max_args);
 
   /**
    * \brief Checks if function is currentlyavailable. Static since no 
    *        instance is required.
    */
-  static bool is_function(std::string fname);
+  static bool is_function(const SymbolCell* fname);
+
+  /**
+   * \brief Checks if the function can be called with num_args arguments.
+   *        The function itself checks its arguments once more when it is
+   *        called, this is used to decide how a call can be compiled
+   */
+  bool accepts(int num_args) const;
 
   /**
    * \brief Used for generalization, and getting rid of various if-else
    *        statements. Overrides CellABC's method.
    */
   virtual Cell* apply(Cell* const args) const throw (std::runtime_error);
-  
+
+private:
+  /**
+   * \throw runtime_error if there are no args but the function is not
+   *        nullary
+   */
+  void check_nullary(Cell* const args) const throw (std::runtime_error);
+
+  func function_m;
+  int  min_args_m;
+  int  max_args_m;               ///< -1 if unlimited
 };
 
 
 /**
  * \class ProcedureCell
  *
- * \brief Implements CellABC for Cells containing a procedure. Uses
- *        Lisp ConsPair List approach in order to have a powerful
- *        general purpose data type.
+ * \brief Implements CellABC for Cells containing a procedure. Parameters,
+ *        body and the compiled code are kept in a CodeCell, which is
+ *        shared by all procedures created by the same lambda expression.
  */
 class ProcedureCell : public Cell {  
 public:
   /**
-   * \brief Constructor to make cons cell.
+   * \brief Constructor to make a procedure cell.
    */
   ProcedureCell(Cell* const my_car, Cell* const my_cdr);
 
   /**
-   * \brief Make sure it cleans up properly
+   * \brief Constructor to make a procedure cell sharing the code (and
+   *        therefore parameters and body) with other procedures
+   */
+  ProcedureCell(CodeCell* const code);
+
+  /**
+   * \brief Parameters and body are part of the parse tree, therefore they
+   *        are not deleted here but traced (via the CodeCell) for the
+   *        GarbageCollector
    */
-  virtual ~ProcedureCell();
+  virtual void trace(std::vector<Cell*>& children) const;
 
   /**
    * \brief Implements type check of the Cell ABC
@@ -509,7 +1153,6 @@ public:
    */
   virtual bool is_lambda() const;
 
-  /// \todo do we need that?
   /**
    * \brief Implements Accessor of the Cell ABC
    */
@@ -520,9 +1163,16 @@ public:
    */
   virtual Cell* get_body() const throw (std::runtime_error);
 
+  /**
+   * \brief Compiled code of the body, is compiled by the first call
+   */
+  CodeCell* get_code() const;
+
   /**
    * \brief Used for generalization, and getting rid of various if-else
-   *        statements. Overrides CellABC's method.
+   *        statements. Overrides CellABC's method. Calls of procedures
+   *        from compiled code do not go through this method, see
+   *        VirtualMachine
    */
   virtual Cell* apply(Cell* const args) const throw (std::runtime_error);
 
@@ -533,11 +1183,7 @@ public:
   virtual void print(std::ostream& os = std::cout) const;
 
 private:
-  Cell* param;
-  Cell* body;
-
-  /** \brief -1 Indicates variable number of arguments */
-  int num_param;
+  CodeCell* code_m;
 
 };
 
@@ -0,0 +1,522 @@
+#include "Compiler.hpp"
+#include "FunctionManager.hpp"
+#include "SymbolManager.hpp"
+
+#include "cons.hpp"
+
+/// define static members
+Compiler* Compiler::instance = NULL;
+
+Compiler::Compiler() {
+  /// special forms
+  add_builtin("quote",   FORM_QUOTE);
+  add_builtin("if",      FORM_IF);
+  add_builtin("define",  FORM_DEFINE);
+  add_builtin("lambda",  FORM_LAMBDA);
+  add_builtin("let",     FORM_LET);
+  add_builtin("<",       FORM_LESS);
+  add_builtin("apply",   FORM_APPLY);
+
+  add_builtin("ceiling", FORM_ARGS, OP_CEILING);
+  add_builtin("floor",   FORM_ARGS, OP_FLOOR);
+  add_builtin("cons",    FORM_ARGS, OP_CONS);
+  add_builtin("car",     FORM_ARGS, OP_CAR);
+  add_builtin("cdr",     FORM_ARGS, OP_CDR);
+  add_builtin("intp",    FORM_ARGS, OP_INTP);
+  add_builtin("doublep", FORM_ARGS, OP_DOUBLEP);
+  add_builtin("symbolp", FORM_ARGS, OP_SYMBOLP);
+  add_builtin("nullp",   FORM_ARGS, OP_NULLP);
+  add_builtin("listp",   FORM_ARGS, OP_LISTP);
+  add_builtin("not",     FORM_ARGS, OP_NOT);
+  add_builtin("print",   FORM_ARGS, OP_PRINT);
+  add_builtin("eval",    FORM_ARGS, OP_EVAL);
+  add_builtin("parse",   FORM_ARGS, OP_PARSE);
+  add_builtin("parse-eval", FORM_ARGS, OP_PARSE_EVAL);
+  add_builtin("rand",    FORM_ARGS, OP_RAND);
+  add_builtin("str",     FORM_ARGS, OP_STR);
+  add_builtin("substr",  FORM_ARGS, OP_SUBSTR);
+  add_builtin("appstr",  FORM_ARGS, OP_APPSTR);
+  add_builtin("gc-growth", FORM_ARGS, OP_GC_GROWTH);
+  add_builtin("make-vector",   FORM_ARGS, OP_MAKE_VECTOR);
+  add_builtin("vector-ref",    FORM_ARGS, OP_VECTOR_REF);
+  add_builtin("vector-set!",   FORM_ARGS, OP_VECTOR_SET);
+  add_builtin("vector-length", FORM_ARGS, OP_VECTOR_LENGTH);
+  add_builtin("vectorp",       FORM_ARGS, OP_VECTORP);
+  add_builtin("string-length",  FORM_ARGS, OP_STRING_LENGTH);
+  add_builtin("string-ref",     FORM_ARGS, OP_STRING_REF);
+  add_builtin("string-set!",    FORM_ARGS, OP_STRING_SET);
+  add_builtin("string-append!", FORM_ARGS, OP_STRING_APPEND);
+  add_builtin("stringp",        FORM_ARGS, OP_STRINGP);
+  add_builtin("make-string",    FORM_ARGS, OP_MAKE_STRING);
+  add_builtin("substring",      FORM_ARGS, OP_SUBSTRING);
+  add_builtin("string->symbol", FORM_ARGS, OP_STRING_TO_SYMBOL);
+  add_builtin("symbol->string", FORM_ARGS, OP_SYMBOL_TO_STRING);
+  add_builtin("eq?",                  FORM_ARGS, OP_EQ);
+  add_builtin("equal?",               FORM_ARGS, OP_EQUAL);
+  add_builtin("hash-table-ref",       FORM_ARGS, OP_HASH_TABLE_REF);
+  add_builtin("hash-table-set!",      FORM_ARGS, OP_HASH_TABLE_SET);
+  add_builtin("hash-table-delete!",   FORM_ARGS, OP_HASH_TABLE_DELETE);
+  add_builtin("hash-table-contains?", FORM_ARGS, OP_HASH_TABLE_CONTAINS);
+  add_builtin("hash-table-count",     FORM_ARGS, OP_HASH_TABLE_COUNT);
+  add_builtin("make-hash-table",      FORM_ARGS, OP_MAKE_HASH_TABLE);
+  add_builtin("hash-table-keys",      FORM_ARGS, OP_HASH_TABLE_KEYS);
+  add_builtin("hash-table-values",    FORM_ARGS, OP_HASH_TABLE_VALUES);
+  add_builtin("hash-table->alist",    FORM_ARGS, OP_HASH_TABLE_TO_ALIST);
+  add_builtin("hash-table-walk",      FORM_ARGS, OP_HASH_TABLE_WALK);
+  add_builtin("hash-table?",          FORM_ARGS, OP_HASH_TABLEP);
+  add_builtin("length",    FORM_ARGS, OP_LENGTH);
+  add_builtin("append",    FORM_ARGS, OP_APPEND);
+  add_builtin("reverse",   FORM_ARGS, OP_REVERSE);
+  add_builtin("assoc",     FORM_ARGS, OP_ASSOC);
+  add_builtin("list-tail", FORM_ARGS, OP_LIST_TAIL);
+  add_builtin("list-ref",  FORM_ARGS, OP_LIST_REF);
+  add_builtin("list-sort", FORM_ARGS, OP_LIST_SORT);
+
+  /// CSI compatability
+  add_builtin("int?",    FORM_ARGS, OP_INTP);
+  add_builtin("double?", FORM_ARGS, OP_DOUBLEP);
+  add_builtin("symbol?", FORM_ARGS, OP_SYMBOLP);
+  add_builtin("null?",   FORM_ARGS, OP_NULLP);
+  add_builtin("list?",   FORM_ARGS, OP_LISTP);
+  add_builtin("vector?", FORM_ARGS, OP_VECTORP);
+  add_builtin("string?", FORM_ARGS, OP_STRINGP);
+
+  /// every other function of the FunctionManager is called with its
+  /// unevaluated arguments (OP_APPLY_RAW)
+}
+
+/// Singleton Pattern
+Compiler* Compiler::Instance() {
+  if (instance == NULL) {
+    instance = new Compiler();
+  }
+  return instance;
+}
+
+void Compiler::add_builtin(const string& name, Form form, Opcode op) {
+  const SymbolCell* sym = SymbolManager::Instance()->intern(name);
+
+  /// the FunctionManager pins the FunctionCell and therefore the symbol,
+  /// the map is not scanned by the GarbageCollector
+  const FunctionCell* function = FunctionManager::Instance()->get_function(sym);
+  if (function == NULL) {
+    throw logic_error("Can not compile unknown function " + name);
+  }
+
+  Builtin builtin;
+  builtin.form_m     = form;
+  builtin.op_m       = op;
+  builtin.function_m = function;
+  builtins_m[sym] = builtin;
+}
+
+CodeCell* Compiler::compile(Cell* const c) {
+  CodeCell* code = new CodeCell();
+  compile_tail(code, c);
+
+  return code;
+}
+
+void Compiler::compile_procedure(CodeCell* const code) {
+  if (code->compiled_m) {
+    return;
+  }
+
+  Cell* pos = code->formals_m;
+  if (code->num_param_m == -1) {
+    code->params_m.push_back(get_interned(pos));
+  }
+  else {
+    while (!nullp(pos)) {
+      code->params_m.push_back(get_interned(car(pos)));
+      pos = cdr(pos);
+    }
+  }
+
+  pos = code->body_m;
+  if (nullp(pos)) {
+    emit(code, OP_CONST, 0, nil);
+    emit(code, OP_RETURN);
+  }
+  else if (code->num_param_m == -1) {
+    /// in case of variable number of args, the result of every
+    /// expression is evaluated once more. There is no tail position
+    while (!nullp(pos)) {
+      compile_nested(code, car(pos));
+      emit(code, OP_EVAL_AGAIN);
+
+      pos = cdr(pos);
+      if (!nullp(pos)) {
+	emit(code, OP_POP);
+      }
+    }
+    emit(code, OP_RETURN);
+  }
+  else {
+    /// only the result of the last expression is returned, it is in
+    /// tail position
+    while (!nullp(cdr(pos))) {
+      compile_nested(code, car(pos));
+      emit(code, OP_POP);
+      pos = cdr(pos);
+    }
+    compile_tail(code, car(pos));
+  }
+
+  code->compiled_m = true;
+}
+
+size_t Compiler::emit(CodeCell* code, Opcode op, int n, Cell* cell) {
+  Instruction instruction;
+  instruction.op   = op;
+  instruction.n    = n;
+  instruction.cell = cell;
+
+  code->code_m.push_back(instruction);
+  return code->code_m.size() - 1;
+}
+
+void Compiler::patch(CodeCell* code, size_t index) {
+  code->code_m[index].n = code->code_m.size();
+}
+
+void Compiler::compile_tail(CodeCell* code, Cell* c) {
+  if (nullp(c) || !listp(c)) {
+    compile_atom(code, c);
+    emit(code, OP_RETURN);
+    return;
+  }
+
+  Cell* op = car(c);
+  if (symbolp(op)) {
+    const SymbolCell* sym = get_interned(op);
+
+    if (FunctionManager::Instance()->get_builtin(sym) != NULL) {
+      compile_builtin(code, sym, c, true);
+      return;
+    }
+  }
+
+  compile_call(code, c);
+}
+
+void Compiler::compile_nested(CodeCell* code, Cell* c) {
+  if (nullp(c) || !listp(c)) {
+    compile_atom(code, c);
+    return;
+  }
+
+  Cell* op = car(c);
+  if (symbolp(op)) {
+    const SymbolCell* sym = get_interned(op);
+
+    if (FunctionManager::Instance()->get_builtin(sym) != NULL) {
+      compile_builtin(code, sym, c, false);
+      return;
+    }
+  }
+
+  /// the call is in tail position of the nested evaluation
+  size_t enter = emit(code, OP_ENTER);
+  compile_call(code, c);
+  patch(code, enter);
+}
+
+void Compiler::compile_atom(CodeCell* code, Cell* c) {
+  if (nullp(c)) {
+    /// () is a list without operator: fails like car of ()
+    emit(code, OP_CONST, 0, nil);
+    emit(code, OP_CAR);
+    return;
+  }
+
+  if (symbolp(c)) {
+    const SymbolCell* sym = get_interned(c);
+    const SymbolCell* builtin = FunctionManager::Instance()->get_builtin(sym);
+
+    if (builtin != NULL) {
+      emit(code, OP_CONST, 0, (Cell*) builtin);
+      return;
+    }
+
+    emit(code, OP_REF, 0, (Cell*) sym);
+    return;
+  }
+
+  /// everything else evaluates to itself
+  emit(code, OP_CONST, 0, c);
+}
+
+void Compiler::compile_builtin(CodeCell* code, const SymbolCell* sym, Cell* c, bool tail) {
+  size_t guard = emit(code, OP_GUARD, 0, (Cell*) sym);
+  bool ended = compile_arguments(code, sym, cdr(c), tail);
+
+  if (tail) {
+    if (!ended) {
+      emit(code, OP_RETURN);
+    }
+    patch(code, guard);
+    compile_call(code, c);
+  }
+  else {
+    size_t jump = emit(code, OP_JUMP);
+    patch(code, guard);
+
+    size_t enter = emit(code, OP_ENTER);
+    compile_call(code, c);
+    patch(code, enter);
+    patch(code, jump);
+  }
+}
+
+bool Compiler::compile_arguments(CodeCell* code, const SymbolCell* sym, Cell* args, bool tail) {
+  int num_args = list_size(args);
+
+  Cell* arithmetic = (Cell*) FunctionManager::Instance()->get_arithmetic(sym);
+
+  if (arithmetic != NULL) {
+    if (num_args < 1) {
+      emit(code, OP_APPLY_RAW, 0, arithmetic);
+      emit(code, OP_ARGS, 0, args);
+      return false;
+    }
+
+    compile_nested(code, car(args));
+    if (num_args == 1) {
+      emit(code, OP_ARITH1, 0, arithmetic);
+      return false;
+    }
+
+    if (num_args == 2) {
+      compile_nested(code, car(cdr(args)));
+      emit(code, OP_ARITH, 0, arithmetic);
+      return false;
+    }
+
+    /// longer chains are calculated at once, after all arguments have
+    /// been evaluated
+    for (Cell* pos = cdr(args); !nullp(pos); pos = cdr(pos)) {
+      compile_nested(code, car(pos));
+    }
+    emit(code, OP_ARITH_N, num_args, arithmetic);
+    return false;
+  }
+
+  map<const SymbolCell*, Builtin>::iterator it = builtins_m.find(sym);
+
+  if (it != builtins_m.end()) {
+    const Builtin& builtin = it->second;
+
+    switch (builtin.form_m) {
+    case FORM_QUOTE:
+      if (num_args == 1) {
+	emit(code, OP_CONST, 0, car(args));
+	return false;
+      }
+      break;
+
+    case FORM_IF:
+      if (num_args == 2 || num_args == 3) {
+	compile_nested(code, car(args));
+	size_t jump_false = emit(code, OP_JUMP_FALSE);
+
+	if (tail) {
+	  compile_tail(code, car(cdr(args)));
+	  patch(code, jump_false);
+	  if (num_args == 3) {
+	    compile_tail(code, car(cdr(cdr(args))));
+	  }
+	  else {
+	    emit(code, OP_CONST, 0, nil);  /// unspecified
+	    emit(code, OP_RETURN);
+	  }
+	  return true;
+	}
+
+	compile_nested(code, car(cdr(args)));
+	size_t jump = emit(code, OP_JUMP);
+	patch(code, jump_false);
+	if (num_args == 3) {
+	  compile_nested(code, car(cdr(cdr(args))));
+	}
+	else {
+	  emit(code, OP_CONST, 0, nil);    /// unspecified
+	}
+	patch(code, jump);
+	return false;
+      }
+      break;
+
+    case FORM_DEFINE:
+      if (num_args == 2 && symbolp(car(args))) {
+	compile_nested(code, car(cdr(args)));
+	emit(code, OP_DEFINE, 1, (Cell*) get_interned(car(args)));
+	return false;
+      }
+      break;
+
+    case FORM_LAMBDA:
+      if (is_valid_lambda(args)) {
+	emit(code, OP_LAMBDA, 0, new CodeCell(car(args), cdr(args)));
+	return false;
+      }
+      break;
+
+    case FORM_LET:
+      if (num_args == 2 && is_valid_let(args)) {
+	if (tail) {
+	  compile_let(code, args);
+	  return true;
+	}
+
+	size_t enter = emit(code, OP_ENTER);
+	compile_let(code, args);
+	patch(code, enter);
+	return false;
+      }
+      break;
+
+    case FORM_LESS:
+      if (num_args == -1) {
+	break;
+      }
+      if (num_args < 2) {
+	/// the arguments are not evaluated at all
+	emit(code, OP_CONST, 0, make_int(1));
+	return false;
+      }
+
+      /// the first argument decides between comparing symbols and
+      /// numbers, every argument is evaluated once more for comparing
+      compile_nested(code, car(args));
+      for (Cell* pos = args; !nullp(cdr(pos)); pos = cdr(pos)) {
+	compile_nested(code, car(pos));
+	compile_nested(code, car(cdr(pos)));
+      }
+      emit(code, OP_LESS, num_args);
+      return false;
+
+    case FORM_APPLY:
+      /// further arguments are ignored
+      if (num_args >= 2) {
+	compile_nested(code, car(args));
+	compile_nested(code, car(cdr(args)));
+	emit(code, OP_APPLY);
+	return false;
+      }
+      break;
+
+    case FORM_ARGS:
+      if (builtin.function_m->accepts(num_args)) {
+	for (Cell* pos = args; !nullp(pos); pos = cdr(pos)) {
+	  compile_nested(code, car(pos));
+	}
+	emit(code, builtin.op_m, num_args);
+	return false;
+      }
+      break;
+    }
+  }
+
+  /// the function checks its arguments itself (and throws)
+  emit(code, OP_APPLY_RAW, 0, (Cell*) FunctionManager::Instance()->get_function(sym));
+  emit(code, OP_ARGS, 0, args);
+  return false;
+}
+
+void Compiler::compile_call(CodeCell* code, Cell* c) {
+  Cell* op = car(c);
+  Cell* args = cdr(c);
+  int num_args = list_size(args);
+
+  if (symbolp(op)) {
+    emit(code, OP_PREPARE, num_args, (Cell*) get_interned(op));
+  }
+  else if (listp(op)) {
+    /// in case for nested cases such as ((quote if) 1 0)
+    compile_nested(code, op);
+    emit(code, OP_PREPARE_DYNAMIC, num_args);
+  }
+  else {
+    emit(code, OP_NO_OPERATOR);
+    return;
+  }
+  size_t applied = emit(code, OP_ARGS, 0, args);
+
+  /// every argument is evaluated right before its parameter is defined
+  if (num_args > 0) {
+    int i = 0;
+    for (Cell* pos = args; !nullp(pos); pos = cdr(pos)) {
+      compile_nested(code, car(pos));
+      emit(code, OP_BIND, i++);
+    }
+  }
+  emit(code, OP_TAIL_CALL);
+
+  /// procedures with a variable number of arguments and functions are
+  /// applied to the unevaluated arguments by OP_PREPARE right away
+  patch(code, applied);
+  emit(code, OP_RETURN);
+}
+
+void Compiler::compile_let(CodeCell* code, Cell* args) {
+  emit(code, OP_LET);
+
+  /// create local variables
+  for (Cell* pos = car(args); !nullp(pos); pos = cdr(pos)) {
+    compile_nested(code, car(cdr(car(pos))));
+    emit(code, OP_DEFINE, 0, (Cell*) get_interned(car(car(pos))));
+  }
+
+  compile_tail(code, car(cdr(args)));
+}
+
+bool Compiler::is_valid_lambda(Cell* args) {
+  if (list_size(args) < 2) {
+    return false;
+  }
+
+  Cell* formals = car(args);
+  if (!listp(formals)) {
+    return symbolp(formals);
+  }
+
+  if (list_size(formals) == -1) {
+    return false;
+  }
+  for (Cell* pos = formals; !nullp(pos); pos = cdr(pos)) {
+    if (!symbolp(car(pos))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Compiler::is_valid_let(Cell* args) {
+  Cell* bindings = car(args);
+
+  if (list_size(bindings) == -1) {
+    return false;
+  }
+  for (Cell* pos = bindings; !nullp(pos); pos = cdr(pos)) {
+    Cell* binding = car(pos);
+    if (nullp(binding) || !listp(binding) || !symbolp(car(binding))
+	|| nullp(cdr(binding)) || !listp(cdr(binding))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int Compiler::list_size(Cell* c) {
+  int size = 0;
+
+  while (!nullp(c)) {
+    if (!listp(c)) {
+      return -1;
+    }
+    c = cdr(c);
+    ++size;
+  }
+  return size;
+}
@@ -0,0 +1,177 @@
+/**
+ * \file Compiler
+ *
+ * \brief Translates s-expressions into the instructions of the
+ *        VirtualMachine
+ */
+
+#ifndef COMPILER_HPP
+#define COMPILER_HPP
+
+#include <map>
+#include "Cell.hpp"
+#include "bytecode.hpp"
+
+using namespace std;
+
+/**
+ * \class Compiler
+ *
+ * \brief Singleton Class which compiles expressions and bodies of
+ *        procedures into CodeCells
+ *
+ * The tree is inspected once while compiling: arities are counted,
+ * builtins are resolved to their instructions and special forms (quote,
+ * if, define, lambda, let) are compiled to jumps and definitions. The
+ * builtins keep their semantics, in particular
+ *   - a symbol defined as procedure takes precedence over a builtin of
+ *     the same name (checked at runtime by OP_GUARD)
+ *   - arguments are evaluated by the procedure right before the
+ *     corresponding parameter is defined, in the new stack frame
+ *   - calls of builtins which would throw (e.g. because of the number of
+ *     arguments) are compiled to calls of the builtin itself, which
+ *     throws at runtime
+ *
+ * Expressions are compiled either in tail position or nested. In tail
+ * position the code ends the current evaluation, which means calls of
+ * procedures become tail calls. Nested expressions push their value.
+ */
+class Compiler {
+public:
+
+  /**
+   * \brief Should be used to get the instance of this class. Will
+   *        instantiate itself if is is not done yet. --> Singleton
+   *        pattern
+   */
+  static Compiler* Instance();
+
+  /**
+   * \brief Compiles the expression c
+   * \return code which evaluates c and returns its value
+   */
+  CodeCell* compile(Cell* const c);
+
+  /**
+   * \brief Compiles the body of a procedure into code, if not done yet.
+   *        See ProcedureCell::get_code()
+   */
+  void compile_procedure(CodeCell* const code);
+
+private:
+  /**
+   * \brief How arguments of a builtin are compiled
+   */
+  enum Form {
+    FORM_QUOTE,
+    FORM_IF,
+    FORM_DEFINE,
+    FORM_LAMBDA,
+    FORM_LET,
+    FORM_LESS,
+    FORM_APPLY,
+    FORM_ARGS            ///< evaluated arguments, followed by the opcode
+  };
+
+  /**
+   * \struct Builtin
+   *
+   * \brief Instruction of a builtin and its arguments
+   */
+  struct Builtin {
+    Form                form_m;
+    Opcode              op_m;       ///< only used by FORM_ARGS
+    const FunctionCell* function_m; ///< shared, knows the arity
+  };
+
+  static Compiler* instance;
+  map<const SymbolCell*, Builtin> builtins_m;
+
+  /**
+   * \brief Constructor is private --> Singleton Pattern
+   */
+  Compiler();
+
+  /**
+   * \brief Makes sure there is no copy constructor
+   */
+  Compiler(Compiler const&);
+
+  /**
+   * \brief Makes sure no assignments are possible
+   */
+  void operator=(Compiler const&);
+
+  /**
+   * \brief Registers a builtin of the FunctionManager which is compiled
+   *        to an instruction
+   */
+  void add_builtin(const string& name, Form form, Opcode op = OP_CONST);
+
+  /**
+   * \brief Appends an instruction to the code
+   * \return index of the instruction
+   */
+  size_t emit(CodeCell* code, Opcode op, int n = 0, Cell* cell = NULL);
+
+  /**
+   * \brief Lets the jump at index continue at the end of the code
+   */
+  void patch(CodeCell* code, size_t index);
+
+  /**
+   * \brief Compiles c, the code ends the current evaluation
+   */
+  void compile_tail(CodeCell* code, Cell* c);
+
+  /**
+   * \brief Compiles c, the code pushes the value of c
+   */
+  void compile_nested(CodeCell* code, Cell* c);
+
+  /**
+   * \brief Compiles an expression which is not a list
+   */
+  void compile_atom(CodeCell* code, Cell* c);
+
+  /**
+   * \brief Compiles a call of the builtin or arithmetic operator sym
+   */
+  void compile_builtin(CodeCell* code, const SymbolCell* sym, Cell* c, bool tail);
+
+  /**
+   * \brief Compiles the arguments of a builtin
+   * \return true if the code ends the current evaluation (only possible
+   *         in tail position)
+   */
+  bool compile_arguments(CodeCell* code, const SymbolCell* sym, Cell* args, bool tail);
+
+  /**
+   * \brief Compiles a call of whatever the operator evaluates to, usually
+   *        a procedure. The code ends the current evaluation
+   */
+  void compile_call(CodeCell* code, Cell* c);
+
+  /**
+   * \brief Compiles let in tail position
+   */
+  void compile_let(CodeCell* code, Cell* args);
+
+  /**
+   * \brief Checks if the lambda expression would be accepted by lambda_func
+   */
+  static bool is_valid_lambda(Cell* args);
+
+  /**
+   * \brief Checks if all bindings of a let have the form (symbol value)
+   */
+  static bool is_valid_let(Cell* args);
+
+  /**
+   * \brief Number of elements of the list c
+   * \return -1 if c is not a proper list
+   */
+  static int list_size(Cell* c);
+};
+
+#endif
@@ -3,7 +3,9 @@
 #include "cons.hpp"
 
 /// define static members
-vector<DefinitionManager::DefMap> DefinitionManager::defs_stack_m;
+vector<DefinitionManager::Frame> DefinitionManager::defs_stack_m;
+vector<DefinitionManager::Binding> DefinitionManager::bindings_m;
+size_t DefinitionManager::activations_m = 0;
 DefinitionManager* DefinitionManager::instance = NULL;
 
 DefinitionManager::DefinitionManager() {
@@ -20,40 +22,84 @@ DefinitionManager* DefinitionManager::Instance() {
 }
 
 void DefinitionManager::add_stackframe() {
-  defs_stack_m.push_back(DefMap());
+  Frame frame;
+  frame.first_binding_m = bindings_m.size();
+  frame.first_activation_m = frame.activation_m = ++activations_m;
+  defs_stack_m.push_back(frame);
+}
+
+void DefinitionManager::add_tail_stackframe(bool& framed) {
+  if (!framed) {
+    add_stackframe();
+    framed = true;
+    return;
+  }
+  defs_stack_m.back().activation_m = ++activations_m;
 }
 
 void DefinitionManager::pop_stackframe() throw (logic_error) {
   if (defs_stack_m.size() < 1) {
     throw logic_error("Logic error in the frame management of definition stack");
   }
+
+  /// restore in reverse order
+  size_t first = defs_stack_m.back().first_binding_m;
+  for (size_t i = bindings_m.size(); i > first; --i) {
+    const Binding& b = bindings_m[i - 1];
+    b.symbol_m->value_m = b.shadowed_m;
+    b.symbol_m->activation_m = b.activation_m;
+  }
+
+  bindings_m.resize(first);
   defs_stack_m.pop_back();
 }
 
-void DefinitionManager::add_definition(string key, Cell* c) throw (runtime_error) {
-  DefMap& def_map = defs_stack_m.back();
+void DefinitionManager::add_definition(const SymbolCell* key, Cell* c) throw (runtime_error) {
+  Frame& frame = defs_stack_m.back();
+
+  if (key->value_m != NULL && key->activation_m >= frame.first_activation_m) {
+    if (key->activation_m == frame.activation_m) {
+      throw runtime_error("Can not redefine symbol!");
+    }
 
-  pair<DefMap::iterator, bool> ret = def_map.insert(pair<string, Cell*>(key, c));
+    /// defined by an earlier activation of this frame (tail call), the
+    /// frame restores the definition from before the frame anyway
+    key->value_m = c;
+    key->activation_m = frame.activation_m;
+    return;
+  }
 
-  if (ret.second == false) {
-    throw runtime_error("Can not redefine symbol!");
-  }  
+  Binding binding;
+  binding.symbol_m     = key;
+  binding.shadowed_m   = key->value_m;
+  binding.activation_m = key->activation_m;
+  bindings_m.push_back(binding);
+
+  key->value_m = c;
+  key->activation_m = frame.activation_m;
 }
 
-bool DefinitionManager::is_definition(string key) {
-  for (vector<DefMap>::reverse_iterator i = defs_stack_m.rbegin(); i < defs_stack_m.rend(); ++i) {
-    if (!((*i).find(key) == (*i).end())) {
-	return true;
-    }
+bool DefinitionManager::is_definition(const SymbolCell* key) {
+  return key->value_m != NULL;
+}
+
+Cell* DefinitionManager::get_definition(const SymbolCell* key) const throw (runtime_error) {
+  if (key->value_m == NULL) {
+    throw runtime_error("Symbol is not defined!");
   }
-  return false; 
+  return key->value_m;
 }
 
-Cell* DefinitionManager::get_definition(string key) const throw (runtime_error) {
-  for (vector<DefMap>::reverse_iterator i = defs_stack_m.rbegin(); i < defs_stack_m.rend(); ++i) {
-    if (!((*i).find(key) == (*i).end())) {
-      return (*i)[key];
-    }
+void DefinitionManager::get_globals(vector<const SymbolCell*>& symbols) const {
+  size_t end = defs_stack_m.size() > 1 ? defs_stack_m[1].first_binding_m : bindings_m.size();
+  for (size_t i = 0; i < end; ++i) {
+    symbols.push_back(bindings_m[i].symbol_m);
+  }
+}
+
+void DefinitionManager::get_roots(vector<Cell*>& roots) const {
+  for (vector<Binding>::const_iterator b = bindings_m.begin(); b != bindings_m.end(); ++b) {
+    roots.push_back((Cell*) (*b).symbol_m);
+    roots.push_back((*b).shadowed_m);
   }
-  throw runtime_error("Symbol is not defined!");
 }
@@ -7,9 +7,6 @@
 #ifndef DEFINITIONMANAGER_HPP
 #define DEFINITIONMANAGER_HPP
 
-#include "hashtablemap.hpp"
-
-#include <map>
 #include <vector>
 #include <stdexcept>
 #include "Cell.hpp"
@@ -28,6 +25,20 @@ using namespace std;
  * DefinitionManager to initialize itself only ones (and also the
  * default global definition table), without the need to hook into the
  * entrypoint of the programm.
+ *
+ * Variables are scoped dynamically: a symbol refers to its most recent
+ * definition on the "stack". Instead of searching the stack frames
+ * from the top (deep binding), the current definition is stored in the
+ * interned SymbolCell itself (shallow binding). A stack frame only
+ * remembers what it has to restore when it is popped. Therefore looking
+ * up a definition is a single load, independent of the call depth, and
+ * the parser has already resolved every reference to its SymbolCell by
+ * interning it.
+ *
+ * Tail calls do not add stack frames, otherwise a loop would grow the
+ * stack: the callee starts a new activation in the stack frame of the
+ * caller instead (see add_tail_stackframe()). Definitions of an earlier
+ * activation are still visible, as they would be in the frame below.
  */
 class DefinitionManager {
 public:
@@ -38,55 +49,104 @@ public:
    *        pattern
    */
   static DefinitionManager* Instance();
-  
+
   /**
    * \brief Adds a local stack frame
    */
   void add_stackframe();
 
   /**
-   * \brief Pops local stack frame
+   * \brief Used for tail calls by the VirtualMachine: starts a new
+   *        activation in the stack frame of the current evaluation, or
+   *        adds the stack frame if it does not have one yet.
+   * \param framed true if the evaluation has a stack frame, is set to true
+   */
+  void add_tail_stackframe(bool& framed);
+
+  /**
+   * \brief Pops local stack frame and restores the definitions it has
+   *        shadowed
    */
   void pop_stackframe() throw (logic_error);
 
   /**
-   * \brief Adds definition to the current stack frame
+   * \brief Adds definition to the current stack frame. A symbol can be
+   *        defined only once per activation.
+   * \param key interned symbol, see SymbolCell::get_interned()
    */
-  void add_definition(string key, Cell* c) throw (runtime_error);
+  void add_definition(const SymbolCell* key, Cell* c) throw (runtime_error);
 
   /**
-   * \brief Checks if definition is available. Goes from through all "stack" frames
+   * \brief Checks if definition is available in any "stack" frame
    */
-  bool is_definition(string key);
-  
+  bool is_definition(const SymbolCell* key);
+
+  /**
+   * \brief get the current definition of key
+   */
+  Cell* get_definition(const SymbolCell* key) const throw (runtime_error);
+
   /**
-   * \brief get the definition, will look through the whole vector "stack" in order
-   *        to find occurence
+   * \brief Collects the symbols defined in the global frame, in the order
+   *        they have been defined. Remarks: only meaningful while no other
+   *        frame exists, their definitions are the current ones then
    */
-  Cell* get_definition(string key) const throw (runtime_error);
+  void get_globals(vector<const SymbolCell*>& symbols) const;
+
+  /**
+   * \brief Pushes the symbols of all "stack" frames and the definitions
+   *        they have shadowed onto roots. The current definitions are
+   *        traced by their symbols. Used by the GarbageCollector
+   */
+  void get_roots(vector<Cell*>& roots) const;
 
 private:
-  /// typedef aliases for readability
-  typedef hashtablemap<string, Cell*> DefMap;
+  /**
+   * \struct Binding
+   *
+   * \brief Remembers the definition a symbol had before it was defined
+   *        in a stack frame
+   */
+  struct Binding {
+    const SymbolCell* symbol_m;
+    Cell*             shadowed_m;     ///< NULL if there was none
+    size_t            activation_m;   ///< of the shadowed definition
+  };
+
+  /**
+   * \struct Frame
+   *
+   * \brief A stack frame. Activations are numbered increasingly, all
+   *        definitions of activations since first_activation_m belong
+   *        to this frame. Its bindings are on top of bindings_m, starting
+   *        at first_binding_m
+   */
+  struct Frame {
+    size_t first_binding_m;
+    size_t first_activation_m;
+    size_t activation_m;                  ///< current activation
+  };
 
   static DefinitionManager* instance;
-  static vector< DefMap > defs_stack_m;
+  static vector< Frame > defs_stack_m;
+  static vector< Binding > bindings_m;    ///< of all frames, shared so
+                                          ///< calls do not allocate
+  static size_t activations_m;            ///< last activation number
 
   /**
    * \brief Constructor is private --> Singleton Pattern
    */
   DefinitionManager();
-  
+
   /**
    * \brief Makes sure there is no copy constructor
    */
   DefinitionManager(DefinitionManager const&);
-  
+
   /** 
    * \brief Makes sure no assignments are possible
    */
   void operator=(DefinitionManager const&);
-
 };
 
 #endif
@@ -2,51 +2,148 @@
 #include "functions.hpp"
 
 #include "cons.hpp"
+#include "GarbageCollector.hpp"
 
+#include <cstring>
 #include <ctime>
 
 /// define static members
-map<string, FunctionManager::func> FunctionManager::func_defs_m;
+map<const SymbolCell*, const FunctionCell*> FunctionManager::func_defs_m;
 FunctionManager* FunctionManager::instance = NULL;
 
+/// size of the hash table, power of 2. At most half of it is used, so
+/// probe sequences stay short and indices fit into a signed char
+static const size_t BUILTIN_SLOTS = 256;
+
+const FunctionManager::Builtin FunctionManager::builtins_m[] = {
+  { "ceiling",    &ceiling_func,    1,  1 },
+  { "floor",      &floor_func,      1,  1 },
+  { "quote",      &quote_func,      1,  1 },
+  { "cons",       &cons_func,       2,  2 },
+  { "car",        &car_func,        1,  1 },
+  { "cdr",        &cdr_func,        1,  1 },
+  { "intp",       &intp_func,       1,  1 },
+  { "doublep",    &doublep_func,    1,  1 },
+  { "symbolp",    &symbolp_func,    1,  1 },
+  { "nullp",      &nullp_func,      1,  1 },
+  { "listp",      &listp_func,      1,  1 },
+  { "if",         &if_func,         2,  3 },
+  { "define",     &define_func,     2,  2 },
+  { "<",          &less_than_func,  0, -1 },
+  { "not",        &not_func,        1,  1 },
+  { "print",      &print_func,      1,  1 },
+  { "eval",       &eval_func,       1,  1 },
+  { "parse",      &parse_func,      1,  1 },
+  { "parse-eval", &parse_eval_func, 1,  1 },
+  { "lambda",     &lambda_func,     2, -1 },
+  { "apply",      &apply_func,      2, -1 },
+  { "let",        &let_func,        2,  2 },
+  { "rand",       &rand_func,       2,  2 },
+  { "str",        &str_func,        1,  1 },
+  { "substr",     &substr_func,     3,  3 },
+  { "appstr",     &appstr_func,     2,  2 },
+
+  /// vectors
+  { "make-vector",   &make_vector_func,   1,  2 },
+  { "vector-ref",    &vector_ref_func,    2,  2 },
+  { "vector-set!",   &vector_set_func,    3,  3 },
+  { "vector-length", &vector_length_func, 1,  1 },
+  { "vectorp",       &vectorp_func,       1,  1 },
+
+  /// strings
+  { "make-string",    &make_string_func,      1,  2 },
+  { "string-length",  &string_length_func,    1,  1 },
+  { "string-ref",     &string_ref_func,       2,  2 },
+  { "string-set!",    &string_set_func,       3,  3 },
+  { "string-append!", &string_append_func,    2,  2 },
+  { "substring",      &substring_func,        3,  3 },
+  { "string->symbol", &string_to_symbol_func, 1,  1 },
+  { "symbol->string", &symbol_to_string_func, 1,  1 },
+  { "stringp",        &stringp_func,          1,  1 },
+
+  /// hash tables
+  { "eq?",                 &eq_func,                  2,  2 },
+  { "equal?",              &equal_func,               2,  2 },
+  { "make-hash-table",     &make_hash_table_func,     0,  1 },
+  { "hash-table-ref",      &hash_table_ref_func,      2,  3 },
+  { "hash-table-set!",     &hash_table_set_func,      3,  3 },
+  { "hash-table-delete!",  &hash_table_delete_func,   2,  2 },
+  { "hash-table-contains?", &hash_table_contains_func, 2,  2 },
+  { "hash-table-count",    &hash_table_count_func,    1,  1 },
+  { "hash-table-keys",     &hash_table_keys_func,     1,  1 },
+  { "hash-table-values",   &hash_table_values_func,   1,  1 },
+  { "hash-table->alist",   &hash_table_to_alist_func, 1,  1 },
+  { "hash-table-walk",     &hash_table_walk_func,     2,  2 },
+  { "hash-table?",         &hash_tablep_func,         1,  1 },
+
+  /// list helpers
+  { "length",     &length_func,     1,  1 },
+  { "append",     &append_func,     2,  2 },
+  { "reverse",    &reverse_func,    1,  1 },
+  { "assoc",      &assoc_func,      2,  2 },
+  { "list-tail",  &list_tail_func,  2,  2 },
+  { "list-ref",   &list_ref_func,   2,  2 },
+  { "list-sort",  &list_sort_func,  2,  2 },
+
+  /// memory management
+  { "gc",         &gc_func,         0,  0 },
+  { "gc-stats",   &gc_stats_func,   0,  0 },
+  { "gc-growth",  &gc_growth_func,  1,  1 },
+
+  /// output
+  { "flush",        &flush_func,    0,  0 },
+  { "flush-output", &flush_func,    0,  0 },
+  { "write-fasl",   &write_fasl_func, 2,  2 },
+  { "read-fasl",    &read_fasl_func,  1,  1 },
+
+  /// CSI compatability
+  { "int?",       &intp_func,       1,  1 },
+  { "double?",    &doublep_func,    1,  1 },
+  { "symbol?",    &symbolp_func,    1,  1 },
+  { "null?",      &nullp_func,      1,  1 },
+  { "list?",      &listp_func,      1,  1 },
+  { "vector?",    &vectorp_func,    1,  1 },
+  { "string?",    &stringp_func,    1,  1 },
+
+  /// chainable operators (ArithmeticCell)
+  { "+",          NULL,             0, -1 },
+  { "-",          NULL,             0, -1 },
+  { "*",          NULL,             0, -1 },
+  { "/",          NULL,             0, -1 }
+};
+
+signed char FunctionManager::builtin_index_m[BUILTIN_SLOTS];
+
+const SymbolCell* FunctionManager::builtin_symbols_m[BUILTIN_SLOTS];
+
+const SymbolCell* FunctionManager::builtin_cells_m[BUILTIN_SLOTS];
+
 FunctionManager::FunctionManager() {
-  /// init -> is only supposed to be called once
-  add_function("ceiling", &ceiling_func);
-  add_function("floor",   &floor_func);
-  add_function("quote",   &quote_func);
-  add_function("cons",    &cons_func);
-  add_function("car",     &car_func);
-  add_function("cdr",     &cdr_func);
-  add_function("intp",    &intp_func);
-  add_function("doublep", &doublep_func);
-  add_function("symbolp", &symbolp_func);
-  add_function("nullp",   &nullp_func);
-  add_function("listp",   &listp_func);
-  add_function("if",      &if_func);
-  add_function("define",  &define_func);
-  add_function("<",       &less_than_func);
-  add_function("not",     &not_func);
-  add_function("print",   &print_func);
-  add_function("eval",    &eval_func);
-  add_function("parse",   &parse_func);
-  add_function("parse-eval", &parse_eval_func);
-  add_function("lambda",  &lambda_func);
-  add_function("apply",   &apply_func);
-  add_function("let",     &let_func);
-
-  add_function("rand",    &rand_func);
   srand(time(0));                            // seed for rand function
 
-  add_function("str",     &str_func);
-  add_function("substr",  &substr_func);
-  add_function("appstr",  &appstr_func);
+  int no_builtins = sizeof(builtins_m) / sizeof(builtins_m[0]);
+  if (no_builtins > (int) BUILTIN_SLOTS / 2) {
+    throw logic_error("Too many builtins for the hash table");
+  }
+
+  /// open addressing by the hash the SymbolManager computed when it
+  /// interned the name, a name which collides takes the next free slot.
+  /// The names stay interned, so lookups compare symbols by pointer
+  memset(builtin_index_m, -1, sizeof(builtin_index_m));
+  for (int i = 0; i < no_builtins; ++i) {
+    SymbolCell* symbol = SymbolManager::Instance()->intern(builtins_m[i].name_m);
+    GarbageCollector::Instance()->pin(symbol);
 
-  /// CSI compatability
-  add_function("int?",    &intp_func);
-  add_function("double?", &doublep_func);
-  add_function("symbol?", &symbolp_func);
-  add_function("null?",   &nullp_func);
-  add_function("list?",   &listp_func);
+    size_t slot = symbol->get_hash() & (BUILTIN_SLOTS - 1);
+    while (builtin_index_m[slot] != -1) {
+      if (builtin_symbols_m[slot] == symbol) {
+	throw logic_error(string("Builtin ") + builtins_m[i].name_m + " is listed twice");
+      }
+      slot = (slot + 1) & (BUILTIN_SLOTS - 1);
+    }
+    builtin_index_m[slot] = i;
+    builtin_symbols_m[slot] = symbol;
+  }
 }
 
 /// Singleton Pattern
@@ -57,30 +154,93 @@ FunctionManager* FunctionManager::Instance() {
   return instance;
 }
 
-void FunctionManager::add_function(string key, func function) throw (logic_error) {
-  pair<map<string, func>::iterator,bool> ret;
-  ret = func_defs_m.insert(pair<string, func>(key, function));
-  
-  if (ret.second == false) {
+int FunctionManager::find_builtin(const SymbolCell* key) {
+  const SymbolCell* symbol = key->get_interned();
+
+  for (size_t slot = key->get_hash() & (BUILTIN_SLOTS - 1); builtin_index_m[slot] != -1;
+       slot = (slot + 1) & (BUILTIN_SLOTS - 1)) {
+    if (builtin_symbols_m[slot] == symbol) {
+      return builtin_index_m[slot];
+    }
+  }
+  return -1;
+}
+
+const SymbolCell* FunctionManager::get_builtin_cell(int index) {
+  if (builtin_cells_m[index] == NULL) {
+    const Builtin& builtin = builtins_m[index];
+    SymbolCell* symbol = SymbolManager::Instance()->intern(builtin.name_m);
+
+    SymbolCell* cell;
+    if (builtin.function_m == NULL) {
+      cell = new ArithmeticCell(symbol);
+    }
+    else {
+      cell = new FunctionCell(symbol, builtin.function_m, builtin.min_args_m, builtin.max_args_m);
+    }
+
+    /// the table is not scanned by the GarbageCollector. The cell keeps
+    /// its symbol alive
+    GarbageCollector::Instance()->pin(cell);
+    builtin_cells_m[index] = cell;
+  }
+  return builtin_cells_m[index];
+}
+
+void FunctionManager::add_function(string key, func function, int min_args, int max_args) throw (logic_error) {
+  SymbolCell* symbol = SymbolManager::Instance()->intern(key);
+
+  if (find_builtin(symbol) != -1 || func_defs_m.find(symbol) != func_defs_m.end()) {
     /// logic_error, since the user can not define functions by themselves (yet)
     throw logic_error("Can not redefine function!");
   }
+
+  FunctionCell* cell = new FunctionCell(symbol, function, min_args, max_args);
+  func_defs_m[symbol] = cell;
+
+  /// the map is not scanned by the GarbageCollector. The cell keeps
+  /// its symbol alive
+  GarbageCollector::Instance()->pin(cell);
 }
 
-bool FunctionManager::is_function(string fname) {
-  return !(func_defs_m.find(fname) == func_defs_m.end());
+bool FunctionManager::is_function(const SymbolCell* fname) {
+  return get_function(fname) != NULL;
 }
 
-Cell* FunctionManager::call_function(const FunctionCell* func_cell, Cell* args) throw (runtime_error) {
-  string fname = func_cell->get_symbol();
+bool FunctionManager::is_arithmetic(const SymbolCell* fname) {
+  int index = find_builtin(fname);
+  return index != -1 && builtins_m[index].function_m == NULL;
+}
+
+const FunctionCell* FunctionManager::get_function(const SymbolCell* fname) {
+  int index = find_builtin(fname);
 
-  if (!is_function(fname)) {
-    throw runtime_error( fname + " is undefined" );
+  if (index != -1) {
+    if (builtins_m[index].function_m == NULL) {
+      return NULL;
+    }
+    return (const FunctionCell*) get_builtin_cell(index);
   }
 
-  /// resolve function pointer to a callable function
-  Cell* (*func)(const FunctionCell*, Cell*);
-  func = func_defs_m[fname];
+  map<const SymbolCell*, const FunctionCell*>::iterator it = func_defs_m.find(fname);
+  if (it == func_defs_m.end()) {
+    return NULL;
+  }
+  return it->second;
+}
 
-  return func(func_cell, args);
+const ArithmeticCell* FunctionManager::get_arithmetic(const SymbolCell* fname) {
+  if (!is_arithmetic(fname)) {
+    return NULL;
+  }
+  return (const ArithmeticCell*) get_builtin_cell(find_builtin(fname));
+}
+
+const SymbolCell* FunctionManager::get_builtin(const SymbolCell* fname) {
+  int index = find_builtin(fname);
+
+  if (index != -1) {
+    return get_builtin_cell(index);
+  }
+  return get_function(fname);
 }
@@ -17,10 +17,10 @@ using namespace std;
  * \class FunctionManager
  * \brief FunctionManager implements a singleton pattern. Therefore the constructor
  *        is private and the instance shall be called via FunctionMangager::Instance().
- *        In the constructor the by default available functions are added. This 
- *        approach enables the FunctionManager to initialize itself only ones (and also
- *        the default functions), without the need to hook into the entrypoint of the
- *        programm.
+ *        The by default available functions are listed in a static table. The
+ *        constructor indexes it by the hash of the interned name, so adding a builtin is adding
+ *        a line to the table. The shared FunctionCell of a builtin is created the
+ *        first time it is looked up. Further functions can be added at runtime with add_function().
  */
 class FunctionManager {
 public:
@@ -34,27 +34,68 @@ public:
   /**
    * \typedef func typedef for our function pointers
    */
-  typedef Cell*(*func)(const FunctionCell*, Cell*);
+  typedef FunctionCell::func func;
   
   /**
-   * \brief Adds function to the function pointer map
+   * \brief Adds function to the function pointer map, e.g. for extensions
+   *        which are not part of the static table. The function is resolved
+   *        once to a shared FunctionCell, which carries the function pointer
+   *        and the arity. It is pinned, so it is never collected
+   * \param min_args least number of arguments
+   * \param max_args greatest number of arguments, -1 if unlimited
    * \throw logic_error if function already defined
    */
-  void add_function(string key, func function) throw (logic_error);
+  void add_function(string key, func function, int min_args, int max_args) throw (logic_error);
 
   /**
    * \brief Checks if symbol is mapped with function pointer
    */
-  bool is_function(string key);
-  
+  bool is_function(const SymbolCell* key);
+
+  /**
+   * \brief Checks if symbol is an arithmetic operator
+   */
+  bool is_arithmetic(const SymbolCell* key);
+
+  /**
+   * \return the shared FunctionCell of key, NULL if there is none
+   */
+  const FunctionCell* get_function(const SymbolCell* key);
+
+  /**
+   * \return the shared ArithmeticCell of key, NULL if there is none
+   */
+  const ArithmeticCell* get_arithmetic(const SymbolCell* key);
+
   /**
-   * \brief calls function given the key
+   * \return the shared FunctionCell or ArithmeticCell of key, NULL if key
+   *         is not a builtin
    */
-  Cell* call_function(const FunctionCell* func_cell, Cell* args) throw (runtime_error);
+  const SymbolCell* get_builtin(const SymbolCell* key);
 
 private:
+  /**
+   * \struct Builtin
+   *
+   * \brief Entry of the static table of builtins
+   */
+  struct Builtin {
+    const char* name_m;
+    func        function_m;   ///< NULL for arithmetic operators
+    int         min_args_m;
+    int         max_args_m;   ///< -1 if unlimited
+  };
+
   static FunctionManager* instance;
-  static std::map<string, func> func_defs_m;
+
+  static const Builtin builtins_m[];
+  static signed char builtin_index_m[];        ///< slot -> builtins_m, -1 if empty
+  static const SymbolCell* builtin_symbols_m[];  ///< slot -> interned name
+  static const SymbolCell* builtin_cells_m[];  ///< created on first lookup
+
+  /// functions added at runtime. Keys are interned symbols, compared by
+  /// pointer
+  static std::map<const SymbolCell*, const FunctionCell*> func_defs_m;
 
   /// Singleton Pattern
   /**
@@ -72,6 +113,18 @@ private:
    */
   void operator=(FunctionManager const&);
 
+  /**
+   * \return index of key in the static table, -1 if it is not listed.
+   *         Probes the slots from the hash of key on up to an empty one
+   */
+  static int find_builtin(const SymbolCell* key);
+
+  /**
+   * \brief Shared cell of the builtin at index of the static table.
+   *        Creates and pins it on first use
+   */
+  const SymbolCell* get_builtin_cell(int index);
+
 };
 
 #endif
@@ -0,0 +1,218 @@
+/**
+ * \file GarbageCollector.cpp
+ *
+ * Implementation of the mark-and-sweep collector
+ */
+
+#include "GarbageCollector.hpp"
+#include "DefinitionManager.hpp"
+#include "VirtualMachine.hpp"
+#include "cons.hpp"
+
+#include <algorithm>
+#include <csetjmp>
+#include <ctime>
+
+/// the stack scan reads words of foreign frames on purpose
+#if defined(__GNUC__)
+#define NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#else
+#define NO_SANITIZE_ADDRESS
+#endif
+
+/// define static members
+GarbageCollector* GarbageCollector::instance = NULL;
+
+GarbageCollector::GarbageCollector()
+  : next_collection_m(1 << 20), external_bytes_m(0), min_threshold_m(1 << 20),
+    growth_factor_m(2.0), stack_bottom_m(NULL), collecting_m(false),
+    collections_m(0), freed_cells_m(0), total_pause_m(0), max_pause_m(0) {}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Allocation
+
+void GarbageCollector::release(void* p) {
+  heap_m.release(p);
+}
+
+void GarbageCollector::note_external(long bytes) {
+  external_bytes_m += bytes;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Roots
+
+void GarbageCollector::set_stack_bottom(void* bottom) {
+  stack_bottom_m = (char*) bottom;
+}
+
+void GarbageCollector::pin(Cell* c) {
+  ++pinned_m[c];
+}
+
+void GarbageCollector::unpin(Cell* c) {
+  map<Cell*, int>::iterator it = pinned_m.find(c);
+
+  if (it == pinned_m.end()) {
+    return;
+  }
+  if (--(it->second) == 0) {
+    pinned_m.erase(it);
+  }
+}
+
+bool GarbageCollector::visit(Cell* c) {
+  return heap_m.mark(c);
+}
+
+void GarbageCollector::clear_visits() {
+  heap_m.clear_marks();
+}
+
+NO_SANITIZE_ADDRESS
+void GarbageCollector::scan_conservative(char* begin, char* end,
+					 vector<Cell*>& worklist) {
+  /// only aligned words can hold a pointer
+  size_t misalign = ((size_t) begin) % sizeof(void*);
+  if (misalign != 0) {
+    begin += sizeof(void*) - misalign;
+  }
+
+  for (char* pos = begin; pos + sizeof(void*) <= end; pos += sizeof(void*)) {
+    /// interior pointers keep a cell alive as well
+    void* cell = heap_m.find(*(void**) pos);
+
+    if (cell != NULL) {
+      worklist.push_back((Cell*) cell);
+    }
+  }
+}
+
+void GarbageCollector::scan_stack(vector<Cell*>& worklist) {
+  /// setjmp spills callee-saved registers into a buffer on the stack
+  jmp_buf registers;
+  setjmp(registers);
+
+  char* top = (char*) &registers;
+  char* bottom = stack_bottom_m;
+
+  /// works for stacks growing in both directions
+  if (top > bottom) {
+    swap(top, bottom);
+  }
+
+  scan_conservative(top, bottom, worklist);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Mark and Sweep
+
+void GarbageCollector::mark(vector<Cell*>& worklist) {
+  while (!worklist.empty()) {
+    Cell* c = worklist.back();
+    worklist.pop_back();
+
+    /// ints and nil are encoded in the pointer, there is nothing to mark
+    if (c == NULL || is_immediate(c) || !heap_m.mark(c)) {
+      continue;
+    }
+
+    c->trace(worklist);
+  }
+}
+
+void GarbageCollector::finalize(void* p) {
+  /// only the destructor, the memory is reused by the allocator
+  ((Cell*) p)->~Cell();
+}
+
+void GarbageCollector::collect() {
+  /// without knowing the C++ stack, live cells cannot be found
+  if (collecting_m || stack_bottom_m == NULL) {
+    return;
+  }
+  collecting_m = true;
+
+  clock_t start = clock();
+
+  vector<Cell*> worklist;
+
+  for (map<Cell*, int>::iterator it = pinned_m.begin(); it != pinned_m.end(); ++it) {
+    worklist.push_back(it->first);
+  }
+
+  DefinitionManager::Instance()->get_roots(worklist);
+  VirtualMachine::Instance()->get_roots(worklist);
+  scan_stack(worklist);
+
+  mark(worklist);
+  /// the heap grows to about the size which triggered this collection
+  /// again, empty blocks up to that size are kept for it. Memory outside
+  /// of the heap is not made of blocks
+  size_t keep = next_collection_m - min(next_collection_m, external_bytes_m);
+  freed_cells_m += heap_m.sweep(&finalize, keep);
+
+  next_collection_m = max(min_threshold_m,
+			  (size_t) ((heap_m.get_used_bytes() + external_bytes_m) * growth_factor_m));
+
+  double pause = 1000.0 * (clock() - start) / CLOCKS_PER_SEC;
+  total_pause_m += pause;
+  max_pause_m = max(max_pause_m, pause);
+  ++collections_m;
+
+  collecting_m = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Tuning and Statistics
+
+void GarbageCollector::set_growth_factor(double factor) throw (runtime_error) {
+  if (factor <= 1) {
+    throw runtime_error("Growth factor of the heap has to be greater than 1");
+  }
+  growth_factor_m = factor;
+  next_collection_m = max(min_threshold_m,
+			  (size_t) ((heap_m.get_used_bytes() + external_bytes_m) * factor));
+}
+
+void GarbageCollector::set_min_threshold(size_t bytes) {
+  min_threshold_m = bytes;
+  next_collection_m = max(min_threshold_m,
+			  (size_t) ((heap_m.get_used_bytes() + external_bytes_m) * growth_factor_m));
+}
+
+size_t GarbageCollector::get_collections() const {
+  return collections_m;
+}
+
+double GarbageCollector::get_total_pause() const {
+  return total_pause_m;
+}
+
+double GarbageCollector::get_max_pause() const {
+  return max_pause_m;
+}
+
+size_t GarbageCollector::get_heap_bytes() const {
+  return heap_m.get_used_bytes();
+}
+
+size_t GarbageCollector::get_external_bytes() const {
+  return external_bytes_m;
+}
+
+size_t GarbageCollector::get_heap_cells() const {
+  return heap_m.get_used_slots();
+}
+
+void GarbageCollector::print_stats(ostream& os) const {
+  os << "collections: " << collections_m << endl;
+  os << "heap cells:  " << heap_m.get_used_slots() << endl;
+  os << "heap bytes:  " << heap_m.get_used_bytes() << endl;
+  os << "reserved:    " << heap_m.get_reserved_bytes() << endl;
+  os << "external:    " << external_bytes_m << endl;
+  os << "freed cells: " << freed_cells_m << endl;
+  os << "total pause: " << total_pause_m << " ms" << endl;
+  os << "max pause:   " << max_pause_m << " ms" << endl;
+}
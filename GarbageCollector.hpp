@@ -0,0 +1,213 @@
+/**
+ * \file GarbageCollector.hpp
+ *
+ * \brief Tracing mark-and-sweep collector for the Cell heap
+ */
+
+#ifndef GARBAGECOLLECTOR_HPP
+#define GARBAGECOLLECTOR_HPP
+
+#include <cstddef>
+#include <map>
+#include <vector>
+#include <iostream>
+#include "Cell.hpp"
+#include "SlabAllocator.hpp"
+
+using namespace std;
+
+/**
+ * \class GarbageCollector
+ *
+ * \brief Singleton which owns every Cell allocated with new. CellABC
+ *        overloads operator new and operator delete, so no other code
+ *        has to know about the collector. The memory itself is carved
+ *        out of the blocks of a SlabAllocator.
+ *
+ * Roots are found in four places:
+ *   1. the DefinitionManager frame stack (precise)
+ *   2. the value stack and the code of the VirtualMachine (precise)
+ *   3. cells pinned with pin(), e.g. the parse tree of the expression
+ *      which is currently evaluated (precise)
+ *   4. the C++ stack and the registers of eval() and the builtins
+ *      (conservative: every word which points into a cell keeps it
+ *      alive)
+ *
+ * Collections are triggered by allocation as soon as the heap has
+ * grown by the growth factor since the last collection. Memory which
+ * cells hold outside of the heap (the elements of a vector, ...) is
+ * reported with note_external() and counts as part of the heap. The stack
+ * can only be scanned after main() has told the collector where it
+ * starts, therefore nothing is collected before set_stack_bottom()
+ * has been called.
+ */
+class GarbageCollector {
+public:
+
+  /**
+   * \brief Should be used to get the instance of this class. Will
+   *        instantiate itself if is is not done yet. --> Singleton
+   *        pattern
+   */
+  static GarbageCollector* Instance();
+
+  /**
+   * \brief Allocates zeroed memory for a cell. May trigger a collection
+   *        before allocating. Inline, it is called for every cell
+   */
+  void* allocate(size_t size);
+
+  /**
+   * \brief Frees memory of a cell. Only used if the constructor of a
+   *        cell has thrown, swept cells are freed by the allocator
+   */
+  void release(void* p);
+
+  /**
+   * \brief Runs a full collection right now
+   */
+  void collect();
+
+  /**
+   * \brief Counts memory a cell has allocated outside of the heap
+   *        towards the next collection: bytes is positive when the cell
+   *        allocates, negative when it frees (at the latest in its
+   *        destructor, which the sweep runs). Never collects itself,
+   *        the next allocate() does
+   */
+  void note_external(long bytes);
+
+  /**
+   * \brief Tells the collector where the C++ stack starts. Should be
+   *        the address of a local variable in main()
+   */
+  void set_stack_bottom(void* bottom);
+
+  /**
+   * \brief Keeps c (and everything reachable from it) alive until
+   *        unpin() is called. Calls can be nested.
+   */
+  void pin(Cell* c);
+
+  /**
+   * \brief Removes one pin from c
+   */
+  void unpin(Cell* c);
+
+  /**
+   * \brief Uses the mark bits outside of a collection, for traversals
+   *        which have to know whether they have reached a cell before
+   *        (see fasl.cpp). Nothing must be allocated until
+   *        clear_visits() has been called.
+   * \return true if c has not been visited before
+   */
+  bool visit(Cell* c);
+
+  /**
+   * \brief Forgets all visits
+   */
+  void clear_visits();
+
+  /**
+   * \brief The heap may grow to (live bytes * factor) before the next
+   *        collection is triggered. Must be greater than 1.
+   */
+  void set_growth_factor(double factor) throw (runtime_error);
+
+  /**
+   * \brief No collection is triggered before the heap reached this
+   *        size in bytes
+   */
+  void set_min_threshold(size_t bytes);
+
+  /// Statistics
+  size_t get_collections() const;
+  double get_total_pause() const;     ///< in milliseconds
+  double get_max_pause() const;       ///< in milliseconds
+  size_t get_heap_bytes() const;
+  size_t get_external_bytes() const;
+  size_t get_heap_cells() const;
+
+  /**
+   * \brief Prints all statistics in a human readable form
+   */
+  void print_stats(ostream& os = cout) const;
+
+private:
+  static GarbageCollector* instance;
+
+  SlabAllocator heap_m;
+  size_t  next_collection_m;           ///< heap size triggering next gc
+  size_t  external_bytes_m;            ///< see note_external()
+  size_t  min_threshold_m;
+  double  growth_factor_m;
+  char*   stack_bottom_m;
+  bool    collecting_m;
+
+  map<Cell*, int> pinned_m;            ///< pinned cells with pin count
+
+  /// statistics
+  size_t  collections_m;
+  size_t  freed_cells_m;
+  double  total_pause_m;
+  double  max_pause_m;
+
+  /**
+   * \brief Constructor is private --> Singleton Pattern
+   */
+  GarbageCollector();
+
+  /**
+   * \brief Makes sure there is no copy constructor
+   */
+  GarbageCollector(GarbageCollector const&);
+
+  /**
+   * \brief Makes sure no assignments are possible
+   */
+  void operator=(GarbageCollector const&);
+
+  /**
+   * \brief Marks everything reachable from the cells in worklist.
+   *        Uses the worklist instead of recursion, so long lists do
+   *        not overflow the C++ stack.
+   */
+  void mark(vector<Cell*>& worklist);
+
+  /**
+   * \brief Pushes every cell which is referenced by a word between
+   *        begin and end onto the worklist
+   */
+  void scan_conservative(char* begin, char* end, vector<Cell*>& worklist);
+
+  /**
+   * \brief Spills the registers and scans the C++ stack
+   */
+  void scan_stack(vector<Cell*>& worklist);
+
+  /**
+   * \brief Runs the destructor of a dead cell, used as finalizer by
+   *        the sweep phase of the SlabAllocator
+   */
+  static void finalize(void* p);
+};
+
+/// Singleton Pattern, inline since every allocation asks for it
+inline GarbageCollector* GarbageCollector::Instance() {
+  if (instance == NULL) {
+    instance = new GarbageCollector();
+  }
+  return instance;
+}
+
+inline void* GarbageCollector::allocate(size_t size) {
+  if (heap_m.get_used_bytes() + external_bytes_m + size >= next_collection_m) {
+    collect();
+  }
+
+  /// zeroed, so that a cell which is found on the stack while its
+  /// constructor is still running does only contain NULL pointers
+  return heap_m.allocate(size);
+}
+
+#endif
@@ -0,0 +1,125 @@
+/**
+ * \file OutputManager.cpp
+ *
+ * Implementation of the buffered standard output
+ */
+
+#include "OutputManager.hpp"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+/// define static members
+OutputManager* OutputManager::instance = NULL;
+const size_t OutputManager::BUFFER_SIZE;
+
+/**
+ * \brief Registered with atexit(): exit() writes what is still buffered,
+ *        even on paths which leave main() without returning
+ */
+static void flush_at_exit() {
+  OutputManager::Instance()->flush();
+}
+
+OutputManager::OutputManager()
+  : buffer_m(BUFFER_SIZE), used_m(0), line_buffered_m(isatty(STDOUT_FILENO) != 0),
+    writes_m(0), written_bytes_m(0) {
+  /// the output of cout is not synchronized with printf() anymore, there
+  /// is no printf() in the interpreter
+  cout.rdbuf(this);
+  /// errors and prompts must not overtake the output written before
+  cerr.tie(&cout);
+  cin.tie(&cout);
+  atexit(&flush_at_exit);
+}
+
+/// Singleton Pattern
+OutputManager* OutputManager::Instance() {
+  if (instance == NULL) {
+    instance = new OutputManager();
+  }
+  return instance;
+}
+
+void OutputManager::flush() {
+  if (used_m > 0) {
+    write_out(&buffer_m[0], used_m);
+    used_m = 0;
+  }
+}
+
+bool OutputManager::is_line_buffered() const {
+  return line_buffered_m;
+}
+
+int OutputManager::overflow(int c) {
+  if (traits_type::eq_int_type(c, traits_type::eof())) {
+    return traits_type::not_eof(c);
+  }
+  if (used_m == buffer_m.size()) {
+    flush();
+  }
+  buffer_m[used_m++] = (char) c;
+  if (line_buffered_m && c == '\n') {
+    flush();
+  }
+  return c;
+}
+
+streamsize OutputManager::xsputn(const char* s, streamsize n) {
+  size_t size = (size_t) n;
+  if (used_m + size > buffer_m.size()) {
+    flush();
+  }
+  if (size >= buffer_m.size()) {
+    // too big to be buffered
+    write_out(s, size);
+    return n;
+  }
+  memcpy(&buffer_m[used_m], s, size);
+  used_m += size;
+  if (line_buffered_m && memchr(s, '\n', size) != NULL) {
+    flush();
+  }
+  return n;
+}
+
+int OutputManager::sync() {
+  flush();
+  return 0;
+}
+
+bool OutputManager::write_out(const char* s, size_t n) {
+  while (n > 0) {
+    ssize_t written = write(STDOUT_FILENO, s, n);
+    ++writes_m;
+    if (written < 0) {
+      if (errno == EINTR) {
+	continue;
+      }
+      return false;
+    }
+    s += written;
+    n -= written;
+    written_bytes_m += written;
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Statistics
+
+size_t OutputManager::get_writes() const {
+  return writes_m;
+}
+
+size_t OutputManager::get_written_bytes() const {
+  return written_bytes_m;
+}
+
+void OutputManager::print_stats(ostream& os) const {
+  os << "writes:      " << writes_m << endl;
+  os << "written:     " << written_bytes_m << " bytes" << endl;
+}
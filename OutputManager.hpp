@@ -0,0 +1,115 @@
+/**
+ * \file OutputManager.hpp
+ *
+ * \brief Buffers everything written to cout in user space
+ */
+
+#ifndef OUTPUTMANAGER_HPP
+#define OUTPUTMANAGER_HPP
+
+#include <cstddef>
+#include <iostream>
+#include <streambuf>
+#include <vector>
+
+using namespace std;
+
+/**
+ * \class OutputManager
+ *
+ * \brief Singleton streambuf which replaces the streambuf of cout as soon
+ *        as it is instantiated. Output is collected in a big buffer and
+ *        written to the standard output with as few write() calls as
+ *        possible: when the buffer is full, when flush() is called (by
+ *        (flush) and (flush-output)), before cin is read or anything is
+ *        written to cerr (both are tied to cout) and by exit(), which
+ *        calls an atexit() handler.
+ *
+ * If the standard output is a terminal, every complete line is written
+ * at once, so interactive output does not lag behind. Otherwise a crash
+ * (a signal, abort()) loses up to 64 KB of output which has not been
+ * written yet, the price of writing it with few system calls.
+ */
+class OutputManager : public streambuf {
+public:
+
+  /**
+   * \brief Should be used to get the instance of this class. Will
+   *        instantiate itself if is is not done yet. --> Singleton
+   *        pattern
+   */
+  static OutputManager* Instance();
+
+  /**
+   * \brief Writes the buffered output
+   */
+  void flush();
+
+  /**
+   * \return true if every line is written as soon as it is complete
+   */
+  bool is_line_buffered() const;
+
+  /// Statistics
+  size_t get_writes() const;          ///< number of write() system calls
+  size_t get_written_bytes() const;
+
+  /**
+   * \brief Prints all statistics in a human readable form
+   */
+  void print_stats(ostream& os = cout) const;
+
+protected:
+  /**
+   * \brief Called by the stream for every single character, the
+   *        buffer is not exposed to the stream
+   */
+  virtual int overflow(int c);
+
+  /**
+   * \brief Called by the stream for strings and formatted numbers
+   */
+  virtual streamsize xsputn(const char* s, streamsize n);
+
+  /**
+   * \brief Called by the stream to flush
+   */
+  virtual int sync();
+
+private:
+  static OutputManager* instance;
+
+  static const size_t BUFFER_SIZE = 1 << 16;
+
+  vector<char> buffer_m;
+  size_t       used_m;              ///< bytes in buffer_m not written yet
+  bool         line_buffered_m;
+
+  /// statistics
+  size_t       writes_m;
+  size_t       written_bytes_m;
+
+  /**
+   * \brief Writes s to the standard output, the buffer has to be
+   *        written before
+   * \return false if the output could not be written
+   */
+  bool write_out(const char* s, size_t n);
+
+  /**
+   * \brief Constructor is private --> Singleton Pattern
+   */
+  OutputManager();
+
+  /**
+   * \brief Makes sure there is no copy constructor
+   */
+  OutputManager(OutputManager const&);
+
+  /**
+   * \brief Makes sure no assignments are possible
+   */
+  void operator=(OutputManager const&);
+};
+
+#endif // OUTPUTMANAGER_HPP
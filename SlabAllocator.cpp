@@ -0,0 +1,309 @@
+/**
+ * \file SlabAllocator.cpp
+ *
+ * Implementation of the size-segregated slab allocator
+ */
+
+#include "SlabAllocator.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+/// define static members
+const size_t SlabAllocator::BLOCK_BYTES;
+const size_t SlabAllocator::GRANULE;
+const size_t SlabAllocator::MAX_SMALL;
+const size_t SlabAllocator::NO_CLASSES;
+const size_t SlabAllocator::BITS;
+const char SlabAllocator::FREE_TAG = 0;
+
+SlabAllocator::SlabAllocator()
+  : used_bytes_m(0), used_slots_m(0), reserved_bytes_m(0) {
+  for (size_t i = 0; i < NO_CLASSES; ++i) {
+    free_m[i] = NULL;
+  }
+}
+
+SlabAllocator::~SlabAllocator() {
+  for (size_t i = 0; i < blocks_m.size(); ++i) {
+    free(blocks_m[i]);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Bitmaps
+
+bool SlabAllocator::test_bit(const unsigned long* bitmap, size_t i) {
+  return (bitmap[i / BITS] >> (i % BITS)) & 1UL;
+}
+
+void SlabAllocator::set_bit(unsigned long* bitmap, size_t i) {
+  bitmap[i / BITS] |= 1UL << (i % BITS);
+}
+
+void SlabAllocator::clear_bit(unsigned long* bitmap, size_t i) {
+  bitmap[i / BITS] &= ~(1UL << (i % BITS));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Blocks
+
+/**
+ * \brief Bytes needed for a block header, the mark bitmap and the slots
+ */
+static size_t block_bytes(size_t header, size_t bits, size_t slot_size,
+			  size_t capacity) {
+  size_t words = (capacity + bits - 1) / bits;
+  size_t meta = header + words * sizeof(unsigned long);
+  meta = (meta + 15) & ~((size_t) 15);       /// slots are 16 byte aligned
+
+  return meta + capacity * slot_size;
+}
+
+SlabAllocator::Block* SlabAllocator::new_block(size_t size_class,
+					       size_t slot_size,
+					       size_t capacity) {
+  /// shrink capacity until header, bitmaps and slots fit into the block
+  while (capacity > 1
+	 && block_bytes(sizeof(Block), BITS, slot_size, capacity) > BLOCK_BYTES) {
+    --capacity;
+  }
+
+  size_t bytes = block_bytes(sizeof(Block), BITS, slot_size, capacity);
+  size_t words = (capacity + BITS - 1) / BITS;
+
+  void* memory = NULL;
+  if (posix_memalign(&memory, BLOCK_BYTES, max(bytes, BLOCK_BYTES)) != 0) {
+    throw bad_alloc();
+  }
+
+  Block* b = (Block*) memory;
+  b->marked_m    = (unsigned long*) (b + 1);
+  b->start_m     = (char*) b + (bytes - capacity * slot_size);
+  b->slot_size_m = slot_size;
+  b->capacity_m  = capacity;
+  b->class_m     = size_class;
+  memset(b->marked_m, 0, words * sizeof(unsigned long));
+
+  /// keep blocks sorted by address for search_block()
+  blocks_m.insert(upper_bound(blocks_m.begin(), blocks_m.end(), b), b);
+  reserved_bytes_m += max(bytes, BLOCK_BYTES);
+
+  return b;
+}
+
+void SlabAllocator::delete_block(Block* b) {
+  vector<Block*>::iterator it = lower_bound(blocks_m.begin(), blocks_m.end(), b);
+  if (it != blocks_m.end() && *it == b) {
+    blocks_m.erase(it);
+  }
+
+  size_t bytes = block_bytes(sizeof(Block), BITS, b->slot_size_m, b->capacity_m);
+  reserved_bytes_m -= max(bytes, BLOCK_BYTES);
+
+  free(b);
+}
+
+SlabAllocator::Block* SlabAllocator::block_of(const void* p) {
+  return (Block*) (((size_t) p) & ~(BLOCK_BYTES - 1));
+}
+
+SlabAllocator::Block* SlabAllocator::search_block(const void* p) const {
+  vector<Block*>::const_iterator it =
+    upper_bound(blocks_m.begin(), blocks_m.end(), (Block*) p);
+
+  if (it == blocks_m.begin()) {
+    return NULL;
+  }
+  --it;
+
+  Block* b = *it;
+  const char* end = b->start_m + b->capacity_m * b->slot_size_m;
+  if ((const char*) p < b->start_m || (const char*) p >= end) {
+    return NULL;
+  }
+
+  return b;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Allocation
+
+bool SlabAllocator::is_free(const void* slot) {
+  return *(const void* const*) slot == &FREE_TAG;
+}
+
+void SlabAllocator::push_free(Block* b, char* slot) {
+  FreeSlot* f = (FreeSlot*) slot;
+  f->tag_m = &FREE_TAG;
+  f->next_m = free_m[b->class_m];
+  free_m[b->class_m] = f;
+}
+
+void* SlabAllocator::allocate_slow(size_t size) {
+  size_t size_class = size_class_of(size);
+
+  /// big objects get a block on their own
+  if (size > MAX_SMALL) {
+    Block* b = new_block(0, size_class * GRANULE, 1);
+    memset(b->start_m, 0, b->slot_size_m);
+
+    used_bytes_m += b->slot_size_m;
+    ++used_slots_m;
+    return b->start_m;
+  }
+
+  /// all slots of a new block become free, pushed backwards to keep
+  /// the free list in ascending address order
+  Block* b = new_block(size_class, size_class * GRANULE, BLOCK_BYTES / (size_class * GRANULE));
+  for (size_t i = b->capacity_m; i-- > 0; ) {
+    push_free(b, b->start_m + i * b->slot_size_m);
+  }
+
+  return allocate(size);
+}
+
+void SlabAllocator::release(void* p) {
+  if (p == NULL) {
+    return;
+  }
+
+  Block* b = block_of(p);
+  size_t index = ((char*) p - b->start_m) / b->slot_size_m;
+
+  clear_bit(b->marked_m, index);
+
+  used_bytes_m -= b->slot_size_m;
+  --used_slots_m;
+
+  if (b->class_m == 0) {
+    delete_block(b);
+    return;
+  }
+
+  push_free(b, (char*) p);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Garbage Collection Support
+
+void* SlabAllocator::find(const void* p) const {
+  Block* b = search_block(p);
+
+  if (b == NULL) {
+    return NULL;
+  }
+
+  size_t index = ((const char*) p - b->start_m) / b->slot_size_m;
+  char* slot = b->start_m + index * b->slot_size_m;
+  if (is_free(slot)) {
+    return NULL;
+  }
+
+  return slot;
+}
+
+bool SlabAllocator::mark(const void* p) {
+  Block* b = block_of(p);
+  size_t index = ((const char*) p - b->start_m) / b->slot_size_m;
+
+  if (test_bit(b->marked_m, index)) {
+    return false;
+  }
+
+  set_bit(b->marked_m, index);
+  return true;
+}
+
+size_t SlabAllocator::sweep(finalizer finalize, size_t keep_bytes) {
+  size_t freed = 0;
+
+  /// first all dead slots are freed, counting the live ones per block
+  vector<Block*> blocks(blocks_m);
+  vector<size_t> used(blocks.size(), 0);
+  size_t used_blocks_bytes = 0;
+
+  for (size_t j = 0; j < blocks.size(); ++j) {
+    Block* b = blocks[j];
+
+    for (size_t i = 0; i < b->capacity_m; ++i) {
+      char* slot = b->start_m + i * b->slot_size_m;
+      if (is_free(slot)) {
+	continue;
+      }
+      if (test_bit(b->marked_m, i)) {
+	clear_bit(b->marked_m, i);
+	++used[j];
+	continue;
+      }
+
+      finalize(slot);
+
+      *(const void**) slot = &FREE_TAG;
+      used_bytes_m -= b->slot_size_m;
+      --used_slots_m;
+      ++freed;
+    }
+
+    if (used[j] != 0) {
+      size_t bytes = block_bytes(sizeof(Block), BITS, b->slot_size_m, b->capacity_m);
+      used_blocks_bytes += max(bytes, BLOCK_BYTES);
+    }
+  }
+
+  /// then the free lists are rebuilt. Blocks are walked backwards, so
+  /// that pushing to the front of the free lists leaves them in
+  /// ascending address order
+  for (size_t i = 0; i < NO_CLASSES; ++i) {
+    free_m[i] = NULL;
+  }
+
+  size_t kept_bytes = used_blocks_bytes;
+  for (size_t j = blocks.size(); j-- > 0; ) {
+    Block* b = blocks[j];
+
+    /// empty blocks are kept while the heap would be filled again before
+    /// the next collection, so they need not be allocated again
+    if (used[j] == 0) {
+      if (b->class_m == 0 || kept_bytes + BLOCK_BYTES > keep_bytes) {
+	delete_block(b);
+	continue;
+      }
+      kept_bytes += BLOCK_BYTES;
+    }
+
+    if (b->class_m == 0) {
+      continue;
+    }
+
+    for (size_t i = b->capacity_m; i-- > 0; ) {
+      char* slot = b->start_m + i * b->slot_size_m;
+      if (is_free(slot)) {
+	push_free(b, slot);
+      }
+    }
+  }
+
+  return freed;
+}
+
+void SlabAllocator::clear_marks() {
+  for (size_t i = 0; i < blocks_m.size(); ++i) {
+    Block* b = blocks_m[i];
+    size_t words = (b->capacity_m + BITS - 1) / BITS;
+    memset(b->marked_m, 0, words * sizeof(unsigned long));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Statistics
+
+size_t SlabAllocator::get_used_slots() const {
+  return used_slots_m;
+}
+
+size_t SlabAllocator::get_reserved_bytes() const {
+  return reserved_bytes_m;
+}
@@ -0,0 +1,224 @@
+/**
+ * \file SlabAllocator.hpp
+ *
+ * \brief Size-segregated free list allocator for the Cell heap
+ */
+
+#ifndef SLABALLOCATOR_HPP
+#define SLABALLOCATOR_HPP
+
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+/**
+ * \class SlabAllocator
+ *
+ * \brief Carves cells out of large contiguous blocks instead of
+ *        calling malloc for every single cell.
+ *
+ * Every request is rounded up to a size class (multiples of 8 bytes).
+ * Each size class owns a list of blocks and a free list. When a new
+ * block is created, all of its slots are put onto the free list in
+ * address order, so allocating is popping the head of the free list.
+ * Cells which are allocated one after another (e.g. the cons cells of
+ * a list) are therefore neighbours in memory. The sweep phase rebuilds
+ * the free lists in address order, so reused slots are neighbours as
+ * well.
+ *
+ * A free slot starts with a tag which no cell can start with (cells
+ * start with their vtable), so allocating and freeing do not touch any
+ * bitmap. Every block keeps one bitmap of the slots which have been
+ * marked by the GarbageCollector. The allocator does not know anything
+ * about cells, it only hands out memory.
+ */
+class SlabAllocator {
+public:
+  /**
+   * \typedef finalizer
+   * \brief Called by sweep() for every dead slot before it is freed
+   */
+  typedef void (*finalizer)(void*);
+
+  SlabAllocator();
+
+  /**
+   * \brief frees all blocks (without running any finalizer)
+   */
+  ~SlabAllocator();
+
+  /**
+   * \brief Returns zeroed memory of at least size bytes. Pops the free
+   *        list of the size class, see allocate_slow() for the rest
+   */
+  void* allocate(size_t size);
+
+  /**
+   * \brief Puts slot p back onto the free list of its size class
+   */
+  void release(void* p);
+
+  /**
+   * \brief Resolves a (possibly interior) pointer to the start of the
+   *        allocated slot containing it
+   * \return NULL if p does not point into an allocated slot
+   */
+  void* find(const void* p) const;
+
+  /**
+   * \brief Sets the mark bit of the slot starting at p
+   * \return true if the slot has not been marked before
+   */
+  bool mark(const void* p);
+
+  /**
+   * \brief Calls finalize for every allocated but unmarked slot and
+   *        frees it. Clears all mark bits. Blocks which become empty
+   *        are given back to the system, unless they fit into
+   *        keep_bytes together with the blocks still in use.
+   * \return number of freed slots
+   */
+  size_t sweep(finalizer finalize, size_t keep_bytes);
+
+  /**
+   * \brief Clears all mark bits without freeing anything
+   */
+  void clear_marks();
+
+  /**
+   * \return bytes in allocated slots
+   */
+  size_t get_used_bytes() const;
+
+  /**
+   * \return number of allocated slots
+   */
+  size_t get_used_slots() const;
+
+  /**
+   * \return bytes reserved in blocks
+   */
+  size_t get_reserved_bytes() const;
+
+private:
+  /// size of a block of slots, objects bigger than this get their own block
+  static const size_t BLOCK_BYTES = 64 * 1024;
+
+  /// granularity of the size classes
+  static const size_t GRANULE = 8;
+
+  /// slots up to this size are size-segregated
+  static const size_t MAX_SMALL = 256;
+
+  static const size_t NO_CLASSES = MAX_SMALL / GRANULE + 1;
+
+  static const size_t BITS = sizeof(unsigned long) * 8;
+
+  /**
+   * \struct Block
+   *
+   * \brief Contiguous memory for slots of the same size. The Block
+   *        itself is placed at the beginning of its memory, which is
+   *        aligned to BLOCK_BYTES. Therefore the block of a slot can be
+   *        found by masking the address.
+   */
+  struct Block {
+    char*          start_m;        ///< first slot
+    size_t         slot_size_m;
+    size_t         capacity_m;     ///< number of slots
+    size_t         class_m;        ///< index of size class, 0 for big ones
+    unsigned long* marked_m;       ///< bitmap
+  };
+
+  /**
+   * \struct FreeSlot
+   *
+   * \brief Is written into freed slots to tag and link them
+   */
+  struct FreeSlot {
+    const void* tag_m;             ///< FREE_TAG
+    FreeSlot*   next_m;
+  };
+
+  /// first word of every free slot
+  static const char FREE_TAG;
+
+  vector<Block*> blocks_m;                ///< sorted by address
+  FreeSlot*      free_m[NO_CLASSES];      ///< free lists
+
+  size_t used_bytes_m;
+  size_t used_slots_m;
+  size_t reserved_bytes_m;
+
+  /**
+   * \brief Makes sure there is no copy constructor
+   */
+  SlabAllocator(SlabAllocator const&);
+
+  /**
+   * \brief Makes sure no assignments are possible
+   */
+  void operator=(SlabAllocator const&);
+
+  /**
+   * \brief Allocates big objects and refills empty free lists
+   */
+  void* allocate_slow(size_t size);
+
+  Block* new_block(size_t size_class, size_t slot_size, size_t capacity);
+  void delete_block(Block* b);
+
+  /**
+   * \brief Finds the block which contains an arbitrary address p
+   * \return NULL if p is not inside of any block
+   */
+  Block* search_block(const void* p) const;
+
+  /**
+   * \brief Finds the block of a slot, p has to be the start of a slot
+   */
+  static Block* block_of(const void* p);
+
+  static size_t size_class_of(size_t size);
+  static bool is_free(const void* slot);
+  void push_free(Block* b, char* slot);
+
+  static bool test_bit(const unsigned long* bitmap, size_t i);
+  static void set_bit(unsigned long* bitmap, size_t i);
+  static void clear_bit(unsigned long* bitmap, size_t i);
+};
+
+inline size_t SlabAllocator::get_used_bytes() const {
+  return used_bytes_m;
+}
+
+inline size_t SlabAllocator::size_class_of(size_t size) {
+  /// a free slot has to be able to hold a FreeSlot
+  if (size < sizeof(FreeSlot)) {
+    size = sizeof(FreeSlot);
+  }
+  return (size + GRANULE - 1) / GRANULE;
+}
+
+inline void* SlabAllocator::allocate(size_t size) {
+  size_t size_class = size_class_of(size);
+
+  if (size > MAX_SMALL || free_m[size_class] == NULL) {
+    return allocate_slow(size);
+  }
+
+  FreeSlot* f = free_m[size_class];
+  free_m[size_class] = f->next_m;
+
+  used_bytes_m += size_class * GRANULE;
+  ++used_slots_m;
+
+  /// cells are a few words, a loop is cheaper than calling memset
+  for (size_t i = 0; i < size_class; ++i) {
+    ((unsigned long long*) f)[i] = 0;
+  }
+  return f;
+}
+
+#endif
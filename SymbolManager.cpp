@@ -0,0 +1,71 @@
+/**
+ * \file SymbolManager.cpp
+ *
+ * Implementation of the symbol table
+ */
+
+#include "SymbolManager.hpp"
+
+#include <cstring>
+
+/// define static members
+SymbolManager* SymbolManager::instance = NULL;
+
+SymbolManager::SymbolManager() {}
+
+/// Singleton Pattern
+SymbolManager* SymbolManager::Instance() {
+  if (instance == NULL) {
+    instance = new SymbolManager();
+  }
+  return instance;
+}
+
+/**
+ * \struct Name
+ *
+ * \brief Stands in for the string key of a name which is looked up
+ */
+struct Name {
+  const char* data_m;
+  size_t      length_m;
+};
+
+static inline bool operator==(const string& key, const Name& name) {
+  return key.size() == name.length_m && memcmp(key.data(), name.data_m, name.length_m) == 0;
+}
+
+SymbolCell* SymbolManager::intern(const string& name) {
+  return intern(name.data(), name.size());
+}
+
+SymbolCell* SymbolManager::intern(const char* name, size_t length) {
+  size_t hash = hash_key(name, length);
+  Name stand_in = { name, length };
+  hashtablemap<string, SymbolCell*>::iterator it = symbols_m.find_as(stand_in, hash);
+
+  if (it != symbols_m.end()) {
+    return it->second;
+  }
+
+  /// the hash is computed only once per symbol. Allocating may collect
+  /// (and remove) other symbols, so the table is only changed afterwards
+  string key(name, length);
+  SymbolCell* symbol = new SymbolCell(key.c_str(), hash);
+  symbols_m.insert(pair<const string, SymbolCell*>(key, symbol));
+
+  return symbol;
+}
+
+void SymbolManager::remove(const SymbolCell* symbol) {
+  hashtablemap<string, SymbolCell*>::iterator it = symbols_m.find(symbol->get_symbol());
+
+  /// a name which has been interned again belongs to another cell
+  if (it != symbols_m.end() && it->second == symbol) {
+    symbols_m.erase(it);
+  }
+}
+
+size_t SymbolManager::size() const {
+  return symbols_m.size();
+}
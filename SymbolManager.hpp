@@ -0,0 +1,86 @@
+/**
+ * \file SymbolManager.hpp
+ *
+ * \brief Interns symbols, so that every name exists only once
+ */
+
+#ifndef SYMBOLMANAGER_HPP
+#define SYMBOLMANAGER_HPP
+
+#include <string>
+#include "Cell.hpp"
+#include "hashtablemap.hpp"
+
+using namespace std;
+
+/**
+ * \class SymbolManager
+ *
+ * \brief Singleton Class which owns the table of interned symbols.
+ *        make_symbol() asks the SymbolManager for the SymbolCell of a
+ *        name, which is created only if the name is not interned yet.
+ *        Therefore symbols with the same name are the same cell and
+ *        can be compared by pointer.
+ *
+ * The table does not keep its symbols alive: it is not a root of the
+ * GarbageCollector. A symbol which is not referenced anymore is swept
+ * like every other cell and removes itself from the table in its
+ * destructor. A name which is used again afterwards is simply interned
+ * again.
+ */
+class SymbolManager {
+public:
+
+  /**
+   * \brief Should be used to get the instance of this class. Will
+   *        instantiate itself if is is not done yet. --> Singleton
+   *        pattern
+   */
+  static SymbolManager* Instance();
+
+  /**
+   * \brief Returns the interned symbol of name, creates it if necessary
+   */
+  SymbolCell* intern(const string& name);
+
+  /**
+   * \brief Returns the interned symbol of the name of length characters
+   *        at name, which need not be terminated. A name which is
+   *        interned already is looked up in place, without copying it
+   *        (the Reader interns straight from its buffer)
+   */
+  SymbolCell* intern(const char* name, size_t length);
+
+  /**
+   * \brief Removes symbol from the table. Called by the destructor of
+   *        SymbolCell
+   */
+  void remove(const SymbolCell* symbol);
+
+  /**
+   * \return number of interned symbols
+   */
+  size_t size() const;
+
+private:
+  static SymbolManager* instance;
+
+  hashtablemap<string, SymbolCell*> symbols_m;
+
+  /**
+   * \brief Constructor is private --> Singleton Pattern
+   */
+  SymbolManager();
+
+  /**
+   * \brief Makes sure there is no copy constructor
+   */
+  SymbolManager(SymbolManager const&);
+
+  /** 
+   * \brief Makes sure no assignments are possible
+   */
+  void operator=(SymbolManager const&);
+};
+
+#endif
@@ -0,0 +1,831 @@
+#include "VirtualMachine.hpp"
+#include "DefinitionManager.hpp"
+#include "functions.hpp"
+#include "eval.hpp"
+
+#include "cons.hpp"
+
+/// Computed goto is a GNU extension. Define VM_NO_COMPUTED_GOTO to
+/// dispatch by switch anyway
+#if defined(__GNUC__) && !defined(VM_NO_COMPUTED_GOTO)
+#define VM_COMPUTED_GOTO
+#endif
+
+/// define static members
+VirtualMachine* VirtualMachine::instance = NULL;
+
+VirtualMachine::VirtualMachine() : current_m(NULL) {}
+
+/// Singleton Pattern
+VirtualMachine* VirtualMachine::Instance() {
+  if (instance == NULL) {
+    instance = new VirtualMachine();
+  }
+  return instance;
+}
+
+Cell* VirtualMachine::apply(const ProcedureCell* proc, Cell* const args) throw (runtime_error) {
+  CodeCell* code = proc->get_code();
+  DefinitionManager* defs = DefinitionManager::Instance();
+
+  defs->add_stackframe();
+
+  try {
+    /// define local variables in local stack frame
+    if (code->num_param_m == -1) {
+      defs->add_definition(code->params_m[0], args);
+    }
+    else {
+      if (ConsCell::get_list_size(args) != code->num_param_m) {
+	throw_mismatch(proc);
+      }
+
+      size_t i = 0;
+      for (Cell* pos = args; !nullp(pos); pos = cdr(pos)) {
+	defs->add_definition(code->params_m[i++], eval(car(pos)));
+      }
+    }
+  }
+  catch (const runtime_error&) {
+    /// makes sure stackframe gets pop in case of an error
+    defs->pop_stackframe();
+    throw;
+  }
+
+  /// the evaluation of the body pops the stack frame
+  return execute(code, true);
+}
+
+bool VirtualMachine::prepare(const ProcedureCell* proc, int num_args, Cell* const args,
+			     bool& framed) throw (runtime_error) {
+  CodeCell* code = proc->get_code();
+
+  if (code->num_param_m == -1) {
+    stack_m.push_back(proc->apply(args));
+    return true;
+  }
+
+  /// the stack frame is popped by OP_RETURN, even in case of an error
+  DefinitionManager::Instance()->add_tail_stackframe(framed);
+
+  if (num_args != code->num_param_m) {
+    if (num_args == -1) {
+      ConsCell::get_list_size(args);     /// throws, args is not a list
+    }
+    throw_mismatch(proc);
+  }
+
+  stack_m.push_back((Cell*) proc);
+  return false;
+}
+
+void VirtualMachine::throw_mismatch(const ProcedureCell* proc) const throw (runtime_error) {
+  stringstream ss;
+  ss << "Mismatch of number of arguments in:" << endl;
+  ss << "\t";
+  print_cell(ss, proc->get_body());
+  ss << endl;
+
+  throw runtime_error(ss.str());
+}
+
+Cell* VirtualMachine::execute(CodeCell* const code, bool framed) throw (runtime_error) {
+  DefinitionManager* defs = DefinitionManager::Instance();
+
+  const size_t base = records_m.size();
+  const size_t stack_base = stack_m.size();
+
+  /// returning from the evaluation of code returns from execute()
+  Record entry;
+  entry.code_m   = current_m;
+  entry.pc_m     = NULL;
+  entry.framed_m = false;
+  records_m.push_back(entry);
+
+  current_m = code;
+  const Instruction* begin = &code->code_m[0];
+  const Instruction* pc = begin;
+
+#ifdef VM_COMPUTED_GOTO
+#define OPCODE_LABEL(op) &&L_##op,
+  static void* const dispatch_table[] = { OPCODES(OPCODE_LABEL) };
+#undef OPCODE_LABEL
+#define DISPATCH() goto *dispatch_table[pc->op]
+#define TARGET(op) L_##op:
+#else
+#define DISPATCH() continue
+#define TARGET(op) case op:
+#endif
+
+  try {
+#ifdef VM_COMPUTED_GOTO
+    DISPATCH();
+#else
+    for (;;) switch (pc->op) {
+#endif
+
+    TARGET(OP_CONST) {
+      stack_m.push_back(pc->cell);
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_REF) {
+      const SymbolCell* sym = (const SymbolCell*) pc->cell;
+      Cell* value = sym->get_value();
+      if (value == NULL) {
+	value = defs->get_definition(sym);  /// throws
+      }
+      stack_m.push_back(value);
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_POP) {
+      stack_m.pop_back();
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_JUMP) {
+      pc = begin + pc->n;
+      DISPATCH();
+    }
+
+    TARGET(OP_JUMP_FALSE) {
+      Cell* condition = stack_m.back();
+      stack_m.pop_back();
+      if (is_true(condition)) {
+	++pc;
+      }
+      else {
+	pc = begin + pc->n;
+      }
+      DISPATCH();
+    }
+
+    TARGET(OP_GUARD) {
+      Cell* value = ((const SymbolCell*) pc->cell)->get_value();
+      if (value != NULL && object_of(value)->is_lambda()) {
+	pc = begin + pc->n;
+      }
+      else {
+	++pc;
+      }
+      DISPATCH();
+    }
+
+    TARGET(OP_ENTER) {
+      Record record;
+      record.code_m   = current_m;
+      record.pc_m     = begin + pc->n;
+      record.framed_m = framed;
+      records_m.push_back(record);
+
+      framed = false;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_RETURN) {
+      if (framed) {
+	defs->pop_stackframe();
+      }
+
+      Record record = records_m.back();
+      records_m.pop_back();
+      current_m = record.code_m;
+
+      if (record.pc_m == NULL) {
+	Cell* result = stack_m.back();
+	stack_m.pop_back();
+	return result;
+      }
+
+      begin  = &current_m->code_m[0];
+      pc     = record.pc_m;
+      framed = record.framed_m;
+      DISPATCH();
+    }
+
+    TARGET(OP_PREPARE) {
+      Cell* value = ((const SymbolCell*) pc->cell)->get_value();
+      if (value == NULL || !object_of(value)->is_lambda()) {
+	throw runtime_error("No operator/ function in front");
+      }
+
+      if (prepare((const ProcedureCell*) value, pc->n, pc[1].cell, framed)) {
+	pc = begin + pc[1].n;
+      }
+      else {
+	pc += 2;
+      }
+      DISPATCH();
+    }
+
+    TARGET(OP_PREPARE_DYNAMIC) {
+      Cell* value = stack_m.back();
+
+      if (object_of(value)->is_lambda()) {
+	stack_m.pop_back();
+	if (prepare((const ProcedureCell*) value, pc->n, pc[1].cell, framed)) {
+	  pc = begin + pc[1].n;
+	}
+	else {
+	  pc += 2;
+	}
+	DISPATCH();
+      }
+
+      /// e.g. a function, which evaluates the arguments itself
+      Cell* result = object_of(value)->apply(pc[1].cell);
+      stack_m.back() = result;
+      pc = begin + pc[1].n;
+      DISPATCH();
+    }
+
+    TARGET(OP_ARGS) {
+      throw logic_error("Operand executed as instruction");
+    }
+
+    TARGET(OP_BIND) {
+      Cell* value = stack_m.back();
+      stack_m.pop_back();
+
+      const ProcedureCell* proc = (const ProcedureCell*) stack_m.back();
+      defs->add_definition(proc->get_code()->params_m[pc->n], value);
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_TAIL_CALL) {
+      const ProcedureCell* proc = (const ProcedureCell*) stack_m.back();
+      stack_m.pop_back();
+
+      current_m = proc->get_code();
+      begin = &current_m->code_m[0];
+      pc = begin;
+      DISPATCH();
+    }
+
+    TARGET(OP_NO_OPERATOR) {
+      throw runtime_error("No operator/ function in front");
+    }
+
+    TARGET(OP_LET) {
+      defs->add_tail_stackframe(framed);
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_DEFINE) {
+      Cell* value = stack_m.back();
+      stack_m.pop_back();
+
+      defs->add_definition((const SymbolCell*) pc->cell, value);
+      if (pc->n) {
+	stack_m.push_back(nil);          /// define always returns nil
+      }
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_LAMBDA) {
+      Cell* proc = new ProcedureCell((CodeCell*) pc->cell);
+      stack_m.push_back(proc);
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_EVAL_AGAIN) {
+      if (!nullp(stack_m.back())) {
+	Cell* result = eval(stack_m.back());
+	stack_m.back() = result;
+      }
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_APPLY_RAW) {
+      Cell* result = object_of(pc->cell)->apply(pc[1].cell);
+      stack_m.push_back(result);
+      pc += 2;
+      DISPATCH();
+    }
+
+    TARGET(OP_CAR) {
+      stack_m.back() = car(stack_m.back());
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_CDR) {
+      stack_m.back() = cdr(stack_m.back());
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_CONS) {
+      size_t top = stack_m.size();
+      Cell* result = cons(stack_m[top - 2], stack_m[top - 1]);
+      stack_m.pop_back();
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_INTP) {
+      stack_m.back() = make_int(intp(stack_m.back()) ? 1 : 0);
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_DOUBLEP) {
+      stack_m.back() = make_int(doublep(stack_m.back()) ? 1 : 0);
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_SYMBOLP) {
+      stack_m.back() = make_int(symbolp(stack_m.back()) ? 1 : 0);
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_NULLP) {
+      stack_m.back() = make_int(nullp(stack_m.back()) ? 1 : 0);
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_LISTP) {
+      stack_m.back() = make_int(listp(stack_m.back()) ? 1 : 0);
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_NOT) {
+      stack_m.back() = do_not(stack_m.back());
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_LESS) {
+      size_t num_values = 2 * pc->n - 1;
+      size_t first = stack_m.size() - num_values;
+
+      bool symbols = symbolp(stack_m[first]);
+      bool less = true;
+      for (size_t i = first + 1; i < stack_m.size(); i += 2) {
+	if (!less_than(symbols, stack_m[i], stack_m[i + 1])) {
+	  less = false;
+	}
+      }
+
+      stack_m.resize(first);
+      stack_m.push_back(make_int(less ? 1 : 0));
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_ARITH) {
+      size_t top = stack_m.size();
+      const ArithmeticCell* op = (const ArithmeticCell*) pc->cell;
+      Cell* result = op->calculate(stack_m[top - 2], stack_m[top - 1]);
+      stack_m.pop_back();
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_ARITH1) {
+      const ArithmeticCell* op = (const ArithmeticCell*) pc->cell;
+      Cell* result = op->calculate(stack_m.back());
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_ARITH_N) {
+      size_t first = stack_m.size() - pc->n;
+      const ArithmeticCell* op = (const ArithmeticCell*) pc->cell;
+      Cell* result = op->calculate(&stack_m[first], pc->n);
+      stack_m.resize(first);
+      stack_m.push_back(result);
+      ++pc;
+      DISPATCH();
+    }
+
+    /// builtins which may allocate or evaluate: the result has to be
+    /// computed before the stack is accessed again, since it may grow
+
+    TARGET(OP_PRINT) {
+      Cell* result = do_print(stack_m.back());
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_EVAL) {
+      Cell* result = do_eval(stack_m.back());
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_APPLY) {
+      size_t top = stack_m.size();
+      Cell* result = do_apply(stack_m[top - 2], stack_m[top - 1]);
+      stack_m.pop_back();
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_RAND) {
+      size_t top = stack_m.size();
+      Cell* result = do_rand(stack_m[top - 2], stack_m[top - 1]);
+      stack_m.pop_back();
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_STR) {
+      Cell* result = do_str(stack_m.back());
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_SUBSTR) {
+      size_t top = stack_m.size();
+      Cell* result = do_substr(stack_m[top - 3], stack_m[top - 2], stack_m[top - 1]);
+      stack_m.resize(top - 2);
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_APPSTR) {
+      size_t top = stack_m.size();
+      Cell* result = do_appstr(stack_m[top - 2], stack_m[top - 1]);
+      stack_m.pop_back();
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_PARSE) {
+      Cell* result = do_parse(stack_m.back());
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_PARSE_EVAL) {
+      Cell* result = do_parse_eval(stack_m.back());
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_CEILING) {
+      Cell* result = do_ceiling(stack_m.back());
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_FLOOR) {
+      Cell* result = do_floor(stack_m.back());
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_GC_GROWTH) {
+      Cell* result = do_gc_growth(stack_m.back());
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_MAKE_VECTOR) {
+      size_t top = stack_m.size();
+      Cell* result = pc->n == 2 ? do_make_vector(stack_m[top - 2], stack_m[top - 1])
+	: do_make_vector(stack_m[top - 1], nil);
+      stack_m.resize(top - pc->n + 1);
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_VECTOR_REF) {
+      size_t top = stack_m.size();
+      Cell* result = do_vector_ref(stack_m[top - 2], stack_m[top - 1]);
+      stack_m.pop_back();
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_VECTOR_SET) {
+      size_t top = stack_m.size();
+      Cell* result = do_vector_set(stack_m[top - 3], stack_m[top - 2], stack_m[top - 1]);
+      stack_m.resize(top - 2);
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_VECTOR_LENGTH) {
+      Cell* result = do_vector_length(stack_m.back());
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_VECTORP) {
+      stack_m.back() = make_int(vectorp(stack_m.back()) ? 1 : 0);
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_STRING_LENGTH) {
+      Cell* result = do_string_length(stack_m.back());
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_STRING_REF) {
+      size_t top = stack_m.size();
+      Cell* result = do_string_ref(stack_m[top - 2], stack_m[top - 1]);
+      stack_m.pop_back();
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_STRING_SET) {
+      size_t top = stack_m.size();
+      Cell* result = do_string_set(stack_m[top - 3], stack_m[top - 2], stack_m[top - 1]);
+      stack_m.resize(top - 2);
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_STRING_APPEND) {
+      size_t top = stack_m.size();
+      Cell* result = do_string_append(stack_m[top - 2], stack_m[top - 1]);
+      stack_m.pop_back();
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_STRINGP) {
+      stack_m.back() = make_int(stringp(stack_m.back()) ? 1 : 0);
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_MAKE_STRING) {
+      size_t top = stack_m.size();
+      Cell* result = pc->n == 2 ? do_make_string(stack_m[top - 2], stack_m[top - 1])
+	: do_make_string(stack_m[top - 1], NULL);
+      stack_m.resize(top - pc->n + 1);
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_SUBSTRING) {
+      size_t top = stack_m.size();
+      Cell* result = do_substring(stack_m[top - 3], stack_m[top - 2], stack_m[top - 1]);
+      stack_m.resize(top - 2);
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_STRING_TO_SYMBOL) {
+      Cell* result = do_string_to_symbol(stack_m.back());
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_SYMBOL_TO_STRING) {
+      Cell* result = do_symbol_to_string(stack_m.back());
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_EQ) {
+      size_t top = stack_m.size();
+      Cell* result = do_eq(stack_m[top - 2], stack_m[top - 1]);
+      stack_m.pop_back();
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_EQUAL) {
+      size_t top = stack_m.size();
+      Cell* result = do_equal(stack_m[top - 2], stack_m[top - 1]);
+      stack_m.pop_back();
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_HASH_TABLE_REF) {
+      size_t top = stack_m.size();
+      Cell* result = pc->n == 3
+	? do_hash_table_ref(stack_m[top - 3], stack_m[top - 2], stack_m[top - 1])
+	: do_hash_table_ref(stack_m[top - 2], stack_m[top - 1], NULL);
+      stack_m.resize(top - pc->n + 1);
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_HASH_TABLE_SET) {
+      size_t top = stack_m.size();
+      Cell* result = do_hash_table_set(stack_m[top - 3], stack_m[top - 2], stack_m[top - 1]);
+      stack_m.resize(top - 2);
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_HASH_TABLE_DELETE) {
+      size_t top = stack_m.size();
+      Cell* result = do_hash_table_delete(stack_m[top - 2], stack_m[top - 1]);
+      stack_m.pop_back();
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_HASH_TABLE_CONTAINS) {
+      size_t top = stack_m.size();
+      Cell* result = do_hash_table_contains(stack_m[top - 2], stack_m[top - 1]);
+      stack_m.pop_back();
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_HASH_TABLE_COUNT) {
+      Cell* result = do_hash_table_count(stack_m.back());
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_MAKE_HASH_TABLE) {
+      size_t top = stack_m.size();
+      Cell* result = do_make_hash_table(pc->n == 1 ? stack_m[top - 1] : NULL);
+      stack_m.resize(top - pc->n + 1);
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_HASH_TABLE_KEYS) {
+      Cell* result = do_hash_table_keys(stack_m.back());
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_HASH_TABLE_VALUES) {
+      Cell* result = do_hash_table_values(stack_m.back());
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_HASH_TABLE_TO_ALIST) {
+      Cell* result = do_hash_table_to_alist(stack_m.back());
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_HASH_TABLE_WALK) {
+      size_t top = stack_m.size();
+      Cell* result = do_hash_table_walk(stack_m[top - 2], stack_m[top - 1]);
+      stack_m.pop_back();
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_HASH_TABLEP) {
+      stack_m.back() = make_int(hash_tablep(stack_m.back()) ? 1 : 0);
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_LENGTH) {
+      Cell* result = do_length(stack_m.back());
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_APPEND) {
+      size_t top = stack_m.size();
+      Cell* result = do_append(stack_m[top - 2], stack_m[top - 1]);
+      stack_m.pop_back();
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_REVERSE) {
+      Cell* result = do_reverse(stack_m.back());
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_ASSOC) {
+      size_t top = stack_m.size();
+      Cell* result = do_assoc(stack_m[top - 2], stack_m[top - 1]);
+      stack_m.pop_back();
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_LIST_TAIL) {
+      size_t top = stack_m.size();
+      Cell* result = do_list_tail(stack_m[top - 2], stack_m[top - 1]);
+      stack_m.pop_back();
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_LIST_REF) {
+      size_t top = stack_m.size();
+      Cell* result = do_list_ref(stack_m[top - 2], stack_m[top - 1]);
+      stack_m.pop_back();
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+    TARGET(OP_LIST_SORT) {
+      size_t top = stack_m.size();
+      Cell* result = do_list_sort(stack_m[top - 2], stack_m[top - 1]);
+      stack_m.pop_back();
+      stack_m.back() = result;
+      ++pc;
+      DISPATCH();
+    }
+
+#ifndef VM_COMPUTED_GOTO
+    default:
+      throw logic_error("Unknown opcode");
+    }
+#endif
+  }
+  catch (const runtime_error&) {
+    /// pops the stack frames of all evaluations, as if they had returned
+    if (framed) {
+      defs->pop_stackframe();
+    }
+    while (records_m.size() > base + 1) {
+      framed = records_m.back().framed_m;
+      records_m.pop_back();
+      if (framed) {
+	defs->pop_stackframe();
+      }
+    }
+
+    current_m = records_m.back().code_m;
+    records_m.pop_back();
+    stack_m.resize(stack_base);
+    throw;
+  }
+
+#undef DISPATCH
+#undef TARGET
+}
+
+void VirtualMachine::get_roots(vector<Cell*>& roots) const {
+  roots.insert(roots.end(), stack_m.begin(), stack_m.end());
+
+  roots.push_back(current_m);
+  for (vector<Record>::const_iterator r = records_m.begin(); r != records_m.end(); ++r) {
+    roots.push_back((*r).code_m);
+  }
+}
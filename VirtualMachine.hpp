@@ -0,0 +1,116 @@
+/**
+ * \file VirtualMachine
+ *
+ * \brief Executes the code produced by the Compiler
+ */
+
+#ifndef VIRTUALMACHINE_HPP
+#define VIRTUALMACHINE_HPP
+
+#include <vector>
+#include <stdexcept>
+#include "Cell.hpp"
+#include "bytecode.hpp"
+
+using namespace std;
+
+/**
+ * \class VirtualMachine
+ *
+ * \brief Singleton Class which executes CodeCells. Stack based, the
+ *        instructions are dispatched by computed goto if the compiler
+ *        supports it (GCC and clang), by a switch otherwise.
+ *
+ * Calls of procedures do not recurse on the C++ stack: the VirtualMachine
+ * remembers where to continue in a record of its own stack. Every
+ * evaluation (the body of a procedure, but also a nested expression
+ * such as an argument) has its record and owns at most one stack frame of
+ * the DefinitionManager, which is popped by OP_RETURN. Tail calls start
+ * a new activation in that stack frame instead of adding a new one, so
+ * tail recursive loops run in constant space.
+ *
+ * The value stack and the records are roots of the GarbageCollector.
+ * Builtins which evaluate expressions themselves call eval(), which runs
+ * the VirtualMachine recursively.
+ */
+class VirtualMachine {
+public:
+
+  /**
+   * \brief Should be used to get the instance of this class. Will
+   *        instantiate itself if is is not done yet. --> Singleton
+   *        pattern
+   */
+  static VirtualMachine* Instance();
+
+  /**
+   * \brief Executes code until its evaluation returns
+   * \param framed true if the evaluation owns the current stack frame of
+   *        the DefinitionManager, which is popped at the end
+   * \return the value of the evaluation
+   */
+  Cell* execute(CodeCell* const code, bool framed) throw (runtime_error);
+
+  /**
+   * \brief Applies proc to the unevaluated arguments args in a new stack
+   *        frame. See ProcedureCell::apply()
+   */
+  Cell* apply(const ProcedureCell* proc, Cell* const args) throw (runtime_error);
+
+  /**
+   * \brief Pushes the value stack and the code being executed onto
+   *        roots. Used by the GarbageCollector
+   */
+  void get_roots(vector<Cell*>& roots) const;
+
+private:
+  /**
+   * \struct Record
+   *
+   * \brief Where to continue after an evaluation has returned
+   */
+  struct Record {
+    CodeCell*          code_m;
+    const Instruction* pc_m;     ///< NULL: return from execute()
+    bool               framed_m; ///< of the evaluation to continue
+  };
+
+  static VirtualMachine* instance;
+
+  vector<Cell*>  stack_m;
+  vector<Record> records_m;
+  CodeCell*      current_m;      ///< code being executed
+
+  /**
+   * \brief Constructor is private --> Singleton Pattern
+   */
+  VirtualMachine();
+
+  /**
+   * \brief Makes sure there is no copy constructor
+   */
+  VirtualMachine(VirtualMachine const&);
+
+  /**
+   * \brief Makes sure no assignments are possible
+   */
+  void operator=(VirtualMachine const&);
+
+  /**
+   * \brief Starts the call of proc with num_args arguments: starts an
+   *        activation in the current stack frame and pushes proc, so the
+   *        arguments can be bound (OP_BIND). Procedures with a variable
+   *        number of arguments are applied right away
+   * \param args the unevaluated arguments
+   * \return true if proc has been applied, its result is pushed
+   */
+  bool prepare(const ProcedureCell* proc, int num_args, Cell* const args,
+	       bool& framed) throw (runtime_error);
+
+  /**
+   * \throw runtime_error that the number of arguments does not match
+   */
+  void throw_mismatch(const ProcedureCell* proc) const throw (runtime_error);
+};
+
+#endif
@@ -0,0 +1,158 @@
+/**
+ * \file alloc_bench.cpp
+ *
+ * Compares list construction and traversal on the slab allocated Cell
+ * heap against cells allocated with the global operator new. The slab
+ * is measured twice: with the collections which building the list
+ * triggers, and with collections held off until the list is dropped,
+ * which compares allocation alone with operator new. Freeing the lists
+ * is not timed in either case.
+ *
+ * Build and run with "make bench".
+ */
+
+#include "../cons.hpp"
+#include "../GarbageCollector.hpp"
+
+#include <ctime>
+#include <iostream>
+#include <iomanip>
+#include <new>
+
+using namespace std;
+
+static const int LIST_LENGTH = 1000000;
+static const int ROUNDS = 5;
+
+/// default of the GarbageCollector
+static const size_t MIN_THRESHOLD = 1 << 20;
+
+/**
+ * \brief Milliseconds of cpu time since start
+ */
+static double elapsed(clock_t start) {
+  return 1000.0 * (clock() - start) / CLOCKS_PER_SEC;
+}
+
+/**
+ * \brief Sums up the int cells of a list
+ */
+static long traverse(Cell* list) {
+  long sum = 0;
+  for (Cell* pos = list; !nullp(pos); pos = cdr(pos)) {
+    sum += get_int(car(pos));
+  }
+  return sum;
+}
+
+/**
+ * \brief Percentage of cons cells whose cdr directly follows them
+ */
+static double adjacency(Cell* list) {
+  long neighbours = 0;
+  long total = 0;
+  for (Cell* pos = list; !nullp(pos) && !nullp(cdr(pos)); pos = cdr(pos)) {
+    long distance = (char*) pos - (char*) cdr(pos);
+    if (distance < 0) {
+      distance = -distance;
+    }
+    if (distance <= (long) sizeof(ConsCell)) {
+      ++neighbours;
+    }
+    ++total;
+  }
+  return 100.0 * neighbours / total;
+}
+
+static Cell* build_slab(int n) {
+  Cell* list = nil;
+  for (int i = 0; i < n; ++i) {
+    list = cons(make_int(i), list);
+  }
+  return list;
+}
+
+static Cell* build_plain(int n) {
+  Cell* list = nil;
+  for (int i = 0; i < n; ++i) {
+    list = ::new ConsCell(make_int(i), list);
+  }
+  return list;
+}
+
+static void free_plain(Cell* list) {
+  while (!nullp(list)) {
+    Cell* next = cdr(list);
+    list->~Cell();
+    ::operator delete(list);
+    list = next;
+  }
+}
+
+static void report(const char* name, double build, double walk, double adjacent) {
+  double cells = (double) LIST_LENGTH * ROUNDS;
+  cout << setw(12) << name
+       << setw(14) << fixed << setprecision(1) << cells / build / 1000.0
+       << setw(14) << cells / walk / 1000.0
+       << setw(12) << adjacent << "%" << endl;
+}
+
+/**
+ * \brief Builds and walks ROUNDS lists on the slab. Without gc no
+ *        collection is triggered while a list is built
+ */
+static long run_slab(const char* name, bool gc) {
+  double build = 0, walk = 0, adjacent = 0;
+  long check = 0;
+
+  for (int r = 0; r < ROUNDS; ++r) {
+    if (!gc) {
+      GarbageCollector::Instance()->set_min_threshold((size_t) 1 << 40);
+    }
+
+    clock_t start = clock();
+    Cell* list = build_slab(LIST_LENGTH);
+    build += elapsed(start);
+
+    start = clock();
+    check += traverse(list);
+    walk += elapsed(start);
+
+    adjacent = adjacency(list);
+    list = nil;
+    GarbageCollector::Instance()->set_min_threshold(MIN_THRESHOLD);
+    GarbageCollector::Instance()->collect();
+  }
+
+  report(name, build, walk, adjacent);
+  return check;
+}
+
+int main(int argc, char* argv[]) {
+  GarbageCollector::Instance()->set_stack_bottom(&argc);
+
+  cout << "list of " << LIST_LENGTH << " cells, " << ROUNDS << " rounds" << endl;
+  cout << setw(12) << "allocator" << setw(14) << "build M/s"
+       << setw(14) << "traverse M/s" << setw(13) << "adjacent" << endl;
+
+  long check = run_slab("slab + gc", true);
+  check += run_slab("slab", false);
+
+  double build = 0, walk = 0, adjacent = 0;
+  for (int r = 0; r < ROUNDS; ++r) {
+    clock_t start = clock();
+    Cell* list = build_plain(LIST_LENGTH);
+    build += elapsed(start);
+
+    start = clock();
+    check -= 2 * traverse(list);
+    walk += elapsed(start);
+
+    adjacent = adjacency(list);
+    free_plain(list);
+  }
+  report("new", build, walk, adjacent);
+
+  /// all variants have to see the same lists
+  return check == 0 ? 0 : 1;
+}
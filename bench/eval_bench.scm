@@ -0,0 +1,19 @@
+(define repeat
+  (lambda (n thunk)
+    (if (< n 1)
+	(quote ())
+	(let ((ignored (thunk)))
+	  (repeat (- n 1) thunk)))))
+(define iota
+  (lambda (n acc)
+    (if (< n 1)
+	acc
+	(iota (- n 1) (cons (rand 0 1000) acc)))))
+(define numbers (iota 300 (quote ())))
+(repeat 30 (lambda () (gen-labyrinth (symbol->string (str (create-field))))))
+(repeat 3 (lambda () (list-sort (lambda (a b) (< a b)) numbers)))
+(repeat 20 (lambda () (reverse numbers)))
+(repeat 2000 (lambda () (factorial 12)))
+(repeat 20 (lambda () (even? 10000)))
+(repeat 20 (lambda () (equal? numbers numbers)))
+(quote done)
@@ -0,0 +1,99 @@
+/**
+ * \file fasl_bench.cpp
+ *
+ * Round-trips the data of parse_bench (a single list of records, 1, 10
+ * and 100 MB of s-expression text, or the sizes in MB given as
+ * arguments) through its printed form and through the fasl format.
+ *
+ * Build and run with "make bench".
+ */
+
+#include "../parse.hpp"
+#include "../fasl.hpp"
+#include "../GarbageCollector.hpp"
+
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+using namespace std;
+
+/**
+ * \brief Milliseconds of cpu time since start
+ */
+static double elapsed(clock_t start) {
+  return 1000.0 * (clock() - start) / CLOCKS_PER_SEC;
+}
+
+/**
+ * \brief Contents of a data file of about megabytes MB
+ */
+static string make_file(int megabytes) {
+  size_t size = (size_t) megabytes * 1024 * 1024;
+  string text;
+  text.reserve(size + 128);
+  text += "(records\n";
+
+  for (int i = 0; text.size() < size; ++i) {
+    ostringstream record;
+    record << "  (record " << i << " name-" << i % 1000 << " " << i % 97 << ".25"
+	   << " (tags alpha beta) \"" << i % 13 << " units\" ())\n";
+    text += record.str();
+  }
+
+  text += ")\n";
+  return text;
+}
+
+int main(int argc, char* argv[]) {
+  GarbageCollector::Instance()->set_stack_bottom(&argc);
+
+  static const int DEFAULT_SIZES[] = { 1, 10, 100 };
+  vector<int> sizes;
+  for (int i = 1; i < argc; ++i) {
+    sizes.push_back(atoi(argv[i]));
+  }
+  if (sizes.empty()) {
+    sizes.assign(DEFAULT_SIZES, DEFAULT_SIZES + 3);
+  }
+
+  cout << setw(6) << "MB" << setw(12) << "print ms" << setw(12) << "parse ms"
+       << setw(12) << "fasl MB" << setw(12) << "write ms" << setw(12) << "read ms"
+       << setw(10) << "MB/s" << endl;
+
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    Cell* tree = parse(make_file(sizes[i]));
+
+    clock_t start = clock();
+    ostringstream printed;
+    print_cell(printed, tree);
+    double print_ms = elapsed(start);
+
+    start = clock();
+    Cell* parsed = parse(printed.str());
+    double parse_ms = elapsed(start);
+    parsed = nil;
+
+    string fasl;
+    start = clock();
+    write_fasl(tree, fasl);
+    double write_ms = elapsed(start);
+
+    start = clock();
+    Cell* read = read_fasl(fasl.data(), fasl.data() + fasl.size());
+    double read_ms = elapsed(start);
+    read = nil;
+
+    cout << setw(6) << sizes[i] << fixed << setprecision(1)
+	 << setw(12) << print_ms << setw(12) << parse_ms
+	 << setw(12) << fasl.size() / 1024.0 / 1024.0
+	 << setw(12) << write_ms << setw(12) << read_ms
+	 << setw(10) << fasl.size() / 1024.0 / 1024.0 / (read_ms / 1000.0) << endl;
+
+    tree = nil;
+    GarbageCollector::Instance()->collect();
+  }
+  return 0;
+}
@@ -0,0 +1,104 @@
+/**
+ * \file hash_bench.cpp
+ *
+ * Compares looking up keys in a hash table (hash-table-ref) with looking
+ * them up in an association list (assoc as defined in library.scm), for
+ * 10^3 to 10^6 keys. Both are called through the interpreter. assoc is
+ * slow for many keys, so it looks up fewer keys there.
+ *
+ * Build and run with "make bench".
+ */
+
+#include "../cons.hpp"
+#include "../eval.hpp"
+#include "../parse.hpp"
+#include "../GarbageCollector.hpp"
+
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <iomanip>
+
+using namespace std;
+
+/// assoc and = of library.scm, which is not read here
+static const char* const LIBRARY_EQUAL =
+  "(define = (lambda (x y) (if (< x y) 0 (not (< y x)))))";
+
+static const char* const LIBRARY_ASSOC =
+  "(define scheme-assoc\n"
+  "  (lambda (key dict)\n"
+  "    (if (nullp dict)\n"
+  "	0\n"
+  "	(if (= key (car (car dict)))\n"
+  "	    (car dict)\n"
+  "	    (scheme-assoc key (cdr dict))))))\n";
+
+static const int HASH_LOOKUPS = 100000;
+
+/// assoc looks up ASSOC_WORK / keys keys, at most HASH_LOOKUPS
+static const long ASSOC_WORK = 10000000;
+
+/**
+ * \brief Milliseconds of cpu time since start
+ */
+static double elapsed(clock_t start) {
+  return 1000.0 * (clock() - start) / CLOCKS_PER_SEC;
+}
+
+static Cell* quoted(Cell* c) {
+  return cons(make_symbol("quote"), cons(c, nil));
+}
+
+/**
+ * \brief Microseconds per call of (function key container) or
+ *        (function container key), averaged over lookups random keys
+ *        below keys
+ */
+static double time_lookups(const char* function, Cell* container, bool key_first,
+			   int keys, int lookups) {
+  Cell* op = make_symbol(function);
+  Cell* argument = quoted(container);
+
+  srand(42);
+  clock_t start = clock();
+  for (int i = 0; i < lookups; ++i) {
+    Cell* key = make_int(rand() % keys);
+    Cell* call = key_first ? cons(op, cons(key, cons(argument, nil)))
+                           : cons(op, cons(argument, cons(key, nil)));
+    eval(call);
+  }
+  return 1000.0 * elapsed(start) / lookups;
+}
+
+int main(int argc, char* argv[]) {
+  GarbageCollector::Instance()->set_stack_bottom(&argc);
+
+  eval(parse(LIBRARY_EQUAL));
+  eval(parse(LIBRARY_ASSOC));
+
+  cout << setw(9) << "keys" << setw(14) << "assoc us" << setw(14) << "hash us"
+       << setw(10) << "speedup" << endl;
+
+  for (int keys = 1000; keys <= 1000000; keys *= 10) {
+    Cell* alist = nil;
+    Cell* table = make_hash_table(true);
+    for (int i = keys - 1; i >= 0; --i) {
+      alist = cons(cons(make_int(i), make_int(i)), alist);
+      get_hash_table(table)->set(make_int(i), make_int(i));
+    }
+
+    int assoc_lookups = (int) min((long) HASH_LOOKUPS, ASSOC_WORK / keys);
+    double assoc_us = time_lookups("scheme-assoc", alist, true, keys, assoc_lookups);
+    double hash_us = time_lookups("hash-table-ref", table, false, keys, HASH_LOOKUPS);
+
+    cout << setw(9) << keys << fixed << setprecision(3)
+	 << setw(14) << assoc_us << setw(14) << hash_us
+	 << setprecision(0) << setw(9) << assoc_us / hash_us << "x" << endl;
+
+    alist = nil;
+    table = nil;
+    GarbageCollector::Instance()->collect();
+  }
+  return 0;
+}
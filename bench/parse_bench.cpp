@@ -0,0 +1,97 @@
+/**
+ * \file parse_bench.cpp
+ *
+ * Measures parse() on synthetic data files: a single list of records,
+ * 1, 10 and 100 MB of s-expression text (or the sizes in MB given as
+ * arguments).
+ *
+ * Build and run with "make bench".
+ */
+
+#include "../parse.hpp"
+#include "../GarbageCollector.hpp"
+
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+using namespace std;
+
+/**
+ * \brief Milliseconds of cpu time since start
+ */
+static double elapsed(clock_t start) {
+  return 1000.0 * (clock() - start) / CLOCKS_PER_SEC;
+}
+
+/**
+ * \brief Contents of a data file of about megabytes MB
+ */
+static string make_file(int megabytes) {
+  size_t size = (size_t) megabytes * 1024 * 1024;
+  string text;
+  text.reserve(size + 128);
+  text += "(records\n";
+
+  for (int i = 0; text.size() < size; ++i) {
+    ostringstream record;
+    record << "  (record " << i << " name-" << i % 1000 << " " << i % 97 << ".25"
+	   << " (tags alpha beta) \"" << i % 13 << " units\" ())\n";
+    text += record.str();
+  }
+
+  text += ")\n";
+  return text;
+}
+
+/**
+ * \brief Number of atoms in the tree c
+ */
+static long count_atoms(Cell* c) {
+  long atoms = 0;
+  for (; !nullp(c); c = cdr(c)) {
+    if (listp(car(c))) {
+      atoms += count_atoms(car(c));
+    } else {
+      ++atoms;
+    }
+  }
+  return atoms;
+}
+
+int main(int argc, char* argv[]) {
+  GarbageCollector::Instance()->set_stack_bottom(&argc);
+
+  static const int DEFAULT_SIZES[] = { 1, 10, 100 };
+  vector<int> sizes;
+  for (int i = 1; i < argc; ++i) {
+    sizes.push_back(atoi(argv[i]));
+  }
+  if (sizes.empty()) {
+    sizes.assign(DEFAULT_SIZES, DEFAULT_SIZES + 3);
+  }
+
+  cout << setw(8) << "MB" << setw(12) << "atoms" << setw(12) << "parse ms"
+       << setw(10) << "MB/s" << endl;
+
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    string text = make_file(sizes[i]);
+
+    clock_t start = clock();
+    Cell* tree = parse(text);
+    double ms = elapsed(start);
+
+    if (nullp(tree)) {
+      return 1;
+    }
+    cout << setw(8) << sizes[i] << setw(12) << count_atoms(tree)
+	 << setw(12) << fixed << setprecision(1) << ms
+	 << setw(10) << text.size() / 1024.0 / 1024.0 / (ms / 1000.0) << endl;
+
+    tree = nil;
+    GarbageCollector::Instance()->collect();
+  }
+  return 0;
+}
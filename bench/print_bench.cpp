@@ -0,0 +1,88 @@
+/**
+ * \file print_bench.cpp
+ *
+ * Measures printing a flat list and a deeply nested list of 10^4, 10^5
+ * and 10^6 elements (or the numbers of elements given as arguments).
+ *
+ * Build and run with "make bench".
+ */
+
+#include "../cons.hpp"
+#include "../GarbageCollector.hpp"
+
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+using namespace std;
+
+/**
+ * \brief Milliseconds of cpu time since start
+ */
+static double elapsed(clock_t start) {
+  return 1000.0 * (clock() - start) / CLOCKS_PER_SEC;
+}
+
+/**
+ * \brief (0 1 ... n-1)
+ */
+static Cell* make_flat(int n) {
+  Cell* list = nil;
+  for (int i = n - 1; i >= 0; --i) {
+    list = cons(make_int(i), list);
+  }
+  return list;
+}
+
+/**
+ * \brief (0 (1 (... (n-1))))
+ */
+static Cell* make_nested(int n) {
+  Cell* list = nil;
+  for (int i = n - 1; i >= 0; --i) {
+    list = cons(make_int(i), nullp(list) ? nil : cons(list, nil));
+  }
+  return list;
+}
+
+/**
+ * \brief Prints list, reports the size of the output and the time it took
+ */
+static void measure(const char* shape, int n, Cell* list) {
+  ostringstream out;
+  clock_t start = clock();
+  print_cell(out, list);
+  double ms = elapsed(start);
+
+  cout << setw(8) << shape << setw(10) << n << setw(12) << out.str().size()
+       << setw(12) << fixed << setprecision(1) << ms << endl;
+}
+
+int main(int argc, char* argv[]) {
+  GarbageCollector::Instance()->set_stack_bottom(&argc);
+
+  static const int DEFAULT_SIZES[] = { 10000, 100000, 1000000 };
+  vector<int> sizes;
+  for (int i = 1; i < argc; ++i) {
+    sizes.push_back(atoi(argv[i]));
+  }
+  if (sizes.empty()) {
+    sizes.assign(DEFAULT_SIZES, DEFAULT_SIZES + 3);
+  }
+
+  cout << setw(8) << "list" << setw(10) << "elements" << setw(12) << "chars"
+       << setw(12) << "print ms" << endl;
+
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    Cell* list = make_flat(sizes[i]);
+    measure("flat", sizes[i], list);
+    list = make_nested(sizes[i]);
+    measure("nested", sizes[i], list);
+
+    list = nil;
+    GarbageCollector::Instance()->collect();
+  }
+  return 0;
+}
@@ -0,0 +1,113 @@
+/**
+ * \file scan_bench.cpp
+ *
+ * Measures the throughput of the Scanner with every classifier the cpu
+ * supports, alone and as part of parse(), on the data files of
+ * parse_bench: 1, 10 and 100 MB of s-expression text (or the sizes in MB
+ * given as arguments).
+ *
+ * Build and run with "make bench".
+ */
+
+#include "../parse.hpp"
+#include "../scan.hpp"
+#include "../GarbageCollector.hpp"
+
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+using namespace std;
+
+/**
+ * \brief Milliseconds of cpu time since start
+ */
+static double elapsed(clock_t start) {
+  return 1000.0 * (clock() - start) / CLOCKS_PER_SEC;
+}
+
+/**
+ * \brief Contents of a data file of about megabytes MB
+ */
+static string make_file(int megabytes) {
+  size_t size = (size_t) megabytes * 1024 * 1024;
+  string text;
+  text.reserve(size + 128);
+  text += "(records\n";
+
+  for (int i = 0; text.size() < size; ++i) {
+    ostringstream record;
+    record << "  (record " << i << " name-" << i % 1000 << " " << i % 97 << ".25"
+	   << " (tags alpha beta) \"" << i % 13 << " units\" ())\n";
+    text += record.str();
+  }
+
+  text += ")\n";
+  return text;
+}
+
+/**
+ * \brief Scans text in windows like the Reader does
+ * \return number of structural characters
+ */
+static size_t scan_all(const string& text) {
+  Scanner scanner;
+  vector<unsigned int> index;
+  size_t entries = 0;
+
+  for (size_t offset = 0; offset < text.size(); offset += Reader::WINDOW_SIZE) {
+    size_t n = min(Reader::WINDOW_SIZE, text.size() - offset);
+    index.clear();
+    scanner.scan(text.data() + offset, text.data() + offset + n, index);
+    entries += index.size();
+  }
+  return entries;
+}
+
+int main(int argc, char* argv[]) {
+  GarbageCollector::Instance()->set_stack_bottom(&argc);
+
+  static const int DEFAULT_SIZES[] = { 1, 10, 100 };
+  vector<int> sizes;
+  for (int i = 1; i < argc; ++i) {
+    sizes.push_back(atoi(argv[i]));
+  }
+  if (sizes.empty()) {
+    sizes.assign(DEFAULT_SIZES, DEFAULT_SIZES + 3);
+  }
+
+  cout << setw(6) << "MB" << setw(8) << "scanner" << setw(12) << "entries"
+       << setw(10) << "scan ms" << setw(10) << "MB/s" << setw(11) << "parse ms"
+       << setw(10) << "MB/s" << endl;
+
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    string text = make_file(sizes[i]);
+    double megabytes = text.size() / 1024.0 / 1024.0;
+
+    for (int kind = Scanner::SCALAR; kind <= Scanner::get_best(); ++kind) {
+      Scanner::set_default((Scanner::Kind) kind);
+
+      clock_t start = clock();
+      size_t entries = scan_all(text);
+      double scan_ms = elapsed(start);
+
+      start = clock();
+      Cell* tree = parse(text);
+      double parse_ms = elapsed(start);
+
+      if (nullp(tree)) {
+	return 1;
+      }
+      cout << setw(6) << sizes[i] << setw(8) << Scanner::get_name((Scanner::Kind) kind)
+	   << setw(12) << entries << fixed << setprecision(1)
+	   << setw(10) << scan_ms << setw(10) << megabytes / (scan_ms / 1000.0)
+	   << setw(11) << parse_ms << setw(10) << megabytes / (parse_ms / 1000.0) << endl;
+
+      tree = nil;
+      GarbageCollector::Instance()->collect();
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,75 @@
+/**
+ * \file bytecode.cpp
+ *
+ * Implementation of the CodeCell
+ */
+
+#include "bytecode.hpp"
+#include "cons.hpp"
+
+using namespace std;
+
+#define OPCODE_NAME(op) #op,
+
+/// names for disassemble(), in the order of the enum
+static const char* const opcode_names[] = {
+  OPCODES(OPCODE_NAME)
+};
+
+#undef OPCODE_NAME
+
+CodeCell::CodeCell()
+  : compiled_m(true), formals_m(nil), body_m(nil), num_param_m(0) {}
+
+CodeCell::CodeCell(Cell* const formals, Cell* const body)
+  : compiled_m(false), formals_m(formals), body_m(body) {
+  if (!listp(formals)) {
+    /// Indicates variable number of arguments
+    num_param_m = -1;
+  }
+  else {
+    num_param_m = ConsCell::get_list_size(formals);
+  }
+}
+
+void CodeCell::trace(vector<Cell*>& children) const {
+  children.push_back(formals_m);
+  children.push_back(body_m);
+
+  for (vector<Instruction>::const_iterator i = code_m.begin(); i != code_m.end(); ++i) {
+    if ((*i).cell != NULL) {
+      children.push_back((*i).cell);
+    }
+  }
+}
+
+bool CodeCell::is_compiled() const {
+  return compiled_m;
+}
+
+Cell* CodeCell::get_formals() const throw (runtime_error) {
+  return formals_m;
+}
+
+Cell* CodeCell::get_body() const throw (runtime_error) {
+  return body_m;
+}
+
+int CodeCell::get_num_param() const {
+  return num_param_m;
+}
+
+void CodeCell::disassemble(ostream& os) const {
+  for (size_t i = 0; i < code_m.size(); ++i) {
+    os << i << "\t" << opcode_names[code_m[i].op] << "\t" << code_m[i].n;
+    if (code_m[i].cell != NULL) {
+      os << "\t";
+      print_cell(os, code_m[i].cell);
+    }
+    os << endl;
+  }
+}
+
+void CodeCell::print(ostream& os) const {
+  os << "#<code>";
+}
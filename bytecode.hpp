@@ -0,0 +1,233 @@
+/**
+ * \file bytecode.hpp
+ *
+ * Instruction set of the VirtualMachine and CodeCell, the container of
+ * compiled code. The Compiler translates s-expressions into this
+ * instruction set.
+ */
+
+#ifndef BYTECODE_HPP
+#define BYTECODE_HPP
+
+#include <vector>
+#include <iostream>
+
+#include "Cell.hpp"
+
+/**
+ * The opcodes, as X-macro so the dispatch table of the VirtualMachine
+ * can be generated in the same order. Operands are given as n (an int)
+ * and cell. Jump targets are indexes into the code.
+ *
+ * The machine is stack based. Every expression pushes exactly one
+ * value. Variables are scoped dynamically, so they are not compiled to
+ * stack slots but looked up in their SymbolCell (see DefinitionManager).
+ */
+#define OPCODES(X)							\
+  /* push cell */							\
+  X(OP_CONST)								\
+  /* push the definition of the symbol cell */				\
+  X(OP_REF)								\
+  X(OP_POP)								\
+  /* continue at n */							\
+  X(OP_JUMP)								\
+  /* pop, continue at n if the value is false in the sense of if */	\
+  X(OP_JUMP_FALSE)							\
+  /* continue at n if the builtin symbol cell has been defined as */	\
+  /* procedure, since definitions take precedence over builtins */	\
+  X(OP_GUARD)								\
+  /* start a nested evaluation, its OP_RETURN continues at n */	\
+  X(OP_ENTER)								\
+  /* end the evaluation and leave its stack frame */			\
+  X(OP_RETURN)								\
+  /* call of the procedure defined as symbol cell with n arguments. */ \
+  /* Starts the activation, followed by OP_ARGS */			\
+  X(OP_PREPARE)								\
+  /* like OP_PREPARE, but pops the procedure */			\
+  X(OP_PREPARE_DYNAMIC)							\
+  /* operand of the preceding instruction: unevaluated arguments in */ \
+  /* cell, continue at n if they were applied right away */		\
+  X(OP_ARGS)								\
+  /* pop, define the nth parameter of the procedure below */		\
+  X(OP_BIND)								\
+  /* pop the procedure and continue in its body */			\
+  X(OP_TAIL_CALL)							\
+  /* throw, the operator is neither a list nor a symbol */		\
+  X(OP_NO_OPERATOR)							\
+  /* start an activation for the definitions of let */		\
+  X(OP_LET)								\
+  /* pop, define symbol cell. Push nil if n */				\
+  X(OP_DEFINE)								\
+  /* push a new procedure sharing the code cell */			\
+  X(OP_LAMBDA)								\
+  /* evaluate the result of a procedure with variable number of */	\
+  /* arguments once more, if it is not nil */				\
+  X(OP_EVAL_AGAIN)							\
+  /* push the result of applying cell to the unevaluated arguments */ \
+  /* of the following OP_ARGS */					\
+  X(OP_APPLY_RAW)							\
+  /* builtins with evaluated arguments */				\
+  X(OP_CAR)								\
+  X(OP_CDR)								\
+  X(OP_CONS)								\
+  X(OP_INTP)								\
+  X(OP_DOUBLEP)								\
+  X(OP_SYMBOLP)								\
+  X(OP_NULLP)								\
+  X(OP_LISTP)								\
+  X(OP_NOT)								\
+  /* pops 2n - 1 values: the first argument, followed by the pairs */ \
+  /* of the n arguments to compare */					\
+  X(OP_LESS)								\
+  /* calculate with the ArithmeticCell cell, pops 2 (or 1) */		\
+  X(OP_ARITH)								\
+  X(OP_ARITH1)								\
+  /* calculate with the ArithmeticCell cell, pops n >= 3 */		\
+  X(OP_ARITH_N)								\
+  X(OP_PRINT)								\
+  X(OP_EVAL)								\
+  X(OP_APPLY)								\
+  X(OP_RAND)								\
+  X(OP_STR)								\
+  X(OP_SUBSTR)								\
+  X(OP_APPSTR)								\
+  X(OP_PARSE)								\
+  X(OP_PARSE_EVAL)							\
+  X(OP_CEILING)								\
+  X(OP_FLOOR)								\
+  X(OP_GC_GROWTH)							\
+  /* pops n (1 or 2) */							\
+  X(OP_MAKE_VECTOR)							\
+  X(OP_VECTOR_REF)							\
+  X(OP_VECTOR_SET)							\
+  X(OP_VECTOR_LENGTH)							\
+  X(OP_VECTORP)								\
+  X(OP_STRING_LENGTH)							\
+  X(OP_STRING_REF)							\
+  X(OP_STRING_SET)							\
+  X(OP_STRING_APPEND)							\
+  X(OP_STRINGP)								\
+  /* pops n (1 or 2) */							\
+  X(OP_MAKE_STRING)							\
+  X(OP_SUBSTRING)							\
+  X(OP_STRING_TO_SYMBOL)						\
+  X(OP_SYMBOL_TO_STRING)						\
+  X(OP_EQ)								\
+  X(OP_EQUAL)								\
+  X(OP_HASH_TABLE_REF)							\
+  X(OP_HASH_TABLE_SET)							\
+  X(OP_HASH_TABLE_DELETE)						\
+  X(OP_HASH_TABLE_CONTAINS)						\
+  X(OP_HASH_TABLE_COUNT)						\
+  /* pops n (0 or 1), pushes the new table */				\
+  X(OP_MAKE_HASH_TABLE)							\
+  X(OP_HASH_TABLE_KEYS)							\
+  X(OP_HASH_TABLE_VALUES)						\
+  X(OP_HASH_TABLE_TO_ALIST)						\
+  X(OP_HASH_TABLE_WALK)							\
+  X(OP_HASH_TABLEP)							\
+  X(OP_LENGTH)								\
+  X(OP_APPEND)								\
+  X(OP_REVERSE)								\
+  X(OP_ASSOC)								\
+  X(OP_LIST_TAIL)							\
+  X(OP_LIST_REF)							\
+  X(OP_LIST_SORT)
+
+#define OPCODE_ENUM(op) op,
+
+enum Opcode {
+  OPCODES(OPCODE_ENUM)
+  NO_OPCODES
+};
+
+#undef OPCODE_ENUM
+
+/**
+ * \struct Instruction
+ *
+ * \brief A single instruction with its operands
+ */
+struct Instruction {
+  Opcode op;
+  int    n;
+  Cell*  cell;
+};
+
+/**
+ * \class CodeCell
+ *
+ * \brief Compiled code of an expression or of the body of a procedure.
+ *        Is a cell, so the GarbageCollector frees it together with the
+ *        procedures sharing it, and keeps the cells used as operands
+ *        alive.
+ *
+ * The body of a procedure is compiled when it is called for the first
+ * time (see ProcedureCell::get_code()). Every procedure created by the
+ * same lambda expression shares the same CodeCell.
+ */
+class CodeCell : public Cell {
+  friend class Compiler;
+  friend class VirtualMachine;
+
+public:
+  /**
+   * \brief Constructor for the code of an expression. Remarks: use
+   *        Compiler::compile()
+   */
+  CodeCell();
+
+  /**
+   * \brief Constructor for the code of a procedure, which is compiled
+   *        later on
+   */
+  CodeCell(Cell* const formals, Cell* const body);
+
+  /**
+   * \brief Keeps formals, body and all operands alive
+   */
+  virtual void trace(std::vector<Cell*>& children) const;
+
+  /**
+   * \brief Checks if the procedure has been compiled yet
+   */
+  bool is_compiled() const;
+
+  /**
+   * \brief Accessor for ProcedureCell
+   */
+  virtual Cell* get_formals() const throw (std::runtime_error);
+
+  /**
+   * \brief Accessor for ProcedureCell
+   */
+  virtual Cell* get_body() const throw (std::runtime_error);
+
+  /**
+   * \brief Number of parameters, -1 indicates variable number of
+   *        arguments
+   */
+  int get_num_param() const;
+
+  /**
+   * \brief Prints the instructions, one per line. Useful for debugging
+   *        the Compiler
+   */
+  void disassemble(std::ostream& os = std::cout) const;
+
+  /**
+   * \brief Code is never a value, but has to be printable as a cell
+   */
+  virtual void print(std::ostream& os = std::cout) const;
+
+private:
+  std::vector<Instruction> code_m;
+  bool compiled_m;
+
+  Cell* formals_m;                           ///< nil for expressions
+  Cell* body_m;                              ///< nil for expressions
+  int num_param_m;
+  std::vector<const SymbolCell*> params_m;   ///< interned formals
+};
+
+#endif // BYTECODE_HPP
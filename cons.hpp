@@ -10,6 +10,8 @@
 #define CONS_HPP
 
 #include "Cell.hpp"
+#include "SymbolManager.hpp"
+#include <cstring>
 #include <string>
 #include <iostream>
 
@@ -19,12 +21,12 @@
 extern Cell* const nil;
 
 /**
- * \brief Make an int cell.
+ * \brief Make an int cell. Ints are immediate, nothing is allocated.
  * \param i The initial int value to be stored in the new cell.
  */
 inline Cell* make_int(const int i)
 {
-  return (Cell*) new IntCell(i);
+  return encode_fixnum(i);
 }
 
 /**
@@ -37,12 +39,45 @@ inline Cell* make_double(const double d)
 }
 
 /**
- * \brief Make a symbol cell.
+ * \brief Make an integer cell: an int if i fits into one (nothing is
+ *        allocated), a bigint cell otherwise.
+ * \param i The initial integer value to be stored in the new cell.
+ */
+inline Cell* make_integer(const BigInt& i)
+{
+  if (i.fits_int()) {
+    return encode_fixnum(i.to_int());
+  }
+  return (Cell*) new BigIntCell(i);
+}
+
+/**
+ * \brief Make a symbol cell. Symbols are interned, so the same name
+ *        always gives the same cell.
  * \param s The initial symbol name to be stored in the new cell.
  */
 inline Cell* make_symbol(const char* const s)
 {  
-  return (Cell*) new SymbolCell(s);
+  return (Cell*) SymbolManager::Instance()->intern(s, strlen(s));
+}
+
+/**
+ * \brief Make a symbol cell, see make_symbol(const char* const).
+ * \param s The name, which need not be terminated.
+ * \param length The number of characters of the name.
+ */
+inline Cell* make_symbol(const char* const s, size_t length)
+{
+  return (Cell*) SymbolManager::Instance()->intern(s, length);
+}
+
+/**
+ * \brief Make a symbol cell, see make_symbol(const char* const).
+ * \param s The initial symbol name to be stored in the new cell.
+ */
+inline Cell* make_symbol(const std::string& s)
+{
+  return (Cell*) SymbolManager::Instance()->intern(s);
 }
 
 /**
@@ -65,13 +100,61 @@ inline Cell* lambda(Cell* const my_args, Cell* const my_body)
   return (Cell*) new ProcedureCell(my_args, my_body);
 }
 
+/**
+ * \brief Make a vector cell.
+ * \param size The number of elements.
+ * \param fill The initial value of every element.
+ */
+inline Cell* make_vector(const int size, Cell* const fill)
+{
+  return (Cell*) new VectorCell(size, fill);
+}
+
+/**
+ * \brief Make a vector cell with the elements of a proper list.
+ * \param list The list of the elements.
+ */
+inline Cell* list_to_vector(Cell* const list)
+{
+  return (Cell*) new VectorCell(list);
+}
+
+/**
+ * \brief Make a string cell.
+ * \param s The characters, which are copied. They need not be terminated.
+ * \param length The number of characters.
+ */
+inline Cell* make_string(const char* const s, size_t length)
+{
+  return (Cell*) new StringCell(s, length);
+}
+
+/**
+ * \brief Make a string cell, see make_string(const char* const, size_t).
+ * \param s The initial characters.
+ */
+inline Cell* make_string(const std::string& s)
+{
+  return (Cell*) new StringCell(s.data(), s.size());
+}
+
+/**
+ * \brief Make an empty hash table cell.
+ * \param structural True if the keys are compared with equal?, false for
+ * eq?.
+ */
+inline Cell* make_hash_table(const bool structural)
+{
+  return (Cell*) new HashTableCell(structural);
+}
+
 /**
  * \brief Check if c points to an empty list, i.e., is a null pointer.
  * \return True iff c points to an empty list, i.e., is a null pointer.
  */
 inline bool nullp(Cell* const c)
 {
-  return (c == nil);
+  return ((size_t) c == NIL_BITS);
 }
 
 /**
@@ -80,7 +163,7 @@ inline bool nullp(Cell* const c)
  */
 inline bool listp(Cell* const c)
 {
-  return nullp(c) || c->is_cons();
+  return nullp(c) || (!is_immediate(c) && c->is_cons());
 }
 
 /**
@@ -89,7 +172,18 @@ inline bool listp(Cell* const c)
  */
 inline bool intp(Cell* const c)
 {
-  return !nullp(c) && c->is_int();
+  /// symbols ask their definition, that is the only virtual call left
+  return is_fixnum(c) || (!is_immediate(c) && c->is_int());
+}
+
+/**
+ * \brief Check if c points to a bigint cell, an integer which does not
+ * fit into an int. Remarks: intp() is true for bigint cells as well.
+ * \return True iff c points to a bigint cell.
+ */
+inline bool bignump(Cell* const c)
+{
+  return !is_immediate(c) && c->is_bigint();
 }
 
 /**
@@ -98,7 +192,7 @@ inline bool intp(Cell* const c)
  */
 inline bool doublep(Cell* const c)
 {
-  return !nullp(c) && c->is_double();
+  return !is_immediate(c) && c->is_double();
 }
 
 /**
@@ -107,7 +201,34 @@ inline bool doublep(Cell* const c)
  */
 inline bool symbolp(Cell* const c)
 {
-  return !nullp(c) && c->is_symbol();
+  return !is_immediate(c) && c->is_symbol();
+}
+
+/**
+ * \brief Check if c points to a vector cell.
+ * \return True iff c points to a vector cell.
+ */
+inline bool vectorp(Cell* const c)
+{
+  return !is_immediate(c) && c->is_vector();
+}
+
+/**
+ * \brief Check if c points to a string cell.
+ * \return True iff c points to a string cell.
+ */
+inline bool stringp(Cell* const c)
+{
+  return !is_immediate(c) && c->is_string();
+}
+
+/**
+ * \brief Check if c points to a hash table cell.
+ * \return True iff c points to a hash table cell.
+ */
+inline bool hash_tablep(Cell* const c)
+{
+  return !is_immediate(c) && c->is_hash_table();
 }
 
 /**
@@ -116,7 +237,10 @@ inline bool symbolp(Cell* const c)
  */
 inline int get_int(Cell* const c)
 {
-  return c->get_int();
+  if (is_fixnum(c)) {
+    return decode_fixnum(c);
+  }
+  return object_of(c)->get_int();
 }
 
 /**
@@ -125,7 +249,31 @@ inline int get_int(Cell* const c)
  */
 inline double get_double(Cell* const c)
 {
-  return c->get_double();
+  return object_of(c)->get_double();
+}
+
+/**
+ * \brief Accessor (error if c is neither an int nor a double cell).
+ * \return The value of c as double.
+ */
+inline double get_numeral(Cell* const c)
+{
+  if (is_fixnum(c)) {
+    return decode_fixnum(c);
+  }
+  return object_of(c)->get_numeral();
+}
+
+/**
+ * \brief Accessor (error if c is neither an int nor a bigint cell).
+ * \return The value of c as BigInt.
+ */
+inline BigInt get_bigint(Cell* const c)
+{
+  if (is_fixnum(c)) {
+    return BigInt(decode_fixnum(c));
+  }
+  return object_of(c)->get_bigint();
 }
 
 /**
@@ -133,9 +281,19 @@ inline double get_double(Cell* const c)
  * symbol cell).
  * \return The symbol name in the symbol cell pointed to by c.
  */
-inline std::string get_symbol(Cell* const c)
+inline const std::string& get_symbol(Cell* const c)
+{
+  return object_of(c)->get_symbol();
+}
+
+/**
+ * \brief Accessor (error if c is not a symbol cell).
+ * \return The interned symbol cell of c. Symbols with the same name
+ * have the same interned symbol cell.
+ */
+inline const SymbolCell* get_interned(Cell* const c)
 {
-  return c->get_symbol();
+  return object_of(c)->get_interned();
 }
 
 /**
@@ -144,7 +302,7 @@ inline std::string get_symbol(Cell* const c)
  */
 inline Cell* car(Cell* const c)
 {
-  return c->get_car();
+  return object_of(c)->get_car();
 }
 
 /**
@@ -153,7 +311,53 @@ inline Cell* car(Cell* const c)
  */
 inline Cell* cdr(Cell* const c)
 {
-  return c->get_cdr();
+  return object_of(c)->get_cdr();
+}
+
+/**
+ * \brief Accessor (error if c is not a vector cell or i is out of range).
+ * \return The ith element of the vector cell pointed to by c.
+ */
+inline Cell* vector_ref(Cell* const c, const int i)
+{
+  return object_of(c)->get_element(i);
+}
+
+/**
+ * \brief Modifier (error if c is not a vector cell or i is out of range).
+ * Stores value as the ith element of the vector cell pointed to by c.
+ */
+inline void vector_set(Cell* const c, const int i, Cell* const value)
+{
+  object_of(c)->set_element(i, value);
+}
+
+/**
+ * \brief Accessor (error if c is not a vector cell).
+ * \return The number of elements of the vector cell pointed to by c.
+ */
+inline int vector_length(Cell* const c)
+{
+  return object_of(c)->get_vector_length();
+}
+
+/**
+ * \brief Accessor (error if c is not a string cell).
+ * \return The string cell pointed to by c, whose characters can be read
+ * and changed.
+ */
+inline StringCell* get_string(Cell* const c)
+{
+  return object_of(c)->get_string();
+}
+
+/**
+ * \brief Accessor (error if c is not a hash table cell).
+ * \return The hash table cell pointed to by c.
+ */
+inline HashTableCell* get_hash_table(Cell* const c)
+{
+  return object_of(c)->get_hash_table();
 }
 
 /**
@@ -163,7 +367,7 @@ inline Cell* cdr(Cell* const c)
  */
 inline Cell* get_formals(Cell* const c)
 {
-  return c->get_formals();
+  return object_of(c)->get_formals();
 }
 
 /**
@@ -173,11 +377,27 @@ inline Cell* get_formals(Cell* const c)
  */
 inline Cell* get_body(Cell* const c)
 {
-  return c->get_body();
+  return object_of(c)->get_body();
+}
+
+/**
+ * \brief Print the subtree rooted at c, in s-expression notation. Works
+ *        for immediate cells as well.
+ * \param os The output stream to print to.
+ * \param c The root cell of the subtree to be printed.
+ */
+inline void print_cell(std::ostream& os, const Cell* const c)
+{
+  if (is_fixnum(c)) {
+    os << decode_fixnum(c);
+    return;
+  }
+  object_of(c)->print(os);
 }
 
 /**
  * \brief Print the subtree rooted at c, in s-expression notation.
+ *        Remarks: c must not be immediate, use print_cell() otherwise
  * \param os The output stream to print to.
  * \param c The root cell of the subtree to be printed.
  */
@@ -1,75 +1,53 @@
 /**
  * \file eval.cpp
  *
- * Evaluates the s-expression. Recursive approach. Each death level returns
- * its result as a cell to the upper level.
+ * Evaluates the s-expression. Atoms are resolved right away, lists are
+ * compiled by the Compiler and executed by the VirtualMachine, which
+ * evaluates expressions in tail position without recursion (proper tail
+ * calls).
  */
 
 #include "eval.hpp"
-#include "DefinitionManager.hpp"
+#include "FunctionManager.hpp"
+#include "Compiler.hpp"
+#include "VirtualMachine.hpp"
 
 #include <stdexcept>
 
-Cell* eval(Cell* const c) {
-
-  /// just returns Cell if deepest level reached
-  /// this approach gets rid of loads of if-then checks
-  if (!listp(c)) {
-    if (symbolp(c)) {
-      string sym = get_symbol(c);
+/**
+ * \brief Evaluates an atom: symbols are resolved, everything else
+ *        evaluates to itself
+ */
+static Cell* eval_atom(Cell* const c) {
+  if (symbolp(c)) {
+    /// builtins are resolved to their shared FunctionCell or
+    /// ArithmeticCell
+    const SymbolCell* builtin = FunctionManager::Instance()->get_builtin(get_interned(c));
 
-      if (FunctionCell::is_function(sym)) {
-	return new FunctionCell(sym.c_str());
-      }
-      
-      if (ArithmeticCell::is_arithmetic(sym)) {
-	return new ArithmeticCell(sym.c_str());
-      }
-      
-      return c->get_definition();
+    if (builtin != NULL) {
+      return (Cell*) builtin;
     }
-    return c;
+      
+    return c->get_definition();
   }
+  return c;
+}
 
-  Cell* func = eval_function(car(c));
-  Cell* args = cdr(c);
+Cell* eval(Cell* const c) {
+  /// just returns Cell if deepest level reached
+  if (!listp(c)) {
+    return eval_atom(c);
+  }
 
-  
 #ifdef L_DEBUG
-  cout << "func: " << *func << endl;
-  cout << "  args: " << *args << endl;
+  cout << "eval: "; print_cell(cout, c); cout << endl;
 #endif
 
+  CodeCell* code = Compiler::Instance()->compile(c);
 
-  /// The right operation/ function will be called through overwriting
-  return func->apply(args);
-
-}
-
-Cell* eval_function(Cell* const c) {
-  if (listp(c)) {
-    /// in case for nested cases such as ((quote if) 1 0)
-    return eval(c);
-  }
-
-  if (symbolp(c)) {
-    string sym = get_symbol(c);
-
-    /// checks wether it is a user-defined function or a built in function
-    if (DefinitionManager::Instance()->is_definition(sym)) {
-      if (c->get_definition()->is_lambda()) {
-	return c->get_definition();
-      }
-    }
-    
-    if (FunctionCell::is_function(sym)) {
-      return new FunctionCell(sym.c_str());
-    }
-    
-    if (ArithmeticCell::is_arithmetic(sym)) {
-      return new ArithmeticCell(sym.c_str());
-    }
-  }
+#ifdef L_DEBUG
+  code->disassemble(cout);
+#endif
 
-  throw runtime_error("No operator/ function in front");   
+  return VirtualMachine::Instance()->execute(code, false);
 }
@@ -19,10 +19,4 @@ using namespace std;
  */
 Cell* eval(Cell* const c);
 
-/**
- * \brief Eval function just for the first element - or in other words for 
- *        cells which can call functions
- */
-Cell* eval_function(Cell* const c);
-
 #endif // EVAL_HPP
@@ -0,0 +1,501 @@
+/**
+ * \file fasl.cpp
+ *
+ * Implementation of the fasl.hpp interface.
+ *
+ * The writer makes two passes over the tree: the first one finds the
+ * cells which are reached more than once (by the mark bits of the
+ * GarbageCollector, only shared cells are put into a table) and collects
+ * the symbols, the second one writes the objects. Both keep their own
+ * stack, long lists and deep nesting do not recurse.
+ */
+
+#include "fasl.hpp"
+#include "hashtablemap.hpp"
+#include "GarbageCollector.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+typedef unsigned long long word;
+
+/// label of a shared cell which has not been written yet
+static const word NO_LABEL = ~(word) 0;
+
+/// increase whenever the layout changes
+static const unsigned char FASL_VERSION = 2;
+static const char FASL_MAGIC[] = "FASL";
+
+enum Tag {
+  TAG_NIL,
+  TAG_INT,
+  TAG_DOUBLE,
+  TAG_BIGINT,
+  TAG_SYMBOL,
+  TAG_LIST,
+  TAG_LABEL,
+  TAG_REF,
+  TAG_STRING
+};
+
+/**
+ * \struct cell_hash
+ *
+ * \brief Hash of the address of a cell, cells are at least 8 byte aligned
+ */
+struct cell_hash {
+  size_t operator()(Cell* const c) const {
+    return hash_key((unsigned long) ((size_t) c >> 3));
+  }
+};
+
+static void put_varint(string& out, word w) {
+  while (w >= 0x80) {
+    out += (char) ((w & 0x7f) | 0x80);
+    w >>= 7;
+  }
+  out += (char) w;
+}
+
+static void put_tag(string& out, Tag tag) {
+  out += (char) tag;
+}
+
+
+//////////////////////////////////////////
+// FaslWriter
+
+/**
+ * \class FaslWriter
+ *
+ * \brief Writes the fasl of one tree
+ */
+class FaslWriter {
+public:
+  FaslWriter() : no_labels_m(0) {}
+
+  void write(Cell* root, string& out) throw (runtime_error);
+
+private:
+  /// labels of the cells which are reached more than once
+  hashtablemap<Cell*, word, cell_hash> shared_m;
+  word no_labels_m;
+  hashtablemap<const SymbolCell*, word> symbols_m;
+  vector<const SymbolCell*> names_m;
+
+  /**
+   * \brief First pass
+   */
+  void count(Cell* root) throw (runtime_error);
+
+  /**
+   * \brief Second pass
+   */
+  void emit(Cell* root, string& out);
+
+  bool is_shared(Cell* c) {
+    return shared_m.find(c) != shared_m.end();
+  }
+};
+
+void FaslWriter::write(Cell* root, string& out) throw (runtime_error) {
+  try {
+    count(root);
+  } catch (runtime_error&) {
+    GarbageCollector::Instance()->clear_visits();
+    throw;
+  }
+  GarbageCollector::Instance()->clear_visits();
+
+  out.append(FASL_MAGIC, sizeof(FASL_MAGIC) - 1);
+  out += (char) FASL_VERSION;
+  put_varint(out, names_m.size());
+  for (size_t i = 0; i < names_m.size(); ++i) {
+    const string& name = names_m[i]->get_symbol();
+    put_varint(out, name.size());
+    out += name;
+  }
+
+  emit(root, out);
+}
+
+void FaslWriter::count(Cell* root) throw (runtime_error) {
+  vector<Cell*> stack(1, root);
+
+  while (!stack.empty()) {
+    Cell* c = stack.back();
+    stack.pop_back();
+
+    /// follow the spine of a list right here, only the elements wait
+    /// on the stack
+    while (!is_immediate(c)) {
+      bool is_cons = c->is_cons();
+      if (!is_cons && c->is_symbol()) {
+	/// builtins are written by their name, like every other symbol
+	const SymbolCell* interned = get_interned(c);
+	if (symbols_m.find(interned) == symbols_m.end()) {
+	  symbols_m[interned] = names_m.size();
+	  names_m.push_back(interned);
+	}
+	break;
+      }
+      if (!is_cons && !c->is_double() && !c->is_bigint() && !c->is_string()) {
+	throw runtime_error("write-fasl: only lists, numbers, symbols and strings can be written");
+      }
+      if (!GarbageCollector::Instance()->visit(c)) {
+	shared_m[c] = NO_LABEL;
+	break;
+      }
+      if (!is_cons) {
+	break;
+      }
+      stack.push_back(car(c));
+      c = cdr(c);
+    }
+  }
+}
+
+void FaslWriter::emit(Cell* root, string& out) {
+  vector<Cell*> stack(1, root);
+
+  while (!stack.empty()) {
+    Cell* c = stack.back();
+    stack.pop_back();
+
+    if (nullp(c)) {
+      put_tag(out, TAG_NIL);
+      continue;
+    }
+    if (is_fixnum(c)) {
+      long long value = decode_fixnum(c);
+      put_tag(out, TAG_INT);
+      put_varint(out, ((word) value << 1) ^ (word) (value >> 63));
+      continue;
+    }
+    bool is_cons = c->is_cons();
+    if (!is_cons && c->is_symbol()) {
+      put_tag(out, TAG_SYMBOL);
+      put_varint(out, symbols_m[get_interned(c)]);
+      continue;
+    }
+
+    hashtablemap<Cell*, word, cell_hash>::iterator shared = shared_m.find(c);
+    if (shared != shared_m.end()) {
+      word& label = (*shared).second;
+      if (label != NO_LABEL) {
+	put_tag(out, TAG_REF);
+	put_varint(out, label);
+	continue;
+      }
+      label = no_labels_m++;
+      put_tag(out, TAG_LABEL);
+    }
+
+    if (is_cons) {
+      /// the list ends before a shared cons, which becomes its tail
+      size_t first = stack.size();
+      word length = 0;
+      Cell* rest = c;
+      do {
+	stack.push_back(car(rest));
+	rest = cdr(rest);
+	++length;
+      } while (!is_immediate(rest) && rest->is_cons() && !is_shared(rest));
+
+      /// the tail is written after the elements
+      stack.push_back(rest);
+      reverse(stack.begin() + first, stack.end());
+
+      put_tag(out, TAG_LIST);
+      put_varint(out, length);
+    } else if (c->is_double()) {
+      double d = get_double(c);
+      word bits;
+      memcpy(&bits, &d, sizeof(bits));
+      put_tag(out, TAG_DOUBLE);
+      for (int i = 0; i < 8; ++i) {
+	out += (char) (bits >> (8 * i));
+      }
+    } else if (c->is_string()) {
+      string text = get_string(c)->to_string();
+      put_tag(out, TAG_STRING);
+      put_varint(out, text.size());
+      out += text;
+    } else {
+      string digits = get_bigint(c).to_string();
+      put_tag(out, TAG_BIGINT);
+      put_varint(out, digits.size());
+      out += digits;
+    }
+  }
+}
+
+
+//////////////////////////////////////////
+// FaslReader
+
+/**
+ * \class FaslReader
+ *
+ * \brief Builds the tree of a fasl. Lists are allocated as soon as their
+ *        length is known and filled front to back (friend of ConsCell).
+ *        Everything under construction is reachable from a root cell on
+ *        the C++ stack, like in the Reader of parse.hpp.
+ */
+class FaslReader {
+public:
+  FaslReader(const char* begin, const char* end)
+    : pos_m((const unsigned char*) begin), end_m((const unsigned char*) end) {}
+
+  Cell* read() throw (runtime_error);
+
+private:
+  /**
+   * \struct Level
+   *
+   * \brief A list whose elements are being read
+   */
+  struct Level {
+    ConsCell* current_m;     ///< its car is read now
+    word      remaining_m;   ///< elements after the current one
+  };
+
+  const unsigned char* pos_m;
+  const unsigned char* end_m;
+  vector<Cell*>        symbols_m;
+  vector<Cell*>        labels_m;
+
+  static void broken() throw (runtime_error) {
+    throw runtime_error("read-fasl: broken data");
+  }
+
+  unsigned char get_byte() throw (runtime_error) {
+    if (pos_m == end_m) {
+      broken();
+    }
+    return *pos_m++;
+  }
+
+  word get_varint() throw (runtime_error);
+
+  string get_string() throw (runtime_error);
+};
+
+word FaslReader::get_varint() throw (runtime_error) {
+  word w = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    unsigned char byte = get_byte();
+    w |= (word) (byte & 0x7f) << shift;
+    if (byte < 0x80) {
+      return w;
+    }
+  }
+  broken();
+  return 0;
+}
+
+string FaslReader::get_string() throw (runtime_error) {
+  word length = get_varint();
+  if (length > (word) (end_m - pos_m)) {
+    broken();
+  }
+  string s((const char*) pos_m, (size_t) length);
+  pos_m += length;
+  return s;
+}
+
+Cell* FaslReader::read() throw (runtime_error) {
+  size_t magic = sizeof(FASL_MAGIC) - 1;
+  if ((size_t) (end_m - pos_m) < magic + 1 || memcmp(pos_m, FASL_MAGIC, magic) != 0
+      || pos_m[magic] != FASL_VERSION) {
+    throw runtime_error("read-fasl: not a fasl");
+  }
+  pos_m += magic + 1;
+
+  /// the car of root is the tree, its cdr keeps the symbols alive until
+  /// the tree refers to them
+  ConsCell* root = (ConsCell*) cons(nil, nil);
+  Cell* symbols = nil;
+  word no_symbols = get_varint();
+  if (no_symbols > (word) (end_m - pos_m)) {
+    broken();
+  }
+  for (word i = 0; i < no_symbols; ++i) {
+    Cell* symbol = make_symbol(get_string());
+    symbols = cons(symbol, symbols);
+    symbols_m.push_back(symbol);
+  }
+  root->cdr = symbols;
+
+  vector<Level> levels;
+  Cell** slot = &root->car;
+  bool labeled = false;
+
+  for (;;) {
+    Tag tag = (Tag) get_byte();
+    Cell* c;
+    word index;
+
+    switch (tag) {
+    case TAG_NIL:
+      c = nil;
+      break;
+    case TAG_INT: {
+      word zigzag = get_varint();
+      long long value = (long long) (zigzag >> 1) ^ -(long long) (zigzag & 1);
+      if (value < INT_MIN || value > INT_MAX) {
+	broken();
+      }
+      c = make_int((int) value);
+      break;
+    }
+    case TAG_DOUBLE: {
+      word bits = 0;
+      for (int i = 0; i < 8; ++i) {
+	bits |= (word) get_byte() << (8 * i);
+      }
+      double d;
+      memcpy(&d, &bits, sizeof(d));
+      c = make_double(d);
+      break;
+    }
+    case TAG_BIGINT:
+      try {
+	c = make_integer(BigInt(get_string()));
+      } catch (runtime_error&) {
+	broken();
+      }
+      break;
+    case TAG_SYMBOL:
+      index = get_varint();
+      if (index >= symbols_m.size()) {
+	broken();
+      }
+      c = symbols_m[index];
+      break;
+    case TAG_STRING:
+      c = make_string(get_string());
+      break;
+    case TAG_REF:
+      index = get_varint();
+      if (labeled || index >= labels_m.size()) {
+	broken();
+      }
+      c = labels_m[index];
+      break;
+    case TAG_LABEL:
+      if (labeled) {
+	broken();
+      }
+      labeled = true;
+      continue;
+    case TAG_LIST: {
+      word length = get_varint();
+      /// every element takes one byte at least
+      if (length == 0 || length > (word) (end_m - pos_m)) {
+	broken();
+      }
+      ConsCell* first = (ConsCell*) cons(nil, nil);
+      *slot = first;
+      ConsCell* last = first;
+      for (word i = 1; i < length; ++i) {
+	ConsCell* next = (ConsCell*) cons(nil, nil);
+	last->cdr = next;
+	last = next;
+      }
+      if (labeled) {
+	labels_m.push_back(first);
+	labeled = false;
+      }
+      Level level = { first, length - 1 };
+      levels.push_back(level);
+      slot = &first->car;
+      continue;
+    }
+    default:
+      broken();
+    }
+
+    if (labeled) {
+      // only cells may be labeled
+      if (tag == TAG_NIL || tag == TAG_INT || tag == TAG_SYMBOL) {
+	broken();
+      }
+      labels_m.push_back(c);
+      labeled = false;
+    }
+    *slot = c;
+
+    /// the next slot is the car of the next element, or the tail of the
+    /// list after its last element
+    for (;;) {
+      if (levels.empty()) {
+	if (pos_m != end_m) {
+	  broken();
+	}
+	return root->car;
+      }
+      Level& level = levels.back();
+      if (level.current_m == NULL) {
+	// the tail has been read
+	levels.pop_back();
+	continue;
+      }
+      if (level.remaining_m > 0) {
+	level.current_m = (ConsCell*) level.current_m->cdr;
+	--level.remaining_m;
+	slot = &level.current_m->car;
+      } else {
+	slot = &level.current_m->cdr;
+	level.current_m = NULL;
+      }
+      break;
+    }
+  }
+}
+
+
+//////////////////////////////////////////
+// Interface
+
+void write_fasl(Cell* c, string& out) throw (runtime_error) {
+  FaslWriter writer;
+  writer.write(c, out);
+}
+
+Cell* read_fasl(const char* begin, const char* end) throw (runtime_error) {
+  FaslReader reader(begin, end);
+  return reader.read();
+}
+
+void write_fasl_file(Cell* c, const string& path) throw (runtime_error) {
+  string out;
+  write_fasl(c, out);
+
+  ofstream file(path.c_str(), ios::out | ios::binary | ios::trunc);
+  file.write(out.data(), out.size());
+  file.close();
+  if (file.fail()) {
+    throw runtime_error("write-fasl: cannot write " + path);
+  }
+}
+
+Cell* read_fasl_file(const string& path) throw (runtime_error) {
+  ifstream file(path.c_str(), ios::in | ios::binary);
+  if (!file) {
+    throw runtime_error("read-fasl: cannot read " + path);
+  }
+  file.seekg(0, ios::end);
+  string content((size_t) file.tellg(), '\0');
+  file.seekg(0, ios::beg);
+  if (!content.empty()) {
+    file.read(&content[0], content.size());
+  }
+  if (file.fail()) {
+    throw runtime_error("read-fasl: cannot read " + path);
+  }
+  return read_fasl(content.data(), content.data() + content.size());
+}
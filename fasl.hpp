@@ -0,0 +1,68 @@
+/**
+ * \file fasl.hpp
+ *
+ * Encapsulates the interface for the binary fast-load format (fasl) of
+ * data: trees of cons cells, numbers, symbols and strings. Reading a fasl is much
+ * faster than parsing the printed form of the same tree.
+ *
+ * Layout, all counts and indices are unsigned LEB128 varints:
+ *
+ *     "FASL" version
+ *     number of symbols, then length and name of every symbol
+ *     one object
+ *
+ * An object is a tag byte followed by its content:
+ *
+ *     NIL
+ *     INT     zigzag encoded varint
+ *     DOUBLE  8 bytes, the bits of the double (little endian)
+ *     BIGINT  length and decimal digits
+ *     SYMBOL  index into the symbols
+ *     STRING  length and characters
+ *     LIST    n, then n elements, then the tail (NIL for a proper list)
+ *     LABEL   the next object is referred to later by its label, labels
+ *             are numbered in the order they appear
+ *     REF     label of an object read before
+ *
+ * Only cells which are referred to more than once get a label, so shared
+ * structure is written once and read back shared.
+ */
+
+#ifndef FASL_HPP
+#define FASL_HPP
+
+#include "cons.hpp"
+
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+/**
+ * \brief Appends the fasl of the tree rooted at c to out. Nothing is
+ *        allocated on the heap of cells.
+ * \throw runtime_error if the tree contains a procedure, a vector or a
+ *        hash table
+ */
+void write_fasl(Cell* c, string& out) throw (runtime_error);
+
+/**
+ * \brief Builds the tree stored in the fasl [begin, end). Neither lists
+ *        nor nesting recurse.
+ * \throw runtime_error if the fasl is broken
+ */
+Cell* read_fasl(const char* begin, const char* end) throw (runtime_error);
+
+/**
+ * \brief Writes the fasl of c to the file path
+ * \throw runtime_error if c cannot be written or the file not be written
+ */
+void write_fasl_file(Cell* c, const string& path) throw (runtime_error);
+
+/**
+ * \brief Reads the fasl in the file path with a single read
+ * \throw runtime_error if the file cannot be read or is broken
+ */
+Cell* read_fasl_file(const string& path) throw (runtime_error);
+
+#endif // FASL_HPP
@@ -9,8 +9,12 @@
 #include "cons.hpp"
 #include "eval.hpp"
 #include "parse.hpp"
+#include "fasl.hpp"
 
 #include "DefinitionManager.hpp"
+#include "FunctionManager.hpp"
+#include "GarbageCollector.hpp"
+#include "OutputManager.hpp"
 
 #include <cmath>
 #include <ctime>
@@ -32,6 +36,33 @@ Cell* single_argument_eval(const SymbolCell* func, Cell* args) throw (runtime_er
 
 }
 
+bool is_true(Cell* const c) {
+  /// a bigint is never zero. Strings are true like the symbols they
+  /// have been before
+  return symbolp(c) || bignump(c) || ( intp(c) && get_int(c) )
+    || ( doublep(c) && get_double(c) ) || stringp(c);
+}
+
+string text_of(Cell* const c) throw (runtime_error) {
+  if (stringp(c)) {
+    return get_string(c)->to_string();
+  }
+  return get_symbol(c);
+}
+
+/**
+ * \brief The character of a string or symbol of length 1
+ */
+static char char_of(Cell* const c) throw (runtime_error) {
+  if (stringp(c) && get_string(c)->get_length() == 1) {
+    return get_string(c)->get_char(0);
+  }
+  if (symbolp(c) && get_symbol(c).size() == 1) {
+    return get_symbol(c)[0];
+  }
+  throw runtime_error("Expected a single character");
+}
+
 Cell* bool_2_cell(bool b) {
   if(b) {
     return make_int(1);
@@ -43,19 +74,25 @@ Cell* bool_2_cell(bool b) {
 /// Actual implementations of *_func functions
 ////////////////////////////////////////////////////////////////////////////////
 
-Cell* ceiling_func(const FunctionCell* func, Cell* args) {
-  Cell* argument_cell = single_argument_eval(func, args);
-  int res = (int) ceil(get_double(argument_cell));
+Cell* do_ceiling(Cell* c) {
+  int res = (int) ceil(get_double(c));
   return make_int(res);
 }
 
-Cell* floor_func(const FunctionCell* func, Cell* args) {
-  Cell* argument_cell = single_argument_eval(func, args);
-  int res = (int) floor(get_double(argument_cell));
+Cell* ceiling_func(const FunctionCell* func, Cell* args) {
+  return do_ceiling(single_argument_eval(func, args));
+}
+
+Cell* do_floor(Cell* c) {
+  int res = (int) floor(get_double(c));
   
   return make_int(res);
 }
 
+Cell* floor_func(const FunctionCell* func, Cell* args) {
+  return do_floor(single_argument_eval(func, args));
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 Cell* cons_func(const FunctionCell* func, Cell* args) throw (runtime_error) {
@@ -145,8 +182,7 @@ Cell* if_func(const FunctionCell* func, Cell* args) {
   Cell* curr_cell = eval(car(args));
     
   // if, then
-  if (symbolp(curr_cell) || ( intp(curr_cell) && get_int(curr_cell) )
-     || ( doublep(curr_cell) && get_double(curr_cell) ) )
+  if (is_true(curr_cell))
     return eval( car(cdr(args)) );
     
   // else, no then
@@ -168,7 +204,7 @@ Cell* define_func(const FunctionCell* func, Cell* args) {
   Cell* symbol = car(args);  
   Cell* def = eval(car(cdr(args)));
 
-  SymbolCell::add_definition(symbol->get_symbol(), def);
+  SymbolCell::add_definition(get_interned(symbol), def);
 
   return nil;                         /// always return nil according to specs
 }
@@ -176,101 +212,81 @@ Cell* define_func(const FunctionCell* func, Cell* args) {
 ////////////////////////////////////////////////////////////////////////////////
 
 /**
- * \brief Weird, but is equivalent to a "not equal"
+ * \brief Weird, but is equivalent to a "not equal" for symbols. Symbols
+ *        are interned, therefore comparing the pointers is enough
  *
  * \todo verfiy!
  */
-bool string_compare(Cell* const args) {
-  Cell* pos = args;
-  
-  string s1;
-  string s2;
-
-  bool is_true = true;
-
-  while (!nullp(cdr(pos))) {
-    s1 = eval(car(pos))->get_symbol();
-    s2 = eval(car(cdr(pos)))->get_symbol();
-    
-    if (s1.compare(s2) == 0) {
-      /// can return false here, but need to check the syntax of following args
-      is_true = false;       
-    }
-    pos = cdr(pos);
+bool less_than(bool symbols, Cell* const c1, Cell* const c2) {
+  if (symbols) {
+    return get_interned(c1) != get_interned(c2);
   }
-
-  return is_true;
+  /// doubles can not represent all bigints, they are compared exactly
+  if ((bignump(c1) && (is_fixnum(c2) || bignump(c2)))
+      || (bignump(c2) && is_fixnum(c1))) {
+    return get_bigint(c1).compare(get_bigint(c2)) < 0;
+  }
+  /// automatically throws error if type is wrong
+  return get_numeral(c1) < get_numeral(c2);
 }
 
-bool numeral_compare(Cell* const args) {
-  Cell* pos = args;
+Cell* less_than_func(const FunctionCell* func, Cell* args) {
+  int num_args = ConsCell::get_list_size(args);
+  if (num_args < 2) {
+    return make_int(1);
+  }
   
-  double num1;
-  double num2;
-
+  bool symbols = symbolp(eval(car(args)));
   bool is_true = true;
 
+  Cell* pos = args;
   while (!nullp(cdr(pos))) {
-    num1 = eval(car(pos))->get_numeral();
-    num2 = eval(car(cdr(pos)))->get_numeral();
-    
-    if (! (num1 < num2) ) {
+    if (!less_than(symbols, eval(car(pos)), eval(car(cdr(pos))))) {
       /// can return false here, but need to check the syntax of following args
       is_true = false;
     }
     pos = cdr(pos);
   }
 
-  return is_true;
-}
-
-Cell* less_than_func(const FunctionCell* func, Cell* args) {
-  int num_args = ConsCell::get_list_size(args);
-  if (num_args < 2) {
-    return make_int(1);
-  }
-  
-  bool is_true;
-  
-  if (symbolp(eval(car(args)))) {
-    is_true = string_compare(args);
-  }
-  else {
-    is_true = numeral_compare(args); // automatically throws error if
-				     // type is wrong
-  }
-
   return bool_2_cell(is_true);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-Cell* not_func(const FunctionCell* func, Cell* args) {
-  Cell* argument_cell = single_argument_eval(func, args);
-  
-  if (argument_cell->is_int() || argument_cell->is_double()) {
-    if (argument_cell->get_numeral() == 0) {
+Cell* do_not(Cell* c) {
+  if (intp(c) || doublep(c)) {
+    if (get_numeral(c) == 0) {
       return make_int(1);
     } 
   }
   return make_int(0);
 }
 
-////////////////////////////////////////////////////////////////////////////////
+Cell* not_func(const FunctionCell* func, Cell* args) {
+  return do_not(single_argument_eval(func, args));
+}
 
-Cell* print_func(const FunctionCell* func, Cell* args) { 
-  Cell* argument_cell = single_argument_eval(func, args);
+////////////////////////////////////////////////////////////////////////////////
 
-  cout << *argument_cell;
-  cout << endl;
+Cell* do_print(Cell* c) {
+  print_cell(cout, c);
+  cout << '\n';           /// no flush, the OutputManager decides
   
   return nil;   /// always return nil according to specs
 }
 
+Cell* print_func(const FunctionCell* func, Cell* args) { 
+  return do_print(single_argument_eval(func, args));
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
+Cell* do_eval(Cell* c) {
+  return eval(c);
+}
+
 Cell* eval_func(const FunctionCell* func, Cell* args) {
-  return eval(single_argument_eval(func, args));
+  return do_eval(single_argument_eval(func, args));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -311,7 +327,11 @@ Cell* apply_func(const FunctionCell* func, Cell* args) {
   Cell* proc = eval(car(args));
   Cell* arguments = eval(car(cdr(args)));
 
-  return proc->apply(arguments);
+  return do_apply(proc, arguments);
+}
+
+Cell* do_apply(Cell* proc, Cell* arguments) {
+  return object_of(proc)->apply(arguments);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -329,7 +349,7 @@ Cell* let_func(const FunctionCell* func, Cell* args) {
 
     /// create local variables
     while (!nullp (pos)) {
-      string key = car(car(pos))->get_symbol();
+      const SymbolCell* key = get_interned(car(car(pos)));
       Cell* c = eval(car(cdr(car(pos))));
       DefinitionManager::Instance()->add_definition(key, c);
 
@@ -357,8 +377,15 @@ Cell* rand_func(const FunctionCell* func, Cell* args) {
     throw runtime_error("let need exactly 2 arguments");
   }
 
-   int num1 = get_int(eval(car(args)));
-   int num2 = get_int(eval(car(cdr(args))));
+   Cell* c1 = eval(car(args));
+   Cell* c2 = eval(car(cdr(args)));
+
+   return do_rand(c1, c2);
+}
+
+Cell* do_rand(Cell* c1, Cell* c2) {
+   int num1 = get_int(c1);
+   int num2 = get_int(c2);
    int res = rand() % abs(num1 - num2);
 
    if (num1 < num2) {
@@ -378,10 +405,12 @@ Cell* str_func(const FunctionCell* func, Cell* args) {
     throw runtime_error("str expects exactly 1 argument");
   }
   
-  Cell* argument_cell = eval(car(args));
+  return do_str(eval(car(args)));
+}
 
+Cell* do_str(Cell* c) {
   stringstream ss;
-  argument_cell->print(ss);
+  print_cell(ss, c);
 
   return make_symbol(ss.str().c_str());
 }
@@ -394,10 +423,21 @@ Cell* substr_func(const FunctionCell* func, Cell* args) {
   Cell* symbolCell = eval(car(args));
   Cell* startCell = eval(car(cdr(args)));
   Cell* endCell = eval(car(cdr(cdr(args))));
-  
+
+  return do_substr(symbolCell, startCell, endCell);
+}
+
+Cell* do_substr(Cell* symbolCell, Cell* startCell, Cell* endCell) {
   int start = get_int(startCell);
   int end   = get_int(endCell);
 
+  if (stringp(symbolCell)) {
+    /// the length is cut like for symbols
+    StringCell* text = get_string(symbolCell);
+    int rest = (int) text->get_length() - start;
+    return make_string(text->substr(start, end < rest ? end : rest));
+  }
+
   string sub = get_symbol(symbolCell).substr(start, end);
 
   return make_symbol(sub.c_str());
@@ -408,25 +448,750 @@ Cell* appstr_func(const FunctionCell* func, Cell* args) {
     throw runtime_error("substr needs exactly 2 arguments");
   }
 
-  string s1 = get_symbol(eval(car(args)));
-  string s2 = get_symbol(eval(car(cdr(args))));
+  Cell* c1 = eval(car(args));
+  Cell* c2 = eval(car(cdr(args)));
+
+  return do_appstr(c1, c2);
+}
+
+Cell* do_appstr(Cell* c1, Cell* c2) {
+  if (stringp(c1)) {
+    /// a new string, see string-append! for appending in place
+    Cell* result = make_string("", 0);
+    do_string_append(result, c1);
+    return do_string_append(result, c2);
+  }
+
+  string s1 = get_symbol(c1);
+  const string& s2 = get_symbol(c2);
 
   return make_symbol(s1.append(s2).c_str());
 }
 
+////////////////////////////////////////////////////////////////////////////////
 
-Cell* parse_func(const FunctionCell* func, Cell* args) {
+Cell* make_string_func(const FunctionCell* func, Cell* args) {
+  int num_args = ConsCell::get_list_size(args);
+  if (num_args != 1 && num_args != 2) {
+    throw runtime_error("make-string needs 1 or 2 arguments");
+  }
+
+  Cell* size = eval(car(args));
+  if (num_args == 1) {
+    return do_make_string(size, NULL);
+  }
+  return do_make_string(size, eval(car(cdr(args))));
+}
+
+Cell* do_make_string(Cell* size, Cell* fill) {
+  int n = get_int(size);
+  if (n < 0) {
+    throw runtime_error("make-string needs a size which is not negative");
+  }
+
+  return (Cell*) new StringCell(n, fill == NULL ? ' ' : char_of(fill));
+}
+
+Cell* string_length_func(const FunctionCell* func, Cell* args) {
+  return do_string_length(single_argument_eval(func, args));
+}
+
+Cell* do_string_length(Cell* c) {
+  return make_int((int) get_string(c)->get_length());
+}
+
+Cell* string_ref_func(const FunctionCell* func, Cell* args) {
+  if (ConsCell::get_list_size(args) != 2) {
+    throw runtime_error("string-ref needs exactly 2 arguments");
+  }
+
+  Cell* c = eval(car(args));
+  Cell* index = eval(car(cdr(args)));
+
+  return do_string_ref(c, index);
+}
+
+Cell* do_string_ref(Cell* c, Cell* index) {
+  char ch = get_string(c)->get_char(get_int(index));
+
+  return make_string(&ch, 1);
+}
+
+Cell* string_set_func(const FunctionCell* func, Cell* args) {
+  if (ConsCell::get_list_size(args) != 3) {
+    throw runtime_error("string-set! needs exactly 3 arguments");
+  }
+
+  Cell* c = eval(car(args));
+  Cell* index = eval(car(cdr(args)));
+  Cell* ch = eval(car(cdr(cdr(args))));
+
+  return do_string_set(c, index, ch);
+}
+
+Cell* do_string_set(Cell* c, Cell* index, Cell* ch) {
+  get_string(c)->set_char(get_int(index), char_of(ch));
+
+  return nil;   /// like define
+}
+
+Cell* string_append_func(const FunctionCell* func, Cell* args) {
+  if (ConsCell::get_list_size(args) != 2) {
+    throw runtime_error("string-append! needs exactly 2 arguments");
+  }
+
+  Cell* c = eval(car(args));
+  Cell* tail = eval(car(cdr(args)));
+
+  return do_string_append(c, tail);
+}
+
+Cell* do_string_append(Cell* c, Cell* tail) {
+  StringCell* text = get_string(c);
+  if (stringp(tail)) {
+    text->append(get_string(tail));
+  } else {
+    const string& symbol = get_symbol(tail);
+    text->append(symbol.data(), symbol.size());
+  }
+
+  return c;
+}
+
+Cell* substring_func(const FunctionCell* func, Cell* args) {
+  if (ConsCell::get_list_size(args) != 3) {
+    throw runtime_error("substring needs exactly 3 arguments");
+  }
+
+  Cell* c = eval(car(args));
+  Cell* start = eval(car(cdr(args)));
+  Cell* end = eval(car(cdr(cdr(args))));
+
+  return do_substring(c, start, end);
+}
+
+Cell* do_substring(Cell* c, Cell* start, Cell* end) {
+  int from = get_int(start);
+
+  return make_string(get_string(c)->substr(from, get_int(end) - from));
+}
+
+Cell* string_to_symbol_func(const FunctionCell* func, Cell* args) {
+  return do_string_to_symbol(single_argument_eval(func, args));
+}
+
+Cell* do_string_to_symbol(Cell* c) {
+  return make_symbol(get_string(c)->to_string());
+}
+
+Cell* symbol_to_string_func(const FunctionCell* func, Cell* args) {
+  return do_symbol_to_string(single_argument_eval(func, args));
+}
+
+Cell* do_symbol_to_string(Cell* c) {
+  return make_string(get_symbol(c));
+}
+
+Cell* stringp_func(const FunctionCell* func, Cell* args) {
   Cell* argument_cell = single_argument_eval(func, args);
-  
-  Cell* root = parse(get_symbol(argument_cell));
-  
-  return root;
+
+  return bool_2_cell(stringp(argument_cell));
 }
 
-Cell* parse_eval_func(const FunctionCell* func, Cell* args) {
+////////////////////////////////////////////////////////////////////////////////
+
+Cell* make_vector_func(const FunctionCell* func, Cell* args) {
+  int num_args = ConsCell::get_list_size(args);
+  if (num_args != 1 && num_args != 2) {
+    throw runtime_error("make-vector needs 1 or 2 arguments");
+  }
+
+  Cell* size = eval(car(args));
+  Cell* fill = nullp(cdr(args)) ? nil : eval(car(cdr(args)));
+
+  return do_make_vector(size, fill);
+}
+
+Cell* do_make_vector(Cell* size, Cell* fill) {
+  int n = get_int(size);
+  if (n < 0) {
+    throw runtime_error("make-vector needs a size which is not negative");
+  }
+
+  return make_vector(n, fill);
+}
+
+Cell* vector_ref_func(const FunctionCell* func, Cell* args) {
+  if (ConsCell::get_list_size(args) != 2) {
+    throw runtime_error("vector-ref needs exactly 2 arguments");
+  }
+
+  Cell* vector = eval(car(args));
+  Cell* index = eval(car(cdr(args)));
+
+  return do_vector_ref(vector, index);
+}
+
+Cell* do_vector_ref(Cell* vector, Cell* index) {
+  return vector_ref(vector, get_int(index));
+}
+
+Cell* vector_set_func(const FunctionCell* func, Cell* args) {
+  if (ConsCell::get_list_size(args) != 3) {
+    throw runtime_error("vector-set! needs exactly 3 arguments");
+  }
+
+  Cell* vector = eval(car(args));
+  Cell* index = eval(car(cdr(args)));
+  Cell* value = eval(car(cdr(cdr(args))));
+
+  return do_vector_set(vector, index, value);
+}
+
+Cell* do_vector_set(Cell* vector, Cell* index, Cell* value) {
+  vector_set(vector, get_int(index), value);
+
+  return nil;   /// like define
+}
+
+Cell* vector_length_func(const FunctionCell* func, Cell* args) {
+  return do_vector_length(single_argument_eval(func, args));
+}
+
+Cell* do_vector_length(Cell* vector) {
+  return make_int(vector_length(vector));
+}
+
+Cell* vectorp_func(const FunctionCell* func, Cell* args) {
   Cell* argument_cell = single_argument_eval(func, args);
-  
-  Cell* root = parse(get_symbol(argument_cell));
+
+  return bool_2_cell(vectorp(argument_cell));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+Cell* eq_func(const FunctionCell* func, Cell* args) {
+  if (ConsCell::get_list_size(args) != 2) {
+    throw runtime_error("eq? needs exactly 2 arguments");
+  }
+
+  Cell* c1 = eval(car(args));
+  Cell* c2 = eval(car(cdr(args)));
+
+  return do_eq(c1, c2);
+}
+
+Cell* do_eq(Cell* c1, Cell* c2) {
+  return bool_2_cell(cells_eq(c1, c2));
+}
+
+Cell* equal_func(const FunctionCell* func, Cell* args) {
+  if (ConsCell::get_list_size(args) != 2) {
+    throw runtime_error("equal? needs exactly 2 arguments");
+  }
+
+  Cell* c1 = eval(car(args));
+  Cell* c2 = eval(car(cdr(args)));
+
+  return do_equal(c1, c2);
+}
+
+Cell* do_equal(Cell* c1, Cell* c2) {
+  return bool_2_cell(cells_equal(c1, c2));
+}
+
+Cell* make_hash_table_func(const FunctionCell* func, Cell* args) {
+  if (ConsCell::get_list_size(args) > 1) {
+    throw runtime_error("make-hash-table needs 0 or 1 arguments");
+  }
+
+  return do_make_hash_table(nullp(args) ? NULL : eval(car(args)));
+}
+
+Cell* do_make_hash_table(Cell* equality) {
+  if (equality == NULL) {
+    return make_hash_table(true);
+  }
+  /// the builtins are symbols, so (quote eq?) works as well
+  if (symbolp(equality)) {
+    if (get_symbol(equality) == "equal?") {
+      return make_hash_table(true);
+    }
+    if (get_symbol(equality) == "eq?") {
+      return make_hash_table(false);
+    }
+  }
+  throw runtime_error("make-hash-table compares keys with eq? or equal? only");
+}
+
+Cell* hash_table_ref_func(const FunctionCell* func, Cell* args) {
+  int num_args = ConsCell::get_list_size(args);
+  if (num_args != 2 && num_args != 3) {
+    throw runtime_error("hash-table-ref needs 2 or 3 arguments");
+  }
+
+  Cell* table = eval(car(args));
+  Cell* key = eval(car(cdr(args)));
+  Cell* fallback = num_args == 3 ? eval(car(cdr(cdr(args)))) : NULL;
+
+  return do_hash_table_ref(table, key, fallback);
+}
+
+Cell* do_hash_table_ref(Cell* table, Cell* key, Cell* fallback) {
+  Cell* value = get_hash_table(table)->get(key);
+  if (value != NULL) {
+    return value;
+  }
+  if (fallback == NULL) {
+    stringstream ss;
+    ss << "hash-table-ref: there is no key ";
+    print_cell(ss, key);
+    throw runtime_error(ss.str());
+  }
+  return fallback;
+}
+
+Cell* hash_table_set_func(const FunctionCell* func, Cell* args) {
+  if (ConsCell::get_list_size(args) != 3) {
+    throw runtime_error("hash-table-set! needs exactly 3 arguments");
+  }
+
+  Cell* table = eval(car(args));
+  Cell* key = eval(car(cdr(args)));
+  Cell* value = eval(car(cdr(cdr(args))));
+
+  return do_hash_table_set(table, key, value);
+}
+
+Cell* do_hash_table_set(Cell* table, Cell* key, Cell* value) {
+  get_hash_table(table)->set(key, value);
+
+  return nil;   /// like define
+}
+
+Cell* hash_table_delete_func(const FunctionCell* func, Cell* args) {
+  if (ConsCell::get_list_size(args) != 2) {
+    throw runtime_error("hash-table-delete! needs exactly 2 arguments");
+  }
+
+  Cell* table = eval(car(args));
+  Cell* key = eval(car(cdr(args)));
+
+  return do_hash_table_delete(table, key);
+}
+
+Cell* do_hash_table_delete(Cell* table, Cell* key) {
+  get_hash_table(table)->remove(key);
+
+  return nil;
+}
+
+Cell* hash_table_contains_func(const FunctionCell* func, Cell* args) {
+  if (ConsCell::get_list_size(args) != 2) {
+    throw runtime_error("hash-table-contains? needs exactly 2 arguments");
+  }
+
+  Cell* table = eval(car(args));
+  Cell* key = eval(car(cdr(args)));
+
+  return do_hash_table_contains(table, key);
+}
+
+Cell* do_hash_table_contains(Cell* table, Cell* key) {
+  return bool_2_cell(get_hash_table(table)->get(key) != NULL);
+}
+
+Cell* hash_table_count_func(const FunctionCell* func, Cell* args) {
+  return do_hash_table_count(single_argument_eval(func, args));
+}
+
+Cell* do_hash_table_count(Cell* table) {
+  return make_int(get_hash_table(table)->get_count());
+}
+
+/**
+ * \brief The keys, the values or (key . value) pairs of all entries
+ */
+static Cell* entries_of(Cell* table, bool keys, bool values) {
+  const HashTableCell::Table& entries = get_hash_table(table)->get_table();
+
+  Cell* result = nil;
+  for (HashTableCell::Table::const_iterator i = entries.begin(); i != entries.end(); ++i) {
+    Cell* entry = !values ? i->first : !keys ? i->second : cons(i->first, i->second);
+    result = cons(entry, result);
+  }
+  return result;
+}
+
+Cell* hash_table_keys_func(const FunctionCell* func, Cell* args) {
+  return do_hash_table_keys(single_argument_eval(func, args));
+}
+
+Cell* do_hash_table_keys(Cell* table) {
+  return entries_of(table, true, false);
+}
+
+Cell* hash_table_values_func(const FunctionCell* func, Cell* args) {
+  return do_hash_table_values(single_argument_eval(func, args));
+}
+
+Cell* do_hash_table_values(Cell* table) {
+  return entries_of(table, false, true);
+}
+
+Cell* hash_table_to_alist_func(const FunctionCell* func, Cell* args) {
+  return do_hash_table_to_alist(single_argument_eval(func, args));
+}
+
+Cell* do_hash_table_to_alist(Cell* table) {
+  return entries_of(table, true, true);
+}
+
+/**
+ * \brief Expression which evaluates to c, procedures evaluate their
+ *        arguments (see do_apply())
+ */
+static Cell* quoted(Cell* c) {
+  return cons(make_symbol("quote"), cons(c, nil));
+}
+
+Cell* hash_table_walk_func(const FunctionCell* func, Cell* args) {
+  if (ConsCell::get_list_size(args) != 2) {
+    throw runtime_error("hash-table-walk needs exactly 2 arguments");
+  }
+
+  Cell* table = eval(car(args));
+  Cell* proc = eval(car(cdr(args)));
+
+  return do_hash_table_walk(table, proc);
+}
+
+Cell* do_hash_table_walk(Cell* table, Cell* proc) {
+  /// proc may change the table, so it walks a copy of the entries
+  for (Cell* pos = entries_of(table, true, true); !nullp(pos); pos = cdr(pos)) {
+    Cell* entry = car(pos);
+    do_apply(proc, cons(quoted(car(entry)), cons(quoted(cdr(entry)), nil)));
+  }
+  return nil;
+}
+
+Cell* hash_tablep_func(const FunctionCell* func, Cell* args) {
+  Cell* argument_cell = single_argument_eval(func, args);
+
+  return bool_2_cell(hash_tablep(argument_cell));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Number of elements of a proper list
+ * \throw runtime_error if list is none, name is the function to blame
+ */
+static int proper_length(Cell* list, const char* name) throw (runtime_error) {
+  int length = 0;
+  Cell* pos = list;
+  for (; !is_immediate(pos) && pos->is_cons(); pos = cdr(pos)) {
+    ++length;
+  }
+  if (!nullp(pos)) {
+    throw runtime_error(string(name) + " needs a proper list");
+  }
+  return length;
+}
+
+Cell* length_func(const FunctionCell* func, Cell* args) {
+  return do_length(single_argument_eval(func, args));
+}
+
+Cell* do_length(Cell* list) {
+  return make_int(proper_length(list, "length"));
+}
+
+Cell* append_func(const FunctionCell* func, Cell* args) {
+  if (ConsCell::get_list_size(args) != 2) {
+    throw runtime_error("append needs exactly 2 arguments");
+  }
+
+  Cell* list1 = eval(car(args));
+  Cell* list2 = eval(car(cdr(args)));
+
+  return do_append(list1, list2);
+}
+
+Cell* do_append(Cell* list1, Cell* list2) {
+  proper_length(list1, "append");
+
+  /// the copy is built from the back, the elements stay reachable
+  /// through list1 meanwhile
+  vector<Cell*> elements;
+  for (Cell* pos = list1; !nullp(pos); pos = cdr(pos)) {
+    elements.push_back(car(pos));
+  }
+
+  Cell* result = list2;
+  for (size_t i = elements.size(); i > 0; --i) {
+    result = cons(elements[i - 1], result);
+  }
+  return result;
+}
+
+Cell* reverse_func(const FunctionCell* func, Cell* args) {
+  return do_reverse(single_argument_eval(func, args));
+}
+
+Cell* do_reverse(Cell* list) {
+  proper_length(list, "reverse");
+
+  Cell* result = nil;
+  for (Cell* pos = list; !nullp(pos); pos = cdr(pos)) {
+    result = cons(car(pos), result);
+  }
+  return result;
+}
+
+Cell* assoc_func(const FunctionCell* func, Cell* args) {
+  if (ConsCell::get_list_size(args) != 2) {
+    throw runtime_error("assoc needs exactly 2 arguments");
+  }
+
+  Cell* key = eval(car(args));
+  Cell* dict = eval(car(cdr(args)));
+
+  return do_assoc(key, dict);
+}
+
+Cell* do_assoc(Cell* key, Cell* dict) {
+  for (Cell* pos = dict; !nullp(pos); pos = cdr(pos)) {
+    if (cells_equal(key, car(car(pos)))) {
+      return car(pos);
+    }
+  }
+  return make_int(0);
+}
+
+Cell* list_tail_func(const FunctionCell* func, Cell* args) {
+  if (ConsCell::get_list_size(args) != 2) {
+    throw runtime_error("list-tail needs exactly 2 arguments");
+  }
+
+  Cell* list = eval(car(args));
+  Cell* k = eval(car(cdr(args)));
+
+  return do_list_tail(list, k);
+}
+
+Cell* do_list_tail(Cell* list, Cell* k) {
+  if (!is_fixnum(k)) {
+    throw runtime_error("list-tail needs an int");
+  }
+
+  /// counts from 1, as list-tail of library.scm did
+  int n = get_int(k);
+  int length = proper_length(list, "list-tail");
+  if (length < n) {
+    stringstream ss;
+    ss << "Index " << n << " is out of range for a list of length " << length;
+    throw runtime_error(ss.str());
+  }
+
+  Cell* pos = list;
+  for (int i = 1; i < n; ++i) {
+    pos = cdr(pos);
+  }
+  return pos;
+}
+
+Cell* list_ref_func(const FunctionCell* func, Cell* args) {
+  if (ConsCell::get_list_size(args) != 2) {
+    throw runtime_error("list-ref needs exactly 2 arguments");
+  }
+
+  Cell* list = eval(car(args));
+  Cell* k = eval(car(cdr(args)));
+
+  return do_list_ref(list, k);
+}
+
+Cell* do_list_ref(Cell* list, Cell* k) {
+  return car(do_list_tail(list, k));
+}
+
+/**
+ * \brief Orders fixnums without calling <
+ */
+struct FixnumLess {
+  bool operator()(Cell* c1, Cell* c2) const {
+    return get_int(c1) < get_int(c2);
+  }
+};
+
+/**
+ * \brief Orders numbers like the builtin < does, without calling it
+ */
+struct NumberLess {
+  bool operator()(Cell* c1, Cell* c2) const {
+    return less_than(false, c1, c2);
+  }
+};
+
+/**
+ * \brief Orders by calling the procedure proc_m with both cells
+ */
+struct ProcedureLess {
+  explicit ProcedureLess(Cell* proc) : proc_m(proc) {}
+
+  bool operator()(Cell* c1, Cell* c2) const {
+    return is_true(do_apply(proc_m, cons(quoted(c1), cons(quoted(c2), nil))));
+  }
+
+  Cell* proc_m;
+};
+
+/**
+ * \brief Bottom up merge sort of cells. An element of the right run is
+ *        taken first only if it is less than the one of the left run, so
+ *        equal elements keep their order. less is called O(n log n) times
+ *        even if it is no ordering at all
+ */
+template <class Less>
+static void merge_sort(vector<Cell*>& cells, Less less) {
+  size_t n = cells.size();
+  vector<Cell*> merged(n);
+
+  for (size_t width = 1; width < n; width *= 2) {
+    for (size_t low = 0; low < n; low += 2 * width) {
+      size_t middle = min(low + width, n);
+      size_t high = min(low + 2 * width, n);
+      size_t i = low;
+      size_t j = middle;
+      size_t k = low;
+
+      while (i < middle && j < high) {
+	merged[k++] = less(cells[j], cells[i]) ? cells[j++] : cells[i++];
+      }
+      while (i < middle) {
+	merged[k++] = cells[i++];
+      }
+      while (j < high) {
+	merged[k++] = cells[j++];
+      }
+    }
+    cells.swap(merged);
+  }
+}
+
+Cell* list_sort_func(const FunctionCell* func, Cell* args) {
+  if (ConsCell::get_list_size(args) != 2) {
+    throw runtime_error("list-sort needs exactly 2 arguments");
+  }
+
+  Cell* proc = eval(car(args));
+  Cell* list = eval(car(cdr(args)));
+
+  return do_list_sort(proc, list);
+}
+
+Cell* do_list_sort(Cell* proc, Cell* list) {
+  vector<Cell*> cells;
+  cells.reserve(proper_length(list, "list-sort"));
+
+  /// symbols are left out, intp() and doublep() ask their definitions
+  bool fixnums = true;
+  bool numbers = true;
+  for (Cell* pos = list; !nullp(pos); pos = cdr(pos)) {
+    Cell* c = car(pos);
+    fixnums = fixnums && is_fixnum(c);
+    numbers = numbers && (is_fixnum(c) || (!symbolp(c) && (bignump(c) || doublep(c))));
+    cells.push_back(c);
+  }
+
+  /// the elements are kept in cells, which the collector does not see.
+  /// They stay reachable through list while proc and cons allocate
+  GarbageCollector::Instance()->pin(list);
+  try {
+    /// the builtin < is not called for numbers, nothing is allocated
+    const FunctionCell* less = FunctionManager::Instance()->get_function(get_interned(make_symbol("<")));
+    if (proc == (Cell*) less && fixnums) {
+      merge_sort(cells, FixnumLess());
+    }
+    else if (proc == (Cell*) less && numbers) {
+      merge_sort(cells, NumberLess());
+    }
+    else {
+      merge_sort(cells, ProcedureLess(proc));
+    }
+  }
+  catch (...) {
+    GarbageCollector::Instance()->unpin(list);
+    throw;
+  }
+
+  Cell* result = nil;
+  for (size_t i = cells.size(); i > 0; --i) {
+    result = cons(cells[i - 1], result);
+  }
+
+  GarbageCollector::Instance()->unpin(list);
+  return result;
+}
+
+Cell* do_parse(Cell* c) {
+  return parse(text_of(c));
+}
+
+Cell* parse_func(const FunctionCell* func, Cell* args) {
+  return do_parse(single_argument_eval(func, args));
+}
+
+Cell* do_parse_eval(Cell* c) {
+  Cell* root = parse(text_of(c));
   
   return eval(root);
 }
+
+Cell* parse_eval_func(const FunctionCell* func, Cell* args) {
+  return do_parse_eval(single_argument_eval(func, args));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+Cell* gc_func(const FunctionCell* func, Cell* args) {
+  GarbageCollector::Instance()->collect();
+
+  return nil;   /// always return nil, similar to print
+}
+
+Cell* gc_stats_func(const FunctionCell* func, Cell* args) {
+  GarbageCollector::Instance()->print_stats(cout);
+  OutputManager::Instance()->print_stats(cout);
+
+  return nil;
+}
+
+Cell* write_fasl_func(const FunctionCell* func, Cell* args) {
+  Cell* obj = eval(car(args));
+  Cell* file = eval(car(cdr(args)));
+  write_fasl_file(obj, get_symbol(file));
+
+  return nil;
+}
+
+Cell* read_fasl_func(const FunctionCell* func, Cell* args) {
+  return read_fasl_file(get_symbol(single_argument_eval(func, args)));
+}
+
+Cell* flush_func(const FunctionCell* func, Cell* args) {
+  OutputManager::Instance()->flush();
+
+  return nil;
+}
+
+Cell* do_gc_growth(Cell* c) {
+  GarbageCollector::Instance()->set_growth_factor(get_numeral(c));
+
+  return nil;
+}
+
+Cell* gc_growth_func(const FunctionCell* func, Cell* args) {
+  return do_gc_growth(single_argument_eval(func, args));
+}
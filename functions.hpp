@@ -16,6 +16,73 @@ using namespace std;
  */
 Cell* single_argument_eval(const SymbolCell* func, Cell* args) throw (runtime_error);
 
+/**
+ * \brief Condition of if: symbols and numbers other than 0 are true
+ */
+bool is_true(Cell* const c);
+
+/**
+ * \brief Characters of a symbol or a string
+ * \throw runtime_error if c is neither
+ */
+string text_of(Cell* const c) throw (runtime_error);
+
+/**
+ * \brief Single comparison of the < function. Symbols are compared for
+ *        inequality, numbers by value
+ * \param symbols true if the first argument of < has been a symbol
+ */
+bool less_than(bool symbols, Cell* const c1, Cell* const c2);
+
+////////////////////////////////////////////////////////////////////////////////
+/// Builtins on evaluated arguments. Used by the *_func functions below
+/// and by the VirtualMachine, which evaluates the arguments itself
+
+Cell* do_ceiling(Cell* c);
+Cell* do_floor(Cell* c);
+Cell* do_not(Cell* c);
+Cell* do_print(Cell* c);
+Cell* do_eval(Cell* c);
+Cell* do_apply(Cell* proc, Cell* arguments);
+Cell* do_rand(Cell* c1, Cell* c2);
+Cell* do_str(Cell* c);
+Cell* do_substr(Cell* symbol, Cell* start, Cell* end);
+Cell* do_appstr(Cell* c1, Cell* c2);
+Cell* do_make_vector(Cell* size, Cell* fill);
+Cell* do_vector_ref(Cell* vector, Cell* index);
+Cell* do_vector_set(Cell* vector, Cell* index, Cell* value);
+Cell* do_vector_length(Cell* vector);
+Cell* do_make_string(Cell* size, Cell* fill);
+Cell* do_string_length(Cell* c);
+Cell* do_string_ref(Cell* c, Cell* index);
+Cell* do_string_set(Cell* c, Cell* index, Cell* ch);
+Cell* do_string_append(Cell* c, Cell* tail);
+Cell* do_substring(Cell* c, Cell* start, Cell* end);
+Cell* do_string_to_symbol(Cell* c);
+Cell* do_symbol_to_string(Cell* c);
+Cell* do_eq(Cell* c1, Cell* c2);
+Cell* do_equal(Cell* c1, Cell* c2);
+Cell* do_make_hash_table(Cell* equality);
+Cell* do_hash_table_ref(Cell* table, Cell* key, Cell* fallback);
+Cell* do_hash_table_set(Cell* table, Cell* key, Cell* value);
+Cell* do_hash_table_delete(Cell* table, Cell* key);
+Cell* do_hash_table_contains(Cell* table, Cell* key);
+Cell* do_hash_table_count(Cell* table);
+Cell* do_hash_table_keys(Cell* table);
+Cell* do_hash_table_values(Cell* table);
+Cell* do_hash_table_to_alist(Cell* table);
+Cell* do_hash_table_walk(Cell* table, Cell* proc);
+Cell* do_length(Cell* list);
+Cell* do_append(Cell* list1, Cell* list2);
+Cell* do_reverse(Cell* list);
+Cell* do_assoc(Cell* key, Cell* dict);
+Cell* do_list_tail(Cell* list, Cell* k);
+Cell* do_list_ref(Cell* list, Cell* k);
+Cell* do_list_sort(Cell* proc, Cell* list);
+Cell* do_parse(Cell* c);
+Cell* do_parse_eval(Cell* c);
+Cell* do_gc_growth(Cell* c);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Actual implementations of *_func functions
 
@@ -58,35 +125,35 @@ Cell* cdr_func(const FunctionCell* func, Cell* args);
 /**
  * \brief Exposes intp from cons.hpp, also evaluates sub-trees
  * \param Cell* expects a single ConsCell
- * \return an IntCell containing 0 or 1 indicating true or false
+ * \return an int cell containing 0 or 1 indicating true or false
  */
 Cell* intp_func(const FunctionCell* func, Cell* args);
 
 /**
  * \brief Exposes doublep from cons.hpp, also evaluates sub-trees
  * \param Cell* expects a single ConsCell
- * \return an IntCell containing 0 or 1 indicating true or false
+ * \return an int cell containing 0 or 1 indicating true or false
  */
 Cell* doublep_func(const FunctionCell* func, Cell* args);
 
 /**
  * \brief Exposes symbolp from cons.hpp, also evaluates sub-trees
  * \param Cell* expects a single ConsCell
- * \return an IntCell containing 0 or 1 indicating true or false
+ * \return an int cell containing 0 or 1 indicating true or false
  */
 Cell* symbolp_func(const FunctionCell* func, Cell* args);
 
 /**
  * \brief Exposes nullp from cons.hpp, also evaluates sub-trees
  * \param Cell* expects a single ConsCell
- * \return an IntCell containing 0 or 1 indicating true or false
+ * \return an int cell containing 0 or 1 indicating true or false
  */
 Cell* nullp_func(const FunctionCell* func, Cell* args);
 
 /**
  * \brief Exposes listp from cons.hpp, also evaluates sub-trees
  * \param Cell* expects a single ConsCell
- * \return an IntCell containing 0 or 1 indicating true or false
+ * \return an int cell containing 0 or 1 indicating true or false
  */
 Cell* listp_func(const FunctionCell* func, Cell* args);
 
@@ -152,15 +219,218 @@ Cell* str_func(const FunctionCell* func, Cell* args);
 
 /**
  * \brief substring for symbol cells, takes symbol and a range (start
- *        and end of substr)
+ *        and end of substr). Of a string, it is a new string
  */
 Cell* substr_func(const FunctionCell* func, Cell* args);
 
 /**
- * \brief appends symbols, takes two symbols
+ * \brief appends symbols, takes two symbols. If the first one is a
+ *        string, the result is a new string
  */
 Cell* appstr_func(const FunctionCell* func, Cell* args);
 
+/**
+ * \brief (make-vector size [fill]) creates a vector of size elements,
+ *        which are all fill (nil if it is not given)
+ */
+Cell* make_vector_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief (vector-ref vector index) returns an element of the vector in
+ *        constant time
+ */
+Cell* vector_ref_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief (vector-set! vector index value) replaces an element of the
+ *        vector in constant time
+ * \return nil Always returns nil
+ */
+Cell* vector_set_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief (vector-length vector) returns the number of elements
+ */
+Cell* vector_length_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief Checks if the argument is a vector
+ */
+Cell* vectorp_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief (make-string size [char]) creates a string of size characters,
+ *        which are all char (a space if it is not given). Characters
+ *        are strings or symbols of length 1
+ */
+Cell* make_string_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief (string-length string) returns the number of characters
+ */
+Cell* string_length_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief (string-ref string index) returns a character of the string, as
+ *        string of length 1, in constant time
+ */
+Cell* string_ref_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief (string-set! string index char) replaces a character of the
+ *        string in constant time
+ * \return nil Always returns nil
+ */
+Cell* string_set_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief (string-append! string tail) appends the string or symbol tail
+ *        to string in place, which takes time in the length of tail only
+ * \return the string
+ */
+Cell* string_append_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief (substring string start end) returns a new string with the
+ *        characters from start to end (exclusive)
+ */
+Cell* substring_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief Converts a string to the symbol with the same name
+ */
+Cell* string_to_symbol_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief Converts a symbol to a new string with its name
+ */
+Cell* symbol_to_string_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief Checks if the argument is a string
+ */
+Cell* stringp_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief (eq? a b) checks if a and b are the same: numbers which are =,
+ *        symbols of the same name or the very same cell
+ */
+Cell* eq_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief (equal? a b) checks if a and b are eq?, or lists or vectors with
+ *        equal? elements, or strings with the same characters
+ */
+Cell* equal_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief (make-hash-table [eq?|equal?]) creates an empty hash table, whose
+ *        keys are compared with equal? unless eq? is given
+ */
+Cell* make_hash_table_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief (hash-table-ref table key [default]) returns the value of key,
+ *        or default if there is no such key (an error without default)
+ */
+Cell* hash_table_ref_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief (hash-table-set! table key value) maps key to value
+ * \return nil Always returns nil
+ */
+Cell* hash_table_set_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief (hash-table-delete! table key) removes key, if it is there
+ * \return nil Always returns nil
+ */
+Cell* hash_table_delete_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief (hash-table-contains? table key) checks if there is the key
+ */
+Cell* hash_table_contains_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief (hash-table-count table) returns the number of keys
+ */
+Cell* hash_table_count_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief (hash-table-keys table) returns a list of all keys, in no
+ *        particular order
+ */
+Cell* hash_table_keys_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief (hash-table-values table) returns a list of all values, in the
+ *        order of hash-table-keys
+ */
+Cell* hash_table_values_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief (hash-table->alist table) returns a list of (key . value) pairs,
+ *        in the order of hash-table-keys
+ */
+Cell* hash_table_to_alist_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief (hash-table-walk table proc) calls (proc key value) for every
+ *        entry. proc may change the table, it sees the entries there
+ *        have been before the walk
+ * \return nil Always returns nil
+ */
+Cell* hash_table_walk_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief Checks if the argument is a hash table
+ */
+Cell* hash_tablep_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief (length list) returns the number of elements of a proper list
+ */
+Cell* length_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief (append list1 list2) returns a copy of list1 followed by list2,
+ *        which is shared
+ */
+Cell* append_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief (reverse list) returns a new list with the elements in reverse
+ *        order
+ */
+Cell* reverse_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief (assoc key dict) returns the first pair of the association list
+ *        dict whose car is equal? to key, 0 if there is none
+ */
+Cell* assoc_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief (list-tail list k) returns the list from its kth element on.
+ *        Counts from 1, k below 1 returns the whole list
+ */
+Cell* list_tail_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief (list-ref list k) returns the kth element, counted from 1 like
+ *        list-tail
+ */
+Cell* list_ref_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief (list-sort proc list) returns a new list with the elements
+ *        sorted by the procedure proc, which is true if its first
+ *        argument belongs before the second one. A stable merge sort,
+ *        the builtin < sorts numbers without being called
+ */
+Cell* list_sort_func(const FunctionCell* func, Cell* args);
+
 /**
  * \brief parses s-expression inside a symbol cell and evaluates it
  */
@@ -171,4 +441,43 @@ Cell* parse_func(const FunctionCell* func, Cell* args);
  */
 Cell* parse_eval_func(const FunctionCell* func, Cell* args);
 
+/**
+ * \brief Runs a full garbage collection
+ * \return nil Always returns nil
+ */
+Cell* gc_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief Prints collection counts, pause times and heap size, and the
+ *        number of write() calls for the output
+ * \return nil Always returns nil
+ */
+Cell* gc_stats_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief Sets the factor by which the heap may grow before the next
+ *        collection is triggered
+ * \return nil Always returns nil
+ */
+Cell* gc_growth_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief (write-fasl obj file) writes obj in the binary fast-load format
+ *        to the file named by the symbol file, see fasl.hpp
+ * \return nil Always returns nil
+ */
+Cell* write_fasl_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief (read-fasl file) reads what write-fasl has written to the file
+ *        named by the symbol file
+ */
+Cell* read_fasl_func(const FunctionCell* func, Cell* args);
+
+/**
+ * \brief Writes the buffered output, (flush) and (flush-output)
+ * \return nil Always returns nil
+ */
+Cell* flush_func(const FunctionCell* func, Cell* args);
+
 #endif
@@ -1,18 +1,90 @@
 #ifndef HASHTABLEMAP_HPP
 #define HASHTABLEMAP_HPP
 
-#define NO_BUCKETS 389
-#define RADIX 64
-
-#include "bstmap.hpp"
-
+#include <cstring>
+#include <functional>
 #include <iterator>
+#include <new>
 #include <sstream>
-
-#include <cassert>
+#include <stdexcept>
+#include <string>
+#include <utility>
 
 using namespace std;
 
+/**
+ * \brief Hash of a string in the manner of FNV-1a, but a word at a time
+ *        (symbols can be long, e.g. made by str). The high half is folded
+ *        back after every word, so every byte reaches the low bits. Is
+ *        also precomputed for interned symbols, see SymbolManager
+ */
+inline size_t hash_key(const char* p, size_t n) {
+  const size_t FOLD = sizeof(size_t) * 4;
+
+  size_t hash = 2166136261u;
+
+  for (; n >= sizeof(size_t); p += sizeof(size_t), n -= sizeof(size_t)) {
+    size_t word;
+    memcpy(&word, p, sizeof(size_t));
+
+    hash = (hash ^ word) * 16777619u;
+    hash ^= hash >> FOLD;
+  }
+
+  for (; n > 0; ++p, --n) {
+    hash = (hash ^ (unsigned char) *p) * 16777619u;
+  }
+
+  return hash;
+}
+
+inline size_t hash_key(const string& k) {
+  return hash_key(k.data(), k.size());
+}
+
+/**
+ * \brief Hash of integral keys, mixes the bits (the table uses the low
+ *        bits only)
+ */
+inline size_t hash_key(unsigned long k) {
+  k ^= k >> 16;
+  k *= 0x45d9f3bu;
+  k ^= k >> 16;
+
+  return k;
+}
+
+inline size_t hash_key(long k)         { return hash_key((unsigned long) k); }
+inline size_t hash_key(unsigned int k) { return hash_key((unsigned long) k); }
+inline size_t hash_key(int k)          { return hash_key((unsigned long) k); }
+
+/**
+ * \brief Hash of any other key, uses its printed form. Slow, since it
+ *        allocates: keys which know their hash already should overload
+ *        hash_key() (e.g. SymbolCell) or pass their own Hash to
+ *        hashtablemap
+ */
+template <class Key>
+size_t hash_key(const Key& k) {
+  // lazy stringstream method
+  stringstream ss; ss << k;
+
+  return hash_key(ss.str());
+}
+
+/**
+ * \struct key_hash
+ *
+ * \brief Default Hash of hashtablemap, calls the hash_key() overload of
+ *        the key type
+ */
+template <class Key>
+struct key_hash {
+  size_t operator()(const Key& k) const {
+    return hash_key(k);
+  }
+};
+
 /**
  * \class hashtablemap
  *
@@ -20,11 +92,17 @@ using namespace std;
  *        hash table. It follows STL idiom for easy plug and play.
  *        _Note_: As opposed to std::map, this container does throw
  *        runtime_error
+ *
+ * Open addressing with linear probing: the elements are stored in one
+ * flat array of slots, next to the hash of their key. The table doubles
+ * as soon as it is filled to 3/4, erasing shifts the following elements
+ * back instead of leaving tombstones. As for unordered containers,
+ * inserting and erasing invalidates iterators.
  */
-template <class Key, class T>
+template <class Key, class T, class Hash = key_hash<Key>, class Equal = equal_to<Key> >
 class hashtablemap
 {
-  typedef hashtablemap<Key, T>     Self;
+  typedef hashtablemap<Key, T, Hash, Equal> Self;
 
 public:
   typedef Key                key_type;
@@ -33,23 +111,19 @@ public:
   typedef pair<const Key, T> value_type;
   typedef unsigned int       size_type;
   typedef int                difference_type;
+  typedef Hash               hasher;
+  typedef Equal              key_equal;
 
 private:
-  /**
-   * \struct Node
-   *
-   * \brief data structure which holds the data
-   */
-  struct Node {
-  public:
-    Node(value_type val) : value_m(val) {}
-    value_type value_m;
-  };
-
-  typedef bstmap<Key, Node*> bucket_type;
+  /// capacity of the first allocation, power of 2
+  static const size_type MIN_CAPACITY = 16;
 
-  bucket_type* buckets_m;
-  int size_m;
+  value_type* values_m;    ///< raw storage, constructed where the hash is set
+  size_t*     hashes_m;    ///< 0 for empty slots
+  size_type   capacity_m;  ///< power of 2, 0 until the first insertion
+  size_type   size_m;
+  Hash        hash_m;
+  Equal       equal_m;
 
 
   ////////////////////////////////////////////////////////////////////////////////
@@ -62,44 +136,45 @@ public:
    */
   template <typename _T>
   class _iterator {
-    typedef input_iterator_tag iterator_category;
+    typedef forward_iterator_tag iterator_category;
     typedef _T value_type;
     typedef int difference_type;
     typedef value_type* pointer;
     typedef value_type& reference;
 
     friend class hashtablemap;
-        
+
   public:
-    _iterator(Node* n = NULL, const hashtablemap* ht = NULL) 
-      : node_m(n), table_m(ht) {}
-    
-    _iterator(const _iterator& x) 
-      : node_m(x.node_m), table_m(x.table_m) {}
+    _iterator(size_type i = 0, const hashtablemap* ht = NULL)
+      : index_m(i), table_m(ht) {}
+
+    _iterator(const _iterator& x)
+      : index_m(x.index_m), table_m(x.table_m) {}
 
     _iterator& operator=(const _iterator& x) {
-      node_m = x.node_m;
+      index_m = x.index_m;
+      table_m = x.table_m;
       return *this;
     }
 
-    reference operator*() {
-      return node_m->value_m;
+    reference operator*() const {
+      return table_m->values_m[index_m];
     }
 
-    pointer operator->() {
-      return &(node_m->value_m);
+    pointer operator->() const {
+      return &(table_m->values_m[index_m]);
     }
 
-    bool operator==(const _iterator& x) {
-      return (node_m == x.node_m);
+    bool operator==(const _iterator& x) const {
+      return (index_m == x.index_m);
     }
 
-    bool operator!=(const _iterator& x) {
-      return (node_m != x.node_m);
+    bool operator!=(const _iterator& x) const {
+      return (index_m != x.index_m);
     }
 
     _iterator& operator++() {
-      node_m = table_m->_get_next(node_m);
+      index_m = table_m->_next_full_slot(index_m + 1);
       return *this;
     }
 
@@ -109,7 +184,7 @@ public:
       return temp;
     }
 
-    Node* node_m;
+    size_type index_m;
     const hashtablemap* table_m;
   };
 
@@ -122,17 +197,20 @@ public:
   ////////////////////////////////////////////////////////////////////////////////
 
 public:
-  hashtablemap() : buckets_m(new bucket_type[NO_BUCKETS]), size_m(0) {}
-  
+  /**
+   * \brief Empty table, allocates nothing
+   */
+  explicit hashtablemap(const Hash& hash = Hash(), const Equal& equal = Equal())
+    : values_m(NULL), hashes_m(NULL), capacity_m(0), size_m(0),
+      hash_m(hash), equal_m(equal) {}
+
   /**
    * \brief overloads copy constructor for deep copy
    */
-  hashtablemap(const Self& x) : buckets_m(new bucket_type[NO_BUCKETS]), size_m(0) {
-    for (const_iterator i = x.begin(); i != x.end(); ++i) {
-      insert(*i);      /// insert one by one, which will be aweful for
-		       /// the treestructure, unfortunatly not enough
-		       /// time to balance tree properly --> Winterproject!
-    }
+  hashtablemap(const Self& x)
+    : values_m(NULL), hashes_m(NULL), capacity_m(0), size_m(0),
+      hash_m(x.hash_m), equal_m(x.equal_m) {
+    _copy(x);
   }
 
   /**
@@ -144,21 +222,22 @@ public:
       return *this;
     }
 
-    clear();
-    
-    for (const_iterator i = x.begin(); i != x.end(); ++i) {
-      insert(*i);      /// same balancing problem as for copy constructor above
-    }
+    _free();
+    hash_m = x.hash_m;
+    equal_m = x.equal_m;
+    _copy(x);
+
+    return *this;
   }
 
   /**
    * \brief free dynamic allocated members
    */
   ~hashtablemap() {
-    delete[] buckets_m;
+    _free();
   }
 
-  
+
   ////////////////////////////////////////////////////////////////////////////////
   /// Accessors
   ////////////////////////////////////////////////////////////////////////////////
@@ -168,66 +247,37 @@ public:
    *        with default value will be initialised
    */
   T& operator[](const Key& k) {
-    iterator it = find(k);
-    
-    if (it != end()) {            // found key
-      return (*it).second;
-    }
-    else {                        // not found -> create empty
-      insert(value_type(k, T()));
-      return operator[](k);       // a bit ugly
-    }
+    return (*(insert(value_type(k, T())).first)).second;
   }
 
-  /** 
-   * \return iterator keypair in first non-empty bucket
+  /**
+   * \return iterator keypair in first non-empty slot
    */
   iterator begin() {
-    if (empty()) {
-      return end();
-    }
-
-    // finds the first node in the first non-empty bucket
-    const bucket_type* first_filled_bucket = _find_next_nonempty_bucket(0);
-    assert(first_filled_bucket != NULL); // logic error if this occurs
-
-    Node* first_node = first_filled_bucket->begin()->second;
-    
-    return iterator(first_node, this);
+    return iterator(_next_full_slot(0), this);
   }
 
-  /** 
-   * \return const_iterator keypair in first non-empty bucket
-   * \todo use template!
-   */  
+  /**
+   * \return const_iterator keypair in first non-empty slot
+   */
   const_iterator begin() const {
-    if (empty()) {
-      return end();
-    }
-
-    // finds the first node in the first non-empty bucket
-    const bucket_type* first_filled_bucket = _find_next_nonempty_bucket(0);
-    assert(first_filled_bucket != NULL); // logic error if this occurs
-
-    Node* first_node = first_filled_bucket->begin()->second;
-    
-    return const_iterator(first_node, this);
+    return const_iterator(_next_full_slot(0), this);
   }
 
   /**
    * \return iterator "past-the-end" element
    */
   iterator end() {
-    return iterator(NULL, this);
+    return iterator(capacity_m, this);
   }
 
   /**
    * \return const+iterator "past-the-end" element
    */
   const_iterator end() const {
-    return const_iterator(NULL, this);
+    return const_iterator(capacity_m, this);
   }
-  
+
   bool empty() const {
     return (size_m == 0);
   }
@@ -238,85 +288,93 @@ public:
 		   // elements
   }
 
+  /**
+   * \return number of slots, the table grows before it is filled to 3/4
+   */
+  size_type bucket_count() const {
+    return capacity_m;
+  }
+
+  hasher hash_function() const {
+    return hash_m;
+  }
+
+  key_equal key_eq() const {
+    return equal_m;
+  }
+
 
   ////////////////////////////////////////////////////////////////////////////////
   /// Insert and Erase
   ////////////////////////////////////////////////////////////////////////////////
 
   /**
-   * \brief seperate chaining approach for insertion in order to
-   *        prevent primary clustering
+   * \brief linear probing from the slot of the hash, until the key or
+   *        an empty slot is found
    *
-   * \return pair<iterator, bool> iterator to node in tree, bool is
+   * \return pair<iterator, bool> iterator to the element, bool is
    *         true if an insertion has been done
    */
   pair<iterator, bool> insert(const value_type& x) {
-    iterator it = find(x.first);
+    size_t hash = _hash(x.first);
+    size_type index = _find(x.first, hash);
 
     // element exists already
-    if (it != end()) {
-      return pair<iterator, bool>(iterator(it.node_m, this), false);
+    if (index != capacity_m) {
+      return pair<iterator, bool>(iterator(index, this), false);
     }
 
-    // insert new node
-    int hash = _hash(x.first);
-    Node* new_node = new Node(x);
-      
-    const pair<Key, Node*> keypair(x.first, new_node);
-    buckets_m[hash].insert(keypair);
+    // grow before the load factor exceeds 3/4
+    if (4 * (size_m + 1) > 3 * capacity_m) {
+      _rehash(capacity_m == 0 ? MIN_CAPACITY : 2 * capacity_m);
+    }
 
+    index = _place(x, hash);
     ++size_m;
 
-    return pair<iterator, bool>(iterator(new_node, this), true);
+    return pair<iterator, bool>(iterator(index, this), true);
   }
 
   /**
    * \brief erase by iterator
    */
   void erase(iterator pos) throw (runtime_error) {
-    if (pos == NULL) {
-      throw runtime_error("Cannot erase Null iterator");
+    if (pos.index_m >= capacity_m || hashes_m[pos.index_m] == 0) {
+      throw runtime_error("Cannot erase invalid iterator");
     }
 
-    erase(pos->first);
+    _erase_slot(pos.index_m);
   }
 
   /**
-   * \brief erase by Key value 
-   * 
+   * \brief erase by Key value
+   *
    * \return size_type number of elements erased (in this case can
    *         only be 1 or 0)
    */
   size_type erase(const Key& x) {
-    iterator it = find(x);
-    
-    if (it == end()) { // Key not found
+    size_type index = _find(x, _hash(x));
+
+    if (index == capacity_m) { // Key not found
       return 0;
     }
-    
-    int hash = _hash(x);
-    assert(buckets_m[hash].find(x) != buckets_m[hash].end());
 
-    buckets_m[hash].erase(x);
-    --size_m;
-    
+    _erase_slot(index);
+
     return 1; // since Key in maps are unique, can only be 1
   }
 
   /**
-   * \brief Empty all buckets
-   * 
-   * Does not uses iterator in order to save the "searching for
-   * non-empty buckets" step.
+   * \brief Empty all slots, keeps the capacity
    */
   void clear() {
-    if (empty()) {
-      return;
+    for (size_type i = 0; i < capacity_m; ++i) {
+      if (hashes_m[i] != 0) {
+	values_m[i].~value_type();
+	hashes_m[i] = 0;
+      }
     }
 
-    delete[] buckets_m;
-    buckets_m = new bucket_type[NO_BUCKETS];
-
     size_m = 0;
   }
 
@@ -326,30 +384,34 @@ public:
   ////////////////////////////////////////////////////////////////////////////////
 
   iterator find(const Key& x) {
-    int hash = _hash(x);
-    
-    bucket_type* b = &buckets_m[hash];   // Use pointer to prevent copying
-    typename bucket_type::iterator it = b->find(x);
-
-    if (it == b->end()) {
-      return end();
-    }
-
-    return iterator((*it).second, this);
+    return iterator(_find(x, _hash(x)), this);
   }
 
-  /// \todo use template
   const_iterator find(const Key& x) const {
-    int hash = _hash(x);
-    
-    bucket_type* b = &buckets_m[hash];   // Use pointer to prevent copying whole map
-    typename bucket_type::iterator it = b->find(x);
+    return const_iterator(_find(x, _hash(x)), this);
+  }
 
-    if (it == b->end()) {
+  /**
+   * \brief find by a stand-in for a Key, which saves building the Key
+   *        (e.g. a name which is not a string yet, see SymbolManager).
+   *        hash has to be what Hash returns for the Key which x stands
+   *        for, and key == x has to compare a Key to x
+   */
+  template <class K>
+  iterator find_as(const K& x, size_t hash) {
+    hash = _mix(hash);
+    if (size_m == 0) {
       return end();
     }
 
-    return const_iterator((*it).second, this);
+    size_type mask = capacity_m - 1;
+    for (size_type i = hash & mask; hashes_m[i] != 0; i = (i + 1) & mask) {
+      if (hashes_m[i] == hash && values_m[i].first == x) {
+	return iterator(i, this);
+      }
+    }
+
+    return end();
   }
 
   /**
@@ -368,71 +430,156 @@ public:
   /// Helpers
   ////////////////////////////////////////////////////////////////////////////////
 private:
-  
+
   /**
-   * \brief Hash function uses simple modulus approach. Additionally
-   *        radix is used to further randomize the bucket location a
-   *        bit more
-  */
-  int _hash(Key k) const {
-    // lazy stringstream method
-    // \todo use bytewise hashing rather than characterwise
-    stringstream ss; ss << k;
-
-    const char* str = ss.str().c_str(); // just use cstring so we
-					// don't need to include
-					// strlen
-    int hash = 0;
-
-    for (int i = 0; str[i] != 0; ++i) {
-      // takes modulus in every step to prevent loosing precision due
-      // to too big numbers
-      hash = (hash + (( (int) str[i] * RADIX^i ) % NO_BUCKETS) ) % NO_BUCKETS;
-    }
+   * \brief Hash of the key, never 0 since 0 marks empty slots. The slot
+   *        is taken from the low bits, which are weak for FNV (they only
+   *        depend on the low bits of the characters), therefore the high
+   *        bits are mixed in
+   */
+  size_t _hash(const Key& k) const {
+    return _mix(hash_m(k));
+  }
+
+  static size_t _mix(size_t hash) {
+    hash ^= hash >> 15;
+    hash *= 0x2c1b3c6du;
+    hash ^= hash >> 12;
 
-    return hash;
+    return hash == 0 ? 1 : hash;
   }
 
   /**
-   * returns a constant type to add security (there should be no
-   * need to change the content of the bucket)
+   * \return slot of the key, capacity_m if not found
    */
-  const bucket_type* _find_next_nonempty_bucket(int const curr_index) const {
-    for (int i = curr_index + 1; i < NO_BUCKETS; ++i) {
-      if (!buckets_m[i].empty()) {
-	return &buckets_m[i];
+  size_type _find(const Key& k, size_t hash) const {
+    if (size_m == 0) {
+      return capacity_m;
+    }
+
+    size_type mask = capacity_m - 1;
+    for (size_type i = hash & mask; hashes_m[i] != 0; i = (i + 1) & mask) {
+      if (hashes_m[i] == hash && equal_m(values_m[i].first, k)) {
+	return i;
       }
     }
 
-    return NULL;
+    return capacity_m;
   }
 
   /**
-   * \brief Used for iteration.
-   * \return Node* returns NULL if there are no following Nodes
+   * \brief Copies x into the first empty slot from its hash on. There
+   *        has to be one
+   * \return slot of the new element
+   */
+  size_type _place(const value_type& x, size_t hash) {
+    size_type mask = capacity_m - 1;
+    size_type i = hash & mask;
+
+    while (hashes_m[i] != 0) {
+      i = (i + 1) & mask;
+    }
+
+    new (&values_m[i]) value_type(x);
+    hashes_m[i] = hash;
+
+    return i;
+  }
+
+  /**
+   * \brief Removes the element of a slot and shifts the following
+   *        elements of the cluster back, if that brings them closer to
+   *        their own slot. Therefore no tombstones are needed
    */
-  Node* _get_next(Node* n) const {    
-    Key k = n->value_m.first;
-    int hash = _hash(k);
+  void _erase_slot(size_type hole) {
+    size_type mask = capacity_m - 1;
+
+    values_m[hole].~value_type();
+    hashes_m[hole] = 0;
+    --size_m;
 
-    /// \todo memory is wasted here
-    bucket_type curr_bucket = buckets_m[hash]; 
-    typename bucket_type::iterator next = ++(curr_bucket.find(k));
+    for (size_type i = (hole + 1) & mask; hashes_m[i] != 0; i = (i + 1) & mask) {
+      size_type home = hashes_m[i] & mask;
 
-    // is there an element in current bucket?
-    if (next != curr_bucket.end()) {
-      return next->second;
+      // the element stays if its home lies cyclically in (hole, i]
+      bool stays = (hole <= i) ? (hole < home && home <= i)
+	                       : (hole < home || home <= i);
+      if (stays) {
+	continue;
+      }
+
+      new (&values_m[hole]) value_type(values_m[i]);
+      hashes_m[hole] = hashes_m[i];
+      values_m[i].~value_type();
+      hashes_m[i] = 0;
+      hole = i;
     }
+  }
 
-    const bucket_type* next_bucket = _find_next_nonempty_bucket(hash);
-      
-    // is this the last element?
-    if (next_bucket == NULL) {
-      return NULL;  /// similarly, end()
+  /**
+   * \brief Moves all elements into a table with capacity slots
+   */
+  void _rehash(size_type capacity) {
+    value_type* old_values = values_m;
+    size_t*     old_hashes = hashes_m;
+    size_type   old_capacity = capacity_m;
+
+    values_m = static_cast<value_type*>(::operator new(capacity * sizeof(value_type)));
+    hashes_m = new size_t[capacity]();
+    capacity_m = capacity;
+
+    for (size_type i = 0; i < old_capacity; ++i) {
+      if (old_hashes[i] != 0) {
+	_place(old_values[i], old_hashes[i]);
+	old_values[i].~value_type();
+      }
     }
 
-    // return first node of next non-empty bucket
-    return next_bucket->begin()->second;
+    ::operator delete(old_values);
+    delete[] old_hashes;
+  }
+
+  /**
+   * \brief Inserts all elements of x, the table has to be empty
+   */
+  void _copy(const Self& x) {
+    if (x.size_m == 0) {
+      return;
+    }
+
+    _rehash(x.capacity_m);
+    for (size_type i = 0; i < x.capacity_m; ++i) {
+      if (x.hashes_m[i] != 0) {
+	_place(x.values_m[i], x.hashes_m[i]);
+      }
+    }
+    size_m = x.size_m;
+  }
+
+  /**
+   * \brief Destroys all elements and frees the slots
+   */
+  void _free() {
+    clear();
+
+    ::operator delete(values_m);
+    delete[] hashes_m;
+
+    values_m = NULL;
+    hashes_m = NULL;
+    capacity_m = 0;
+  }
+
+  /**
+   * \brief Used for iteration.
+   * \return first slot from index on which holds an element, capacity_m
+   *         if there is none
+   */
+  size_type _next_full_slot(size_type index) const {
+    while (index < capacity_m && hashes_m[index] == 0) {
+      ++index;
+    }
+    return index;
   }
 
 };
@@ -0,0 +1,632 @@
+/**
+ * \file image.cpp
+ *
+ * Implementation of the image.hpp interface.
+ *
+ * An image starts with a key: the version of its layout, size and hash
+ * of the library and size and modification time of the program. It is
+ * only loaded if the key still matches. Without the file of the program
+ * there is no key, and images are neither loaded nor written. The cells follow in an order
+ * where every cell comes after the cells it refers to, so they are
+ * created in a single pass. References are relocatable:
+ *
+ *     xxxx...xx01   int (value shifted by two)
+ *     0000...0010   nil
+ *     xxxx...xx00   cell (index + 1, shifted by two)
+ *
+ * Symbols and builtins are stored by name and interned again, the
+ * global definitions and the expressions of the library which are not
+ * definitions refer to the cells. Compiled code is not stored,
+ * procedures are compiled again when they are called.
+ */
+
+#include "image.hpp"
+#include "cons.hpp"
+#include "DefinitionManager.hpp"
+#include "FunctionManager.hpp"
+#include "GarbageCollector.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sys/stat.h>
+#include <unistd.h>
+
+typedef unsigned long long word;
+
+/// increase whenever the layout of an image changes
+static const word IMAGE_VERSION = 2;
+static const char IMAGE_MAGIC[] = "SCMIMAGE";
+
+enum Kind {
+  KIND_SYMBOL,
+  KIND_BUILTIN,
+  KIND_CONS,
+  KIND_DOUBLE,
+  KIND_BIGINT,
+  KIND_PROCEDURE
+};
+
+/**
+ * \struct Key
+ *
+ * \brief What an image has been made from
+ */
+struct Key {
+  word library_size_m;
+  word library_hash_m;
+  word program_size_m;
+  word program_time_m;
+
+  bool operator==(const Key& other) const {
+    return library_size_m == other.library_size_m
+      && library_hash_m == other.library_hash_m
+      && program_size_m == other.program_size_m
+      && program_time_m == other.program_time_m;
+  }
+};
+
+static bool read_file(const string& path, string& content) {
+  ifstream in(path.c_str(), ios::in | ios::binary);
+  if (!in) {
+    return false;
+  }
+  in.seekg(0, ios::end);
+  content.resize((size_t) in.tellg());
+  in.seekg(0, ios::beg);
+  if (!content.empty()) {
+    in.read(&content[0], content.size());
+  }
+  return !in.fail();
+}
+
+/**
+ * \brief Finds the file of the running program: /proc/self/exe where
+ *        there is one, program itself if it names a directory, and the
+ *        directories in PATH otherwise, like the shell did
+ * \return false if the program has not been found
+ */
+static bool stat_program(const string& program, struct stat& info) {
+  if (stat("/proc/self/exe", &info) == 0) {
+    return true;
+  }
+  if (program.find('/') != string::npos) {
+    return stat(program.c_str(), &info) == 0;
+  }
+
+  const char* path = getenv("PATH");
+  if (path == NULL) {
+    return false;
+  }
+  string directories(path);
+  for (size_t begin = 0; begin <= directories.size(); ) {
+    size_t end = directories.find(':', begin);
+    if (end == string::npos) {
+      end = directories.size();
+    }
+    /// an empty entry is the current directory
+    string directory = directories.substr(begin, end - begin);
+    string candidate = (directory.empty() ? "." : directory) + "/" + program;
+    if (stat(candidate.c_str(), &info) == 0 && S_ISREG(info.st_mode)
+	&& access(candidate.c_str(), X_OK) == 0) {
+      return true;
+    }
+    begin = end + 1;
+  }
+  return false;
+}
+
+static bool make_key(const string& library, const string& program, Key& key) {
+  string content;
+  if (!read_file(library, content)) {
+    return false;
+  }
+
+  /// FNV-1a
+  word hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < content.size(); ++i) {
+    hash = (hash ^ (unsigned char) content[i]) * 1099511628211ULL;
+  }
+  key.library_size_m = content.size();
+  key.library_hash_m = hash;
+
+  /// an image of an unknown program could be loaded by any other one
+  struct stat info;
+  if (!stat_program(program, info)) {
+    return false;
+  }
+  key.program_size_m = info.st_size;
+  key.program_time_m = info.st_mtime;
+  return true;
+}
+
+static void put(string& out, word w) {
+  out.append((const char*) &w, sizeof(w));
+}
+
+static void put(string& out, const string& s) {
+  put(out, (word) s.size());
+  out += s;
+}
+
+
+//////////////////////////////////////////
+// ImageWriter
+
+/**
+ * \class ImageWriter
+ *
+ * \brief Collects the cells reachable from the global definitions
+ */
+class ImageWriter {
+public:
+  ImageWriter() : no_cells_m(0), no_definitions_m(0), no_startup_m(0) {}
+
+  /**
+   * \return false if a cell reachable from value cannot be stored
+   */
+  bool add_definition(const SymbolCell* symbol, Cell* value);
+
+  /**
+   * \return false if a cell reachable from the expression cannot be stored
+   */
+  bool add_startup(Cell* expression);
+
+  bool write(const string& image, const Key& key, const vector<OutputRecorder::Chunk>& output);
+
+private:
+  map<Cell*, word> index_m;
+  string           cells_m;
+  word             no_cells_m;
+  string           definitions_m;
+  word             no_definitions_m;
+  string           startup_m;
+  word             no_startup_m;
+
+  /**
+   * \brief Stores c and everything reachable from it, children first
+   */
+  bool visit(Cell* c);
+
+  /**
+   * \brief Stores c, its children have to be stored already
+   */
+  bool emit(Cell* c);
+
+  word reference(Cell* c);
+};
+
+bool ImageWriter::add_definition(const SymbolCell* symbol, Cell* value) {
+  if (!visit((Cell*) symbol) || !visit(value)) {
+    return false;
+  }
+  put(definitions_m, reference((Cell*) symbol));
+  put(definitions_m, reference(value));
+  ++no_definitions_m;
+  return true;
+}
+
+bool ImageWriter::add_startup(Cell* expression) {
+  if (!visit(expression)) {
+    return false;
+  }
+  put(startup_m, reference(expression));
+  ++no_startup_m;
+  return true;
+}
+
+bool ImageWriter::visit(Cell* c) {
+  /// lists may be long, so the children are not visited recursively
+  vector< pair<Cell*, bool> > stack;
+  stack.push_back(make_pair(c, false));
+
+  while (!stack.empty()) {
+    Cell* current = stack.back().first;
+    bool expanded = stack.back().second;
+    stack.pop_back();
+
+    if (is_immediate(current) || index_m.find(current) != index_m.end()) {
+      continue;
+    }
+    if (expanded) {
+      if (!emit(current)) {
+	return false;
+      }
+      continue;
+    }
+
+    stack.push_back(make_pair(current, true));
+    if (current->is_symbol()) {
+      /// its definition is stored on its own
+    } else if (current->is_cons()) {
+      stack.push_back(make_pair(cdr(current), false));
+      stack.push_back(make_pair(car(current), false));
+    } else if (current->is_lambda()) {
+      stack.push_back(make_pair(get_body(current), false));
+      stack.push_back(make_pair(get_formals(current), false));
+    }
+  }
+  return true;
+}
+
+bool ImageWriter::emit(Cell* c) {
+  string record;
+
+  if (c->is_symbol()) {
+    const SymbolCell* interned = get_interned(c);
+    if (interned == c) {
+      put(record, (word) KIND_SYMBOL);
+    } else if (FunctionManager::Instance()->get_builtin(interned) == c) {
+      put(record, (word) KIND_BUILTIN);
+    } else {
+      return false;
+    }
+    put(record, get_symbol(c));
+  } else if (c->is_cons()) {
+    put(record, (word) KIND_CONS);
+    put(record, reference(car(c)));
+    put(record, reference(cdr(c)));
+  } else if (c->is_lambda()) {
+    put(record, (word) KIND_PROCEDURE);
+    put(record, reference(get_formals(c)));
+    put(record, reference(get_body(c)));
+  } else if (c->is_bigint()) {
+    put(record, (word) KIND_BIGINT);
+    put(record, get_bigint(c).to_string());
+  } else if (c->is_double()) {
+    double d = get_double(c);
+    word bits;
+    memcpy(&bits, &d, sizeof(bits));
+    put(record, (word) KIND_DOUBLE);
+    put(record, bits);
+  } else {
+    return false;
+  }
+
+  cells_m += record;
+  index_m[c] = no_cells_m++;
+  return true;
+}
+
+word ImageWriter::reference(Cell* c) {
+  if (nullp(c)) {
+    return NIL_BITS;
+  }
+  if (is_fixnum(c)) {
+    return ((word) (long long) decode_fixnum(c) << 2) | FIXNUM_TAG;
+  }
+  return (index_m[c] + 1) << 2;
+}
+
+bool ImageWriter::write(const string& image, const Key& key,
+			const vector<OutputRecorder::Chunk>& output) {
+  string out(IMAGE_MAGIC, sizeof(IMAGE_MAGIC) - 1);
+  put(out, IMAGE_VERSION);
+  put(out, key.library_size_m);
+  put(out, key.library_hash_m);
+  put(out, key.program_size_m);
+  put(out, key.program_time_m);
+
+  put(out, no_cells_m);
+  out += cells_m;
+  put(out, no_definitions_m);
+  out += definitions_m;
+  put(out, no_startup_m);
+  out += startup_m;
+
+  put(out, (word) output.size());
+  for (size_t i = 0; i < output.size(); ++i) {
+    put(out, (word) output[i].error_m);
+    put(out, output[i].text_m);
+  }
+
+  /// other processes must never see a partial image
+  string temporary = image + ".tmp";
+  ofstream file(temporary.c_str(), ios::out | ios::binary | ios::trunc);
+  file.write(out.data(), out.size());
+  file.close();
+  if (file.fail()) {
+    remove(temporary.c_str());
+    return false;
+  }
+  return rename(temporary.c_str(), image.c_str()) == 0;
+}
+
+
+//////////////////////////////////////////
+// ImageReader
+
+/**
+ * \class ImageReader
+ *
+ * \brief Reads the parts of an image, every read fails at its end
+ */
+class ImageReader {
+public:
+  ImageReader(const char* begin, const char* end)
+    : pos_m(begin), end_m(end) {}
+
+  bool get(word& w) {
+    if ((size_t) (end_m - pos_m) < sizeof(w)) {
+      return false;
+    }
+    memcpy(&w, pos_m, sizeof(w));
+    pos_m += sizeof(w);
+    return true;
+  }
+
+  bool get(string& s) {
+    word size;
+    if (!get(size) || (word) (end_m - pos_m) < size) {
+      return false;
+    }
+    s.assign(pos_m, (size_t) size);
+    pos_m += size;
+    return true;
+  }
+
+  /**
+   * \brief Reads a reference to an immediate cell or one of cells
+   */
+  bool get(const vector<Cell*>& cells, Cell*& c) {
+    word ref;
+    if (!get(ref)) {
+      return false;
+    }
+    if ((ref & IMMEDIATE_MASK) == FIXNUM_TAG) {
+      c = make_int((int) ((long long) ref >> 2));
+      return true;
+    }
+    if (ref == NIL_BITS) {
+      c = nil;
+      return true;
+    }
+    word index = ref >> 2;
+    if ((ref & IMMEDIATE_MASK) != 0 || index == 0 || index > cells.size()) {
+      return false;
+    }
+    c = cells[index - 1];
+    return true;
+  }
+
+  bool at_end() const {
+    return pos_m == end_m;
+  }
+
+private:
+  const char* pos_m;
+  const char* end_m;
+};
+
+/**
+ * \brief Creates the cell of the next record
+ * \return NULL if the record is broken
+ */
+static Cell* load_cell(ImageReader& in, const vector<Cell*>& cells) {
+  word kind;
+  if (!in.get(kind)) {
+    return NULL;
+  }
+
+  string name;
+  Cell* first;
+  Cell* second;
+  word bits;
+
+  switch (kind) {
+  case KIND_SYMBOL:
+    return in.get(name) ? make_symbol(name) : NULL;
+  case KIND_BUILTIN:
+    if (!in.get(name)) {
+      return NULL;
+    }
+    return (Cell*) FunctionManager::Instance()->get_builtin(SymbolManager::Instance()->intern(name));
+  case KIND_CONS:
+    if (!in.get(cells, first) || !in.get(cells, second)) {
+      return NULL;
+    }
+    return cons(first, second);
+  case KIND_PROCEDURE:
+    if (!in.get(cells, first) || !in.get(cells, second)) {
+      return NULL;
+    }
+    return lambda(first, second);
+  case KIND_BIGINT:
+    if (!in.get(name)) {
+      return NULL;
+    }
+    try {
+      return make_integer(BigInt(name));
+    } catch (runtime_error&) {
+      return NULL;
+    }
+  case KIND_DOUBLE:
+    if (!in.get(bits)) {
+      return NULL;
+    }
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    return make_double(d);
+  default:
+    return NULL;
+  }
+}
+
+
+//////////////////////////////////////////
+// Interface
+
+bool load_image(const string& image, const string& library, const string& program,
+		vector<Cell*>& startup) {
+  Key key;
+  string content;
+  if (!make_key(library, program, key) || !read_file(image, content)) {
+    return false;
+  }
+
+  size_t magic = sizeof(IMAGE_MAGIC) - 1;
+  if (content.compare(0, magic, IMAGE_MAGIC) != 0) {
+    return false;
+  }
+  ImageReader in(content.data() + magic, content.data() + content.size());
+
+  Key stored;
+  word version;
+  if (!in.get(version) || version != IMAGE_VERSION
+      || !in.get(stored.library_size_m) || !in.get(stored.library_hash_m)
+      || !in.get(stored.program_size_m) || !in.get(stored.program_time_m)
+      || !(stored == key)) {
+    return false;
+  }
+
+  word no_cells;
+  if (!in.get(no_cells)) {
+    return false;
+  }
+  vector<Cell*> cells;
+  for (word i = 0; i < no_cells; ++i) {
+    Cell* c = load_cell(in, cells);
+    if (c == NULL) {
+      return false;
+    }
+    cells.push_back(c);
+  }
+
+  word no_definitions;
+  if (!in.get(no_definitions)) {
+    return false;
+  }
+  vector< pair<Cell*, Cell*> > definitions;
+  for (word i = 0; i < no_definitions; ++i) {
+    Cell* symbol;
+    Cell* value;
+    if (!in.get(cells, symbol) || !in.get(cells, value) || !symbolp(symbol)) {
+      return false;
+    }
+    definitions.push_back(make_pair(symbol, value));
+  }
+
+  word no_startup;
+  if (!in.get(no_startup)) {
+    return false;
+  }
+  vector<Cell*> expressions;
+  for (word i = 0; i < no_startup; ++i) {
+    Cell* expression;
+    if (!in.get(cells, expression)) {
+      return false;
+    }
+    expressions.push_back(expression);
+  }
+
+  word no_chunks;
+  if (!in.get(no_chunks)) {
+    return false;
+  }
+  vector<OutputRecorder::Chunk> output;
+  for (word i = 0; i < no_chunks; ++i) {
+    word error;
+    OutputRecorder::Chunk chunk;
+    if (!in.get(error) || !in.get(chunk.text_m)) {
+      return false;
+    }
+    chunk.error_m = error != 0;
+    output.push_back(chunk);
+  }
+  if (!in.at_end()) {
+    return false;
+  }
+
+  for (size_t i = 0; i < definitions.size(); ++i) {
+    DefinitionManager::Instance()->add_definition(get_interned(definitions[i].first),
+						  definitions[i].second);
+  }
+  for (size_t i = 0; i < expressions.size(); ++i) {
+    GarbageCollector::Instance()->pin(expressions[i]);
+    startup.push_back(expressions[i]);
+  }
+  for (size_t i = 0; i < output.size(); ++i) {
+    (output[i].error_m ? cerr : cout) << output[i].text_m;
+  }
+  return true;
+}
+
+bool save_image(const string& image, const string& library, const string& program,
+		const vector<OutputRecorder::Chunk>& output, const vector<Cell*>& startup) {
+  Key key;
+  if (!make_key(library, program, key)) {
+    return false;
+  }
+
+  vector<const SymbolCell*> globals;
+  DefinitionManager::Instance()->get_globals(globals);
+
+  ImageWriter writer;
+  for (size_t i = 0; i < globals.size(); ++i) {
+    Cell* value = DefinitionManager::Instance()->get_definition(globals[i]);
+    if (!writer.add_definition(globals[i], value)) {
+      return false;
+    }
+  }
+  for (size_t i = 0; i < startup.size(); ++i) {
+    if (!writer.add_startup(startup[i])) {
+      return false;
+    }
+  }
+  return writer.write(image, key, output);
+}
+
+
+//////////////////////////////////////////
+// OutputRecorder
+
+OutputRecorder::OutputRecorder()
+  : out_m(cout.rdbuf(), false, output_m), err_m(cerr.rdbuf(), true, output_m) {
+  cout.rdbuf(&out_m);
+  cerr.rdbuf(&err_m);
+}
+
+OutputRecorder::~OutputRecorder() {
+  cout.rdbuf(out_m.get_original());
+  cerr.rdbuf(err_m.get_original());
+}
+
+const vector<OutputRecorder::Chunk>& OutputRecorder::get_output() const {
+  return output_m;
+}
+
+OutputRecorder::Tee::Tee(streambuf* original, bool error, vector<Chunk>& output)
+  : original_m(original), error_m(error), output_m(output) {}
+
+streambuf* OutputRecorder::Tee::get_original() const {
+  return original_m;
+}
+
+int OutputRecorder::Tee::overflow(int c) {
+  if (c == EOF) {
+    return 0;
+  }
+  char ch = (char) c;
+  record(&ch, 1);
+  return original_m->sputc(ch);
+}
+
+streamsize OutputRecorder::Tee::xsputn(const char* s, streamsize n) {
+  record(s, n);
+  return original_m->sputn(s, n);
+}
+
+int OutputRecorder::Tee::sync() {
+  return original_m->pubsync();
+}
+
+void OutputRecorder::Tee::record(const char* s, streamsize n) {
+  if (output_m.empty() || output_m.back().error_m != error_m) {
+    Chunk chunk;
+    chunk.error_m = error_m;
+    output_m.push_back(chunk);
+  }
+  output_m.back().text_m.append(s, (size_t) n);
+}
@@ -0,0 +1,126 @@
+/**
+ * \file image.hpp
+ *
+ * Encapsulates the interface for images of the heap after the library
+ * has been read: the global definitions, the output of reading them and
+ * the other expressions of the library, which are evaluated again on
+ * every start. Loading an image replaces reading the library.
+ */
+
+#ifndef IMAGE_HPP
+#define IMAGE_HPP
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Cell.hpp"
+
+using namespace std;
+
+/**
+ * \class OutputRecorder
+ *
+ * \brief Records everything written to cout and cerr while it exists.
+ *        The output is still written to the streams.
+ */
+class OutputRecorder {
+public:
+  /**
+   * \struct Chunk
+   *
+   * \brief Consecutive output to one stream
+   */
+  struct Chunk {
+    bool   error_m;      ///< written to cerr, cout otherwise
+    string text_m;
+  };
+
+  /**
+   * \brief Starts recording
+   */
+  OutputRecorder();
+
+  /**
+   * \brief Stops recording
+   */
+  ~OutputRecorder();
+
+  /**
+   * \return the recorded output in the order it has been written
+   */
+  const vector<Chunk>& get_output() const;
+
+private:
+  /**
+   * \class Tee
+   *
+   * \brief Unbuffered streambuf which writes to the original streambuf of
+   *        a stream and appends to the recorded output
+   */
+  class Tee : public streambuf {
+  public:
+    Tee(streambuf* original, bool error, vector<Chunk>& output);
+
+    streambuf* get_original() const;
+
+  protected:
+    virtual int overflow(int c);
+    virtual streamsize xsputn(const char* s, streamsize n);
+    virtual int sync();
+
+  private:
+    streambuf*     original_m;
+    bool           error_m;
+    vector<Chunk>& output_m;
+
+    void record(const char* s, streamsize n);
+  };
+
+  vector<Chunk> output_m;
+  Tee           out_m;
+  Tee           err_m;
+
+  /**
+   * \brief Makes sure there is no copy constructor
+   */
+  OutputRecorder(OutputRecorder const&);
+
+  /**
+   * \brief Makes sure no assignments are possible
+   */
+  void operator=(OutputRecorder const&);
+};
+
+/**
+ * \brief Loads the image, if it has been made from the current library
+ *        by the current program: defines the global definitions and
+ *        writes the recorded output again. Has to be called before
+ *        GarbageCollector::set_stack_bottom(), the cells of the image are
+ *        not reachable until all of them have been loaded.
+ * \param image path of the image
+ * \param library path of the library the image has been made from
+ * \param program path of the running program (argv[0]), only used if
+ *        /proc/self/exe does not exist
+ * \param startup gets the expressions of the library which are not
+ *        definitions. They are pinned, the caller evaluates and unpins them
+ * \return false if there is no image of the current library and program
+ *         or the file of the program has not been found, nothing has
+ *         been defined then
+ */
+bool load_image(const string& image, const string& library, const string& program,
+		vector<Cell*>& startup);
+
+/**
+ * \brief Writes an image of the global definitions after the library has
+ *        been read. Nothing is written if a definition cannot be stored
+ *        (e.g. it has been made by a builtin added at runtime) or the
+ *        file of the program has not been found
+ * \param output what has been written while reading the library
+ * \param startup the expressions of the library which are not definitions
+ * \return false if the image has not been written
+ */
+bool save_image(const string& image, const string& library, const string& program,
+		const vector<OutputRecorder::Chunk>& output, const vector<Cell*>& startup);
+
+#endif // IMAGE_HPP
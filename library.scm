@@ -7,11 +7,6 @@
 (define dumpln 
   (lambda args (print args)))
 (define nil (quote ()))
-(define length
-  (lambda (list)
-    (if (null? list)
-	0
-	(+ 1 (length (cdr list))))))
 
 (comment _________________________________________________________ )
 (comment ASSIGNMENT FUNCTIONS )
@@ -37,53 +32,6 @@
   (lambda (list)
     (cons (car (cdr list)) (cons (car list) (quote ())))))
 (define neg (lambda (x) (< x 0)))
-(define list-tail 
-  (lambda (list k)
-    (if (not (intp k))
-	(print (quote INT_REQUIRED_ERROR))
-	(if (< (length list) k)
-	    (print (quote OUT_OF_BOUND_ERROR))
-	    (if (< k 2)
-		list
-		(list-tail (cdr list) (- k 1)))))))
-(define list-ref
-  (lambda (list k)
-    (car (list-tail list k))))
-(define append
-  (lambda (list1 list2)
-    (if (nullp list1)
-	list2
-	(cons (car list1) (append (cdr list1) list2)))))
-(define reverse
-  (lambda (list)
-    (if (nullp (cdr list))
-        list
-	(append (reverse (cdr list)) (cons (car list) (quote ()))))))
-(define equal?
-  (lambda (l1 l2)
-    (if (list? l1)
-	(if (not (list? l2))
-	    0
-	    (if (not (= (length l1) (length l2)))
-		0
-		(if (null? l1)
-		    1
-		    (if (list? (car l1))
-			(if (list? (car l2))
-			    (equal? (cdr l1) (cdr l2))
-			    0)
-			(if (= (car l1) (car l2))
-			    (equal? (cdr l1) (cdr l2))
-			    0)))))
-	(= l1 l2))))
-
-(define assoc
-  (lambda (key dict)
-    (if (nullp dict)
-	0
-	(if (= key (car (car dict)))
-	    (car dict)
-	    (assoc key (cdr dict))))))
 
 (define append2car
   (lambda (elem list)
@@ -116,50 +64,6 @@
 		    (list-same (cdr list))
 		    0))))))
 
-(define list-partition-pivot
-  (lambda (proc list)
-    (if (nullp list)
-	(quote (()()))
-	(if (proc pivot (car list))
-	    (append2car (car list) (list-partition-pivot proc (cdr list)))
-	    (append2cdr (car list) (list-partition-pivot proc (cdr list)))))))
-(define remove-pivot
-  (lambda (pivot list)
-    (if (nullp list)
-	(quote ())
-	(if (= pivot (car list))
-	    (remove-pivot pivot (cdr list))
-	    (cons (car list) (remove-pivot pivot (cdr list)))))))
-(define clone-pivot
-  (lambda (pivot num)
-    (if (< num 1)
-	(quote ())
-	(cons pivot (clone-pivot pivot (- num 1))))))
-(define count-pivot
-  (lambda (pivot list)
-    (if (nullp list)
-	0
-	(if (= pivot (car list))
-	    (+ 1 (count-pivot pivot (cdr list)))
-	    (count-pivot pivot (cdr list))))))
-(define list-sort
-  (lambda (proc list)
-    (if (not (nullp list))
-	(define pivot (car list)))
-    (if (nullp list)
-	list
-	(if (< (length list) 2)
-	    list
-	    (append 
-	     (append 
-	      (list-sort 
-	       proc 
-	       (car (cdr (list-partition-pivot proc (remove-pivot pivot list)))))
-	      (clone-pivot pivot (count-pivot pivot list)))
-	     (list-sort 
-	      proc 
-	      (car (list-partition-pivot proc (remove-pivot pivot list)))))))))
-
 (define even?
   (lambda (n)
     (if (< n 0)
@@ -210,8 +114,8 @@
 	(print-field (cdr field)))))
 
 (comment _________________________________________________________ )
-(comment PSEUDO RANDOM ACCESS ARRAY USING STRING HACK )
-(comment Note: have to convert list to string first using (str) )
+(comment RANDOM ACCESS ARRAY USING A STRING )
+(comment Note: have to convert list to string first using (symbol->string (str)) )
 (define pos
   (lambda (x y)
     (+ 3 
@@ -224,16 +128,53 @@
        1)))
 (define set
   (lambda (field-str x y val)
-    (appstr (appstr (substr field-str 
-			    0 
-			    (- (pos x y) 1))
-		    val)
-	    (substr field-str 
-		    (pos x y) 
-		    (- (size) (pos x y))))))
+    (string-set! field-str (- (pos x y) 1) val)
+    field-str))
 (define get
   (lambda (field-str x y)
-    (substr field-str (- (pos x y) 1) 1)))
+    (string-ref field-str (- (pos x y) 1))))
+
+(comment _________________________________________________________ )
+(comment RANDOM ACCESS ARRAY USING VECTORS )
+(comment Note: the field is a vector of rows, which are vectors as well.
+               Reading and writing a square takes constant time)
+(define vector->list
+  (lambda (v)
+    (vector->list-from v nil (vector-length v))))
+(define vector->list-from
+  (lambda (v rest i)
+    (if (= i 0)
+	rest
+	(vector->list-from v (cons (vector-ref v (- i 1)) rest) (- i 1)))))
+(define create-vrows
+  (lambda (field y)
+    (if (= y f_height)
+	field
+	(create-vrows (vset-row field y (make-vector f_width space_symbol))
+		      (+ y 1)))))
+(define create-vfield
+  (lambda ()
+    (create-vrows (make-vector f_height) 0)))
+(define vset-row
+  (lambda (field y row)
+    (vector-set! field y row)
+    field))
+(define vset
+  (lambda (field x y val)
+    (vector-set! (vector-ref field y) x val)
+    field))
+(define vget
+  (lambda (field x y)
+    (vector-ref (vector-ref field y) x)))
+(define print-vrows
+  (lambda (field y)
+    (print (vector->list (vector-ref field y)))
+    (if (< (+ y 1) (vector-length field))
+	(print-vrows field (+ y 1))
+	nil)))
+(define print-vfield
+  (lambda (field)
+    (print-vrows field 0)))
 
 (comment _________________________________________________________ )
 (comment GENERATE SMALLER ELEMENTS SUCH AS DOORS AND WALLS )
@@ -333,17 +274,31 @@
 (define example-strarr 
   (lambda () 
     (print-field (parse (gen-vwall 
-			 (gen-vwall (str (create-field)) 0 (- f_height 1) 1)
+			 (gen-vwall (symbol->string (str (create-field))) 0 (- f_height 1) 1)
 			 0 (- f_height 1) 3)))))
 (define example-list 
   (lambda () 
     (print-field (add-list-vertical-wall
 		  (add-list-vertical-wall (create-field) 1 f_height)
 		  3 f_height))))
+(define add-vector-vertical-wall
+  (lambda (field x height)
+    (if (= height 0)
+	field
+	(vset (add-vector-vertical-wall field x (- height 1))
+	      x (- height 1) wall_symbol))))
+(define example-vector
+  (lambda ()
+    (print-vfield (add-vector-vertical-wall
+		   (add-vector-vertical-wall (create-vfield) 1 f_height)
+		   3 f_height))))
 (define example-performance
   (lambda ()
     (out START PERFORMANCE COMPARISON)
-    (out Array using my fast 'pseudo random access' array)
+    (out Array using vectors with real random access)
+    (example-vector)
+    (out)
+    (out Array using a string with random access)
     (example-strarr)
     (out)
     (out Array using slow cons list)
@@ -353,7 +308,7 @@
 (comment LABYRINTH EXAMPLES )
 (define example-labyrinth
   (lambda ()
-    (print-field (parse (gen-labyrinth (str (create-field)))))))
+    (print-field (parse (gen-labyrinth (symbol->string (str (create-field))))))))
 
 
 (comment _________________________________________________________ )
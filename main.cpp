@@ -10,136 +10,67 @@
 #include <stdexcept>
 #include "parse.hpp"
 #include "eval.hpp"
+#include "GarbageCollector.hpp"
+#include "image.hpp"
+#include "OutputManager.hpp"
 #include <sstream>
 
 using namespace std;
 
+/// read before the input
+static const char* const LIBRARY       = "library.scm";
+static const char* const LIBRARY_IMAGE = "library.img";
+
 /**
- * \brief Parse and evaluate the s-expression, and print the result.
- * \param sexpr The string vaule holding the s-expression.
+ * \brief Evaluate the parse tree, and print the result.
+ * \param root The parse tree of the s-expression.
  */
-void parse_eval_print(string sexpr)
+void eval_print(Cell* root)
 {
+  /// the parse tree has to survive collections while it is evaluated
+  GarbageCollector::Instance()->pin(root);
   try {
-    Cell* root = parse(sexpr);
-    //    cout << endl;
-    //    cout << *root << endl;
     Cell* result = eval(root);
     if ( result == nil ) {
-      cout << "()" << endl;
+      cout << "()" << '\n';
     } else {
-      cout << *result << endl;
+      print_cell(cout, result);
+      cout << '\n';
     }
-    // delete root;
-    // delete result;
   } catch (runtime_error &e) {
     cerr << "ERROR: " << e.what() << endl;
   } catch (logic_error &e) {
     cerr << "LOGIC ERROR: " << e.what() << endl;
+    cout.flush();
     exit(1);
   }
+  /// root and result are freed by the next collection
+  GarbageCollector::Instance()->unpin(root);
 }
 
 /**
- * \brief Read single single symbol into the end of a string buffer.
- * \param fin The input file stream.
- * \param str The string buffer.
+ * \brief Parse and evaluate the s-expression, and print the result.
+ * \param sexpr The string vaule holding the s-expression.
  */
-void readsinglesymbol(ifstream& fin, string& str)
+void parse_eval_print(const string& sexpr)
 {
-  char currentchar;
-  fin.get(currentchar);
-  if (fin.eof()) {
-    return;
-  }
-  if (currentchar == '\"') {
-    // read a string literal
-    do {
-      str += currentchar;
-      fin.get(currentchar);
-    } while (currentchar != '\"');
-    str += currentchar;
-  } else {
-    do {
-      str += currentchar;
-      fin.get(currentchar);
-    } while ((false == iswhitespace(currentchar)) 
-	     && ('(' != currentchar) 
-	     && (false == fin.eof()));
-    fin.putback(currentchar);  
-  }
+  eval_print(parse(sexpr));
 }
 
 /**
  * \brief Read, parse, evaluate, and print the expression one by one from
- * the input stream.
+ * the input stream. Every expression is evaluated as soon as it is read,
+ * the stream is read in big chunks by the Reader.
  *
  * \param fin The input file stream.
  */
 void readfile(ifstream& fin)
 {
-  string sexp;
-  bool isstartsexp = false;
-  int inumleftparenthesis = 0;
-
-  // check whether to read the end
-  while (!fin.eof()) {
-    // read char by char
-    char currentchar;
-    fin.get(currentchar);
-    if (fin.eof()) {
-      break;
-    }
-
-    // skip some white space before new s-expression occurs
-    if ((true == iswhitespace(currentchar))&&(false == isstartsexp)) {
-      continue;
-    }
-    // run across a new s-expression
-    if ((false == isstartsexp)&&(false == iswhitespace(currentchar))) {
-      // check whether single symbol
-      if ('(' != currentchar)	{
-	// read a single symbol
-	fin.putback(currentchar);
-	readsinglesymbol(fin, sexp);
-	// call function
-	parse_eval_print(sexp);
-	sexp.clear();
-      }	else {
-	// start new expression
-	isstartsexp = true;
-	// read left parenthesis
-	sexp += currentchar;
-	inumleftparenthesis = 1;
-      }
-    } else {
-      // in the process of reading the current s-expression
-      if (true == isstartsexp) {
-	if (true == iswhitespace(currentchar)) {
-	  // append a blankspace
-	  //sexp += ' ';
-	  sexp += currentchar;
-	} else {
-	  // append current character
-	  sexp += currentchar;
-	  // count left parenthesis
-	  if ('(' == currentchar) {
-	    inumleftparenthesis ++;
-	  }
-	  if (')' == currentchar) {
-	    inumleftparenthesis --;
-	    // check whether current s-expression ends
-	    if (0 == inumleftparenthesis) {
-	      // current s-expression ends
-	      isstartsexp  =  false;
-	      // call functions
-	      parse_eval_print(sexp);
-	      sexp.clear();
-	    }
-	  }
-	}
-      }
-    }
+  Reader reader(fin);
+  while (!reader.at_end()) {
+    Cell* root = reader.read();
+    // an illegal expression evaluates to nil
+    eval_print(root == NULL ? nil : root);
   }
 }
 
@@ -147,13 +78,55 @@ void readfile(ifstream& fin)
  * \brief Read the expressions from the file.
  * \param fn The file name.
  */
-void readfile(char* fn)
+void readfile(const char* fn)
 {
   ifstream fin(fn);
   readfile(fin);
   fin.close();
 }
 
+/**
+ * \brief Read the library. Only the definitions are evaluated, so only
+ * their output is recorded for the image. Every other expression (e.g.
+ * the call which draws the labyrinth of the start) is kept, pinned, in
+ * startup, and has to be evaluated on every start by readstartup().
+ *
+ * \param fn The file name.
+ * \param startup The expressions which are not definitions.
+ */
+void readlibrary(const char* fn, vector<Cell*>& startup)
+{
+  ifstream fin(fn);
+  Reader reader(fin);
+  while (!reader.at_end()) {
+    Cell* root = reader.read();
+    bool definition = root != NULL && listp(root) && !nullp(root)
+      && symbolp(car(root)) && get_symbol(car(root)) == "define";
+    if (root != NULL && !definition) {
+      GarbageCollector::Instance()->pin(root);
+      startup.push_back(root);
+    } else {
+      eval_print(root == NULL ? nil : root);
+    }
+  }
+  fin.close();
+}
+
+/**
+ * \brief Evaluate and print the expressions of the library which are not
+ * definitions, in their order, and unpin them.
+ *
+ * \param startup The expressions, see readlibrary().
+ */
+void readstartup(vector<Cell*>& startup)
+{
+  for (size_t i = 0; i < startup.size(); ++i) {
+    eval_print(startup[i]);
+    GarbageCollector::Instance()->unpin(startup[i]);
+  }
+  startup.clear();
+}
+
 /**
  * \brief Read, parse, evaluate, and print the expression one by one from
  * the standard input, interactively.
@@ -180,12 +153,31 @@ void readconsole()
  */
 int main(int argc, char* argv[])
 {
-  // read from the standard input
-  readfile("library.scm");
+  // cout is buffered from here on
+  OutputManager::Instance();
+
+  // an image of the definitions saves reading the library again. It has
+  // to be loaded before anything can be collected
+  vector<Cell*> startup;
+  bool loaded = load_image(LIBRARY_IMAGE, LIBRARY, argv[0], startup);
+
+  // the collector scans the C++ stack from here on for living cells
+  GarbageCollector::Instance()->set_stack_bottom(&argc);
+
+  if (!loaded) {
+    // read the library, and make an image of it for the next start
+    OutputRecorder recorder;
+    readlibrary(LIBRARY, startup);
+    save_image(LIBRARY_IMAGE, LIBRARY, argv[0], recorder.get_output(), startup);
+  }
+
+  // the rest of the library is evaluated again on every start
+  readstartup(startup);
 
   switch(argc) {
   case 1:
     readconsole();
+    cout.flush();
     exit(0);
     break;
   case 2:
@@ -194,6 +186,7 @@ int main(int argc, char* argv[])
     break;
   default:
     cout << "too many arguments!" << endl;
+    cout.flush();
     exit(0);
   }
   return 0;
@@ -6,7 +6,10 @@
  */
 
 #include "parse.hpp"
-bool inparsecar;
+
+#include <cstdlib>
+#include <cstring>
+
 // check whether chr is white space
 bool iswhitespace(char ch)
 {
@@ -19,15 +22,15 @@ bool iswhitespace(char ch)
 
 
 /**
- * \brief Check whether numericstr is an legal numericstr string
- * \param str The string to be checked
+ * \brief Check whether the token is a legal numeric literal
+ * \param str The token to be checked, it need not be terminated
+ * \param length The number of characters of the token, at least 1
  * \return ture if numericstr is an legal numericstr string, false otherwise
  */
-bool is_legalnumeric(string str) 
+bool is_legalnumeric(const char* str, size_t length)
 {
   int dotnum = 0;
-  int length = str.length();
-  int i;
+  size_t i;
   if ('.' == str[0]) {
     dotnum ++;
   } else if ( !((str[0] >= '0') && (str[0] <= '9')) && ('+'!=str[0]) && ('-'!=str[0])) {
@@ -48,333 +51,302 @@ bool is_legalnumeric(string str)
 
 /**
  * \brief Check whether str is a legal operator
- * 
+ *
  */
-bool is_legaloperator(string str)
+bool is_legaloperator(const char* str, size_t length)
 {
   return true;
 }
 
-void readsinglesymbol(string& substring, string& sexpr)
-{
-  char currentchar;
-  int i = 0;
-  int length = substring.length();
-
-  // get the first character
-  currentchar = substring[i];
-
-  if (currentchar == '\"') {
-    // read a string literal
-    sexpr += currentchar;
-    do {
-      ++i;
-      currentchar = substring[i];
-      sexpr += currentchar;
-    } while (currentchar != '\"' && i < length-1);
-    if ('\"' != currentchar) {
-      cout << "error: illegal string" << endl;
-      exit(1);
-    }
-  } else {
-    // read a numeric literal or operator
-    do {
-      sexpr += currentchar;
-      ++i;
-      if (i >= static_cast<int>(substring.size())) {
-	break;
-      }
-      currentchar = substring[i];
-    } while ((!iswhitespace(currentchar)) && (currentchar != '(') && currentchar != '\"');
-    --i;
-  }
-  substring = substring.substr(i+1, length - i - 1);
-}
-
-
 /**
- * \brief Clear the whitespace at the begining and end of string sexpr.
- * \param sexpr The string.
+ * \brief Value of a legal integer literal of at most 18 digits, which
+ *        therefore fits into a long long
  */
-void clearwhitespace(string& sexpr)
+static long long parse_integer(const char* str, size_t length)
 {
-  if (sexpr.size() <= 0) {
-    return;
-  }
-  int leftvalidpos;
-  int rightvalidpos;
-  int length = sexpr.size();
-  int i;
-  // most left non-whitespace position
-  for (i = 0; i < length; ++i) {
-    if (iswhitespace(sexpr[i])) {
-      continue;
-    } else {
-      leftvalidpos = i;
-      break;
-    }
+  size_t i = 0;
+  if (('+' == str[0]) || ('-' == str[0])) {
+    i = 1;
   }
-
-  // most right non-whitespace position
-  for (i = length - 1; i >= 0; i --) {
-    if (iswhitespace(sexpr[i])) {
-      continue;
-    } else {
-      rightvalidpos = i;
-      break;
-    }
+  long long value = 0;
+  for (; i < length; i ++) {
+    value = value * 10 + (str[i] - '0');
   }
-
-  // delete the white space at the beginning and end
-  if ( i == -1 ) sexpr = "";
-  else sexpr  =  sexpr.substr(leftvalidpos, rightvalidpos - leftvalidpos + 1);
+  return '-' == str[0] ? -value : value;
 }
 
 /**
- * \brief Check whether the s-expression legal
+ * \brief Value of a legal double literal
  */
-bool is_legalexpr(string sexpr)
+static double parse_double(const char* str, size_t length)
 {
-  clearwhitespace(sexpr);
-  if (sexpr.length()==0) {
-    cout << "blank string " << endl;
-    return false;
+  /// strtod needs a terminated string. Literals are short, so they are
+  /// terminated in a copy on the stack
+  char digits[64];
+  if (length < sizeof(digits)) {
+    memcpy(digits, str, length);
+    digits[length] = '\0';
+    return strtod(digits, NULL);
   }
-  if (')' == sexpr[0]) {
-    cout << "error: illegal s-expression" << endl;
-    return false;
-  }
-  if ('(' == sexpr[0]) {
-    // it is expression
-    int length = sexpr.length();
-    int inumleftparenthesis = 1;
-    int i;
-    int quotationmark = 0;
-    for (i = 1; i < length; i ++ ) {
-      if ('\"' == sexpr[i]) {
-        quotationmark ++;
-        quotationmark = quotationmark%2;
-      } else if ('(' == sexpr[i] && 0 == quotationmark) {
-        inumleftparenthesis ++;
-      } else if (')' == sexpr[i] && 0 == quotationmark) {
-        inumleftparenthesis --;
-      }
-      if (0 == inumleftparenthesis) {
-        break;
-      }
-    }
-    if ((i < length - 1) || (i == length) || (inumleftparenthesis > 0) || 0 != quotationmark) {
-      cout << "error: illegal s-expression " << endl;
-      return false;
-    }
-  } else if ('\"' != sexpr[0]) {
-    // single element
-    if (string::npos != sexpr.find('(') || string::npos != sexpr.find(')') || string::npos != sexpr.find(' ') || string::npos != sexpr.find('\"'))  {
-      cout << "error: illegal s-expression " << endl;
-      return false;
-    }
-    // check whether str is illegal numeric literal or illegal operator
-    if ((false == is_legalnumeric(sexpr)) && (false ==is_legaloperator(sexpr))) {
-      cout << "error: illegal numeric literal or illegal operator" << endl;
-      return false;
-    }
-  } else {
-    int length = sexpr.length();
-    int inumleft = 1;
-    int i;
-    for (i = 1; i < length; i ++) {
-      if ('\"' == sexpr[i]) {
-        inumleft ++;
-      }
-      if (2 == inumleft) {
-        break;
-      }
-    }
-    if ((i < length-1) || (inumleft != 2)) {
-      cout << "error: illegal s-expression " << endl;
-      return false;
-    }
-  }
-  return true;
+  return strtod(string(str, length).c_str(), NULL);
 }
 
 /**
- * \brief Make the cell.
- * \param str The string to represent the symbol, int or double.
+ * \brief Make the cell. Numbers are converted in place and symbols
+ *        interned in place, nothing is copied on the way.
+ * \param str The token to represent the symbol, int, double or string.
+ *        It need not be terminated.
+ * \param length The number of characters of the token, at least 1.
  */
-Cell* makecell(string str)
+Cell* makecell(const char* str, size_t length)
 {
   Cell* root;
-  if (((str[0] >= '0') && (str[0] <= '9')) || (str[0] == '.') 
-      || ((('+'==str[0]) || ('-'==str[0]))&&(str.length()>1))) {
-    if (false == is_legalnumeric(str)) {
+  if (((str[0] >= '0') && (str[0] <= '9')) || (str[0] == '.')
+      || ((('+'==str[0]) || ('-'==str[0]))&&(length>1))) {
+    if (false == is_legalnumeric(str, length)) {
       cout << "error: illegal numeric literal" << endl;
       exit(1);
     }
     // this is a numeric literal
-    if (string::npos == str.find('.')) {
-      // int number
-      char* fchar = const_cast<char*>(str.c_str());
-      int value = atoi(fchar);
-      root = make_int(value);
+    if (NULL == memchr(str, '.', length)) {
+      // int number, a bigint if it does not fit into an int
+      if (length < 10) {
+	root = make_int((int) parse_integer(str, length));
+      } else if (length < 19) {
+	root = make_integer(BigInt(parse_integer(str, length)));
+      } else {
+	root = make_integer(BigInt(string(str, length)));
+      }
     } else {
       // this is a double
-      char* fchar = const_cast<char*>(str.c_str());
-      double value = atof(fchar);   
-      root = make_double(value);
+      root = make_double(parse_double(str, length));
     }
-  } 
-  
-  // we don't deal with literal strings right now, so they are commented out
-  // else if (str[0] == '\"') {
-//     // this is a string literal
-//     string strval = str.substr(1, str.size() - 2);
-//     root = make_string(const_cast<char*>(strval.data()));
-//   } 
+  }
+
+  else if (str[0] == '\"') {
+    // this is a string literal, the token includes both quotes
+    root = make_string(str + 1, length - 2);
+  }
   else {
     // this is a symbol
-    if (false == is_legaloperator(str)) {
+    if (false == is_legaloperator(str, length)) {
       cout << "error: illegal operator" << endl;
       exit(1);
     }
-    root = make_symbol(const_cast<char*>(str.data()));
+    root = make_symbol(str, length);
   }
   return root;
 }
 
-Cell* separate_parse(string& sexpr); 
+/**
+ * \brief Reports an illegal s-expression
+ * \return NULL
+ */
+static Cell* illegal()
+{
+  cout << "error: illegal s-expression" << endl;
+  return NULL;
+}
+
+const size_t Reader::BUFFER_SIZE;
+const size_t Reader::WINDOW_SIZE;
+
+Reader::Reader(const string& sexpr)
+  : in_m(NULL), scanned_m(sexpr.data()), end_m(sexpr.data() + sexpr.size()),
+    window_m(NULL), next_m(0), atom_m(NULL), before_paren_m(false) {}
 
-Cell* parse(string sexpr)
+Reader::Reader(istream& in)
+  : in_m(&in), buffer_m(BUFFER_SIZE), scanned_m(NULL), end_m(NULL),
+    window_m(NULL), next_m(0), atom_m(NULL), before_paren_m(false) {}
+
+bool Reader::at_end()
 {
-  // is_legal(sexpr);
-  // delete the whitesapce at the begining and end
-  // such that the first and last character are not white space
-  clearwhitespace(sexpr);
-//   if (sexpr.length() == 0) {
-//     return nil;
-//   }
-  if (sexpr.length() == 0) {
-    return nil;
+  const char* p;
+  while (peek(p)) {
+    if (!iswhitespace(*p)) {
+      return false;
+    }
+    ++next_m;
   }
-  if ( !is_legalexpr(sexpr)) {
+  return true;
+}
+
+Cell* Reader::read()
+{
+  const char* p;
+  if (!next(p)) {
     return nil;
   }
-  // check whether is single symbol
-  // i.e. leaf cell
-  // if (string::npos == sexpr.find('(')) {
-  if ('(' != sexpr[0]) {
-    // this is leaf cell
-    // bulid this leaf cell
-    Cell* root = makecell( sexpr );
-    return root;
+
+  ConsCell* root = (ConsCell*) cons(nil, nil);
+  vector<Level> levels;
+  Level top = { root, NULL, false, NULL };
+  levels.push_back(top);
+
+  /// reads one element of the top level, and the elements of the lists
+  /// it consists of. Nothing behind the element is read
+  do {
+    char currentchar = *p;
+    if ('(' == currentchar) {
+      Level list = { append(levels.back(), nil), NULL, false, NULL };
+      levels.push_back(list);
+    } else if (')' == currentchar) {
+      if (levels.size() == 1) {
+	return illegal();
+      }
+      Level& list = levels.back();
+      if (list.dot_m != NULL) {
+	/// exactly one element follows the dot, it becomes the tail
+	Cell* tail = list.dot_m->cdr;
+	if (nullp(tail) || !nullp(cdr(tail))) {
+	  return illegal();
+	}
+	list.dot_m->cdr = car(tail);
+      }
+      if (list.vector_m) {
+	list.slot_m->car = list_to_vector(list.slot_m->car);
+      }
+      levels.pop_back();
+    } else {
+      const char* token;
+      size_t length;
+      if (!read_token(p, token, length)) {
+	return illegal();
+      }
+      if (1 == length && '.' == *token) {
+	/// a dot needs an element in front of it, in a list and not a vector
+	Level& list = levels.back();
+	if (levels.size() == 1 || list.vector_m || list.last_m == NULL || list.dot_m != NULL) {
+	  return illegal();
+	}
+	list.dot_m = list.last_m;
+      } else if (1 == length && '#' == *token && before_paren_m) {
+	/// #( opens a vector literal, # on its own is a symbol
+	next(p);
+	Level vector = { append(levels.back(), nil), NULL, true, NULL };
+	levels.push_back(vector);
+      } else {
+	append(levels.back(), makecell(token, length));
+      }
+    }
+  } while (levels.size() > 1 && next(p));
+
+  if (levels.size() > 1) {
+    return illegal();
   }
+  return car(car(root));
+}
 
-  // the first and last character are '(' and ')', respectively
-  // delete the two characters
-  int length = sexpr.size();
-  sexpr = sexpr.substr(1, length-2);
-  clearwhitespace(sexpr);
-  length = sexpr.size();
-//   if ( inparsecar ) {
-//     if (sexpr == "") {
-//       Cell* ec = new Cell("()");
-//       return ec;
-//     }
-//   }
-  // separate the s-expression into two left and right subsexps
-  Cell* root = separate_parse(sexpr);
+bool Reader::fill()
+{
+  if (in_m == NULL) {
+    return false;
+  }
+  if (atom_m != NULL) {
+    token_m.append(atom_m, end_m);
+    atom_m = end_m;
+  }
+  in_m->read(&buffer_m[0], buffer_m.size());
+  if (in_m->gcount() <= 0) {
+    return false;
+  }
+  scanned_m = &buffer_m[0];
+  end_m = scanned_m + in_m->gcount();
+  if (atom_m != NULL) {
+    atom_m = scanned_m;
+  }
+  return true;
+}
 
-  return root;
+bool Reader::peek(const char*& p)
+{
+  while (next_m == index_m.size()) {
+    if (scanned_m == end_m && !fill()) {
+      return false;
+    }
+    const char* stop = (size_t) (end_m - scanned_m) > WINDOW_SIZE ?
+      scanned_m + WINDOW_SIZE : end_m;
+    index_m.clear();
+    next_m = 0;
+    window_m = scanned_m;
+    scanner_m.scan(window_m, stop, index_m);
+    scanned_m = stop;
+  }
+  p = window_m + index_m[next_m];
+  return true;
 }
 
-/**
- * \brief Separately parse the sexpr and build the tree.
- * \param instr The string which consists of s-expressions.
- * \return A pointer to the conspair cell at the root of the parse tree.
- */
-Cell* separate_parse(string& instr)
+bool Reader::next(const char*& p)
 {
-  string sexp;
-  bool isstartsexp = false;
-  int inumleftparenthesis = 0;
+  if (at_end()) {
+    return false;
+  }
+  peek(p);
+  ++next_m;
+  return true;
+}
 
-  // check whether to read the end
-  clearwhitespace(instr);
-  int length = instr.size();
-    // check whether it is a "()" sexpr
+bool Reader::read_token(const char* begin, const char*& token, size_t& length)
+{
+  token_m.clear();
+  atom_m = begin;
+  bool literal = '\"' == *begin;
 
-  while (instr.size() > 0) {
-    // read char by char
-    char currentchar = instr[0];
-    // skip some white space before new s-expression occurs
-    if ((true == iswhitespace(currentchar))&&(false == isstartsexp)) {
-      continue;
+  /// the entry behind the beginning is the end of the atom. The atom
+  /// may continue in the next buffer
+  const char* end;
+  bool found = peek(end);
+  if (literal) {
+    if (!found) {
+      /// a string literal has to be terminated
+      atom_m = NULL;
+      return false;
     }
-    // run accross a new s-expression
-    if ((false == isstartsexp)&&(false == iswhitespace(currentchar))) {
-      // check whether single symbol
-      if ('(' != currentchar) {
-	// read single a single symbol
-	readsinglesymbol(instr, sexp);
-	clearwhitespace(instr);  
-	inparsecar = true;
-	Cell* car = parse(sexp);
-	inparsecar = false;
-	Cell* cdr = parse("(" + instr + ")");
-	Cell* root = cons(car, cdr);
-	sexp.clear();
-	return root;
-      } else {
-	// start new expression
-	isstartsexp = true;
-	// read left parenthesiss
-	sexp += currentchar;
-	instr = instr.substr(1, instr.size() -1);
-	inumleftparenthesis = 1;
-      }
-    } else {
-      // in the process of reading the current s-expression
-      if (true == isstartsexp) {
-	if (true == iswhitespace(currentchar)) {
-	  // append a blankspace
-	  sexp += ' ';
-	  instr = instr.substr(1, instr.size() -1);
-	} else {
-	  // append current character
-	  sexp += currentchar;
-	  instr = instr.substr(1, instr.size() -1);
-	  // count left parenthesiss
-	  if ('(' == currentchar) {
-	    inumleftparenthesis ++;
-	  }
-	  if (')' == currentchar) {
-	    inumleftparenthesis --;
+    ++next_m;
+    ++end;
+  } else if (!found) {
+    end = end_m;
+  } else if (iswhitespace(*end)) {
+    ++next_m;
+  }
+  before_paren_m = !literal && found && '(' == *end;
 
-	    // check whether current s-expression ends
-	    if (0 == inumleftparenthesis) {
-	      // current s-expression ends
-	      isstartsexp = false;
-	      clearwhitespace(instr);
-	      inparsecar = true;
-	      Cell* car = parse(sexp);        
-	      inparsecar = false;
-	      int length = instr.length();
-	      Cell* cdr;
-	      Cell* root;
-	      if (length <= 0) {
-		cdr = nil;
-	      } else {
-		cdr = parse("(" + instr + ")");       
-	      }
-	      root = cons(car, cdr);
-	      sexp.clear();
-	      return root;     
-	    }
-	  }
-	}
-      }
-    }
+  /// the token is taken from the buffer, unless a part of it has been
+  /// moved to token_m already
+  if (token_m.empty()) {
+    token = atom_m;
+    length = end - atom_m;
+  } else {
+    token_m.append(atom_m, end);
+    token = token_m.data();
+    length = token_m.size();
+  }
+  atom_m = NULL;
+  return true;
+}
+
+ConsCell* Reader::append(Level& level, Cell* c)
+{
+  ConsCell* cell = (ConsCell*) cons(c, nil);
+  if (level.last_m == NULL) {
+    level.slot_m->car = cell;
+  } else {
+    level.last_m->cdr = cell;
   }
+  level.last_m = cell;
+  return cell;
+}
 
-  return nil;
+Cell* parse(const string& sexpr)
+{
+  Reader reader(sexpr);
+  Cell* root = reader.read();
+  if (root == NULL) {
+    return nil;
+  }
+  if (!reader.at_end()) {
+    illegal();
+    return nil;
+  }
+  return root;
 }
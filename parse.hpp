@@ -10,18 +10,138 @@
 #define PARSE_HPP
 
 #include "cons.hpp"
+#include "scan.hpp"
+
+#include <istream>
+#include <vector>
 
 using namespace std;
 
 /**
- * \brief Recursively parse sexpr and build the parse tree.  \param
- * sexpr The s-expression stored in a string variable (note that this
- * version of parse has side effects: it may alter the contents of
- * sexpr).
+ * \class Reader
+ *
+ * \brief Reads s-expressions in a single pass, either from a string or
+ *        buffered from a stream. The text is scanned ahead in windows by
+ *        a Scanner, the Reader only visits the structural characters of
+ *        its index: parentheses, quotes and where atoms begin and end.
+ *        The cons cells are built while reading: lists are built front
+ *        to back by appending to their last cons cell (friend of
+ *        ConsCell), so nesting does not recurse and the input is never
+ *        copied. A vector literal #(1 2 3) is read as a list, which is
+ *        turned into a vector when it is closed. A dot in front of the
+ *        last element of a list makes that element its tail, (1 2 . 3)
+ *        is read as the improper list the printer writes that way.
+ *
+ * Allocating cells may trigger a collection. Everything under
+ * construction is reachable from a root cell which is a local variable
+ * of read() and therefore found by the conservative scan of the C++
+ * stack.
+ */
+class Reader {
+public:
+  /// bytes read from a stream at once
+  static const size_t BUFFER_SIZE = 1 << 20;
+
+  /// bytes scanned at once
+  static const size_t WINDOW_SIZE = 1 << 16;
+
+  /**
+   * \brief Constructor for a Reader of sexpr, which has to live as long
+   *        as the Reader
+   */
+  Reader(const string& sexpr);
+
+  /**
+   * \brief Constructor for a Reader of the stream in
+   */
+  Reader(istream& in);
+
+  /**
+   * \brief Skips whitespace
+   * \return true if there is nothing left to read
+   */
+  bool at_end();
+
+  /**
+   * \brief Reads the next s-expression. Nothing behind its end is read,
+   *        the closing parenthesis of a list is the last character
+   * \return the tree of the s-expression, nil at the end of the input and
+   *         NULL (after reporting it) if the s-expression is illegal
+   */
+  Cell* read();
+
+private:
+  /**
+   * \struct Level
+   *
+   * \brief A list which is being read
+   */
+  struct Level {
+    ConsCell* slot_m;   ///< its car is the list, once it is not empty
+    ConsCell* last_m;   ///< last cons cell of the list, NULL while empty
+    bool      vector_m; ///< the list becomes a vector when it is closed
+    ConsCell* dot_m;    ///< cons cell in front of the dot, NULL if none
+  };
+
+  istream*     in_m;      ///< NULL if reading a string
+  vector<char> buffer_m;
+  const char*  scanned_m; ///< end of the scanned part of the text
+  const char*  end_m;
+  Scanner      scanner_m;
+  vector<unsigned int> index_m;   ///< structural characters of the window
+  const char*  window_m;  ///< the offsets of index_m are relative to it
+  size_t       next_m;    ///< next entry of index_m
+  const char*  atom_m;    ///< beginning of an unfinished atom, NULL else
+  string       token_m;   ///< an atom which spans two buffers
+  bool         before_paren_m;  ///< the last token is followed by (
+
+  /**
+   * \brief Reads the next part of the stream into the buffer. The part
+   *        of an unfinished atom in the old buffer is moved to token_m
+   * \return false at the end of the input
+   */
+  bool fill();
+
+  /**
+   * \brief Finds the next structural character, scans the next window
+   *        if necessary
+   * \return false at the end of the input
+   */
+  bool peek(const char*& p);
+
+  /**
+   * \brief Finds the next structural character which is not whitespace
+   *        and moves behind it
+   * \return false at the end of the input
+   */
+  bool next(const char*& p);
+
+  /**
+   * \brief Finds the end of a string literal or a symbol or numeric
+   *        literal which begins at begin. The token refers to the
+   *        buffer, only an atom which continues in the next buffer is
+   *        put together in token_m. Either way it is valid until the
+   *        next token is read
+   * \return false if a string literal is not terminated
+   */
+  bool read_token(const char* begin, const char*& token, size_t& length);
+
+  /**
+   * \brief Appends c to the list of level
+   * \return the new last cons cell of the list
+   */
+  static ConsCell* append(Level& level, Cell* c);
+};
+
+/**
+ * \brief Parse sexpr and build the parse tree, in a single pass over
+ * sexpr.
+ * \param sexpr The s-expression stored in a string variable.
  *
- * \return A pointer to the conspair cell at the root of the parse tree.
+ * \return A pointer to the conspair cell at the root of the parse tree,
+ * nil if sexpr is blank or not a legal s-expression.
  */
-Cell* parse(string sexpr);
+Cell* parse(const string& sexpr);
 
 /**
  * \brief Check whether the character is whitespace.
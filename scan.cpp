@@ -0,0 +1,233 @@
+/**
+ * \file scan.cpp
+ *
+ * Implementation of the Scanner. A block of 64 characters is classified
+ * into three bitmasks (whitespace, parentheses, double quotes), the rest
+ * is plain bit arithmetic on the masks:
+ *
+ *     literal  prefix xor of the quotes: the opening quote and the inside
+ *              of every literal
+ *     atom     neither a delimiter nor inside a literal
+ *     starts   atom characters whose predecessor is not one
+ *     ends     whitespace whose predecessor is an atom character
+ */
+
+#include "scan.hpp"
+
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SCAN_X86
+#include <immintrin.h>
+#endif
+
+static const size_t BLOCK = 64;
+
+/**
+ * \struct Masks
+ *
+ * \brief Classes of the characters of a block, bit i for character i
+ */
+struct Masks {
+  unsigned long long whitespace_m;
+  unsigned long long paren_m;
+  unsigned long long quote_m;
+};
+
+/**
+ * \brief Classes of the characters: 1 whitespace, 2 parenthesis, 4 quote.
+ *        Characters from 128 on are never structural
+ */
+static const unsigned char classes[256] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 1, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  1, 0, 4, 0, 0, 0, 0, 0, 2, 2, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+static void classify_scalar(const char* block, Masks& m) {
+  m.whitespace_m = m.paren_m = m.quote_m = 0;
+  for (size_t i = 0; i < BLOCK; ++i) {
+    unsigned char c = classes[(unsigned char) block[i]];
+    m.whitespace_m |= (unsigned long long) (c & 1) << i;
+    m.paren_m      |= (unsigned long long) ((c >> 1) & 1) << i;
+    m.quote_m      |= (unsigned long long) (c >> 2) << i;
+  }
+}
+
+#ifdef SCAN_X86
+
+__attribute__((target("sse2")))
+static void classify_sse2(const char* block, Masks& m) {
+  const __m128i space = _mm_set1_epi8(' ');
+  const __m128i newline = _mm_set1_epi8('\n');
+  const __m128i tab = _mm_set1_epi8('\t');
+  const __m128i cr = _mm_set1_epi8('\r');
+  const __m128i open = _mm_set1_epi8('(');
+  const __m128i close = _mm_set1_epi8(')');
+  const __m128i quote = _mm_set1_epi8('\"');
+
+  m.whitespace_m = m.paren_m = m.quote_m = 0;
+  for (size_t i = 0; i < BLOCK; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i*) (block + i));
+    __m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, newline)),
+			      _mm_or_si128(_mm_cmpeq_epi8(v, tab), _mm_cmpeq_epi8(v, cr)));
+    __m128i paren = _mm_or_si128(_mm_cmpeq_epi8(v, open), _mm_cmpeq_epi8(v, close));
+
+    m.whitespace_m |= (unsigned long long) (unsigned int) _mm_movemask_epi8(ws) << i;
+    m.paren_m      |= (unsigned long long) (unsigned int) _mm_movemask_epi8(paren) << i;
+    m.quote_m      |= (unsigned long long) (unsigned int)
+      _mm_movemask_epi8(_mm_cmpeq_epi8(v, quote)) << i;
+  }
+}
+
+__attribute__((target("avx2")))
+static void classify_avx2(const char* block, Masks& m) {
+  const __m256i space = _mm256_set1_epi8(' ');
+  const __m256i newline = _mm256_set1_epi8('\n');
+  const __m256i tab = _mm256_set1_epi8('\t');
+  const __m256i cr = _mm256_set1_epi8('\r');
+  const __m256i open = _mm256_set1_epi8('(');
+  const __m256i close = _mm256_set1_epi8(')');
+  const __m256i quote = _mm256_set1_epi8('\"');
+
+  m.whitespace_m = m.paren_m = m.quote_m = 0;
+  for (size_t i = 0; i < BLOCK; i += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i*) (block + i));
+    __m256i ws = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, space),
+						 _mm256_cmpeq_epi8(v, newline)),
+				 _mm256_or_si256(_mm256_cmpeq_epi8(v, tab),
+						 _mm256_cmpeq_epi8(v, cr)));
+    __m256i paren = _mm256_or_si256(_mm256_cmpeq_epi8(v, open), _mm256_cmpeq_epi8(v, close));
+
+    m.whitespace_m |= (unsigned long long) (unsigned int) _mm256_movemask_epi8(ws) << i;
+    m.paren_m      |= (unsigned long long) (unsigned int) _mm256_movemask_epi8(paren) << i;
+    m.quote_m      |= (unsigned long long) (unsigned int)
+      _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, quote)) << i;
+  }
+}
+
+#endif // SCAN_X86
+
+/**
+ * \brief Bit i of the result is the xor of the bits 0..i of x
+ */
+static inline unsigned long long prefix_xor(unsigned long long x) {
+  x ^= x << 1;
+  x ^= x << 2;
+  x ^= x << 4;
+  x ^= x << 8;
+  x ^= x << 16;
+  x ^= x << 32;
+  return x;
+}
+
+static inline unsigned int trailing_zeros(unsigned long long x) {
+#if defined(__GNUC__)
+  return __builtin_ctzll(x);
+#else
+  unsigned int n = 0;
+  for (; (x & 1) == 0; x >>= 1) {
+    ++n;
+  }
+  return n;
+#endif
+}
+
+
+//////////////////////////////////////////
+// Scanner
+
+Scanner::Kind Scanner::default_m = Scanner::get_best();
+
+Scanner::Scanner() : kind_m(get_default()), in_atom_m(0), in_string_m(0) {}
+
+void Scanner::reset() {
+  in_atom_m = 0;
+  in_string_m = 0;
+}
+
+void Scanner::scan(const char* begin, const char* end, vector<unsigned int>& index) {
+  size_t length = end - begin;
+
+  for (size_t offset = 0; offset < length; offset += BLOCK) {
+    size_t n = length - offset < BLOCK ? length - offset : BLOCK;
+    const char* block = begin + offset;
+
+    /// the last block is copied, padded by characters which are not
+    /// structural
+    char last[BLOCK];
+    if (n < BLOCK) {
+      memset(last, 'x', BLOCK);
+      memcpy(last, block, n);
+      block = last;
+    }
+
+    Masks m;
+    switch (kind_m) {
+#ifdef SCAN_X86
+    case AVX2:
+      classify_avx2(block, m);
+      break;
+    case SSE2:
+      classify_sse2(block, m);
+      break;
+#endif
+    default:
+      classify_scalar(block, m);
+    }
+
+    unsigned long long valid = n < BLOCK ? (1ULL << n) - 1 : ~0ULL;
+    unsigned long long literal = prefix_xor(m.quote_m) ^ in_string_m;
+    unsigned long long delimiter = m.whitespace_m | m.paren_m | m.quote_m;
+    unsigned long long atom = ~delimiter & ~literal & valid;
+    unsigned long long after_atom = (atom << 1) | in_atom_m;
+
+    unsigned long long structural = (m.paren_m & ~literal) | m.quote_m
+      | (atom & ~after_atom) | (m.whitespace_m & after_atom);
+
+    in_string_m = 0ULL - ((literal >> (n - 1)) & 1);
+    in_atom_m = (atom >> (n - 1)) & 1;
+
+    for (structural &= valid; structural != 0; structural &= structural - 1) {
+      index.push_back((unsigned int) (offset + trailing_zeros(structural)));
+    }
+  }
+}
+
+Scanner::Kind Scanner::get_best() {
+#ifdef SCAN_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return AVX2;
+  }
+  if (__builtin_cpu_supports("sse2")) {
+    return SSE2;
+  }
+#endif
+  return SCALAR;
+}
+
+Scanner::Kind Scanner::get_default() {
+  return default_m;
+}
+
+void Scanner::set_default(Kind kind) {
+  Kind best = get_best();
+  default_m = kind > best ? best : kind;
+}
+
+const char* Scanner::get_name(Kind kind) {
+  switch (kind) {
+  case AVX2:
+    return "avx2";
+  case SSE2:
+    return "sse2";
+  default:
+    return "scalar";
+  }
+}
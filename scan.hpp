@@ -0,0 +1,90 @@
+/**
+ * \file scan.hpp
+ *
+ * Encapsulates the interface for the first stage of reading
+ * s-expressions: finding the structural characters of the text, many
+ * characters at a time.
+ */
+
+#ifndef SCAN_HPP
+#define SCAN_HPP
+
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+/**
+ * \class Scanner
+ *
+ * \brief Builds a structural index of s-expression text in the manner of
+ *        simdjson: the offsets of all parentheses, all double quotes,
+ *        the first character of every atom, and the whitespace character
+ *        which ends an atom. Characters inside string literals are never
+ *        structural, so the entry after an opening quote is the closing
+ *        one, and the entry after the start of an atom is the character
+ *        behind it.
+ *
+ * The text is classified in blocks of 64 characters with SSE2 or AVX2
+ * compares, or by a table if neither is available. The best classifier
+ * is chosen at runtime. Text can be scanned in pieces: whether the last
+ * piece ended inside an atom or a string literal is carried over.
+ */
+class Scanner {
+public:
+  /// the ways to classify a block
+  enum Kind {
+    SCALAR,
+    SSE2,
+    AVX2
+  };
+
+  /**
+   * \brief Constructor for a Scanner using the classifier
+   *        get_default() returns
+   */
+  Scanner();
+
+  /**
+   * \brief Appends the offsets (relative to begin) of the structural
+   *        characters in [begin, end) to index. end - begin must fit
+   *        into an unsigned int.
+   */
+  void scan(const char* begin, const char* end, vector<unsigned int>& index);
+
+  /**
+   * \brief Forgets where the text scanned before ended
+   */
+  void reset();
+
+  /**
+   * \return the best classifier this cpu supports
+   */
+  static Kind get_best();
+
+  /**
+   * \return the classifier of new Scanners, get_best() unless changed
+   */
+  static Kind get_default();
+
+  /**
+   * \brief Changes the classifier of new Scanners, e.g. for comparisons.
+   *        A classifier the cpu does not support is replaced by the best
+   *        one
+   */
+  static void set_default(Kind kind);
+
+  /**
+   * \return name of the classifier
+   */
+  static const char* get_name(Kind kind);
+
+private:
+  Kind               kind_m;
+  unsigned long long in_atom_m;     ///< 1 if the text ended inside an atom
+  unsigned long long in_string_m;   ///< ~0 if it ended inside a literal
+
+  static Kind default_m;
+};
+
+#endif // SCAN_HPP